@@ -37,6 +37,9 @@
 #include <cstring>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <unordered_set>
 #include <typeinfo>
 #include <typeindex>
@@ -48,6 +51,7 @@
 #endif
 
 #include <functional>
+#include <future>
 #include <unordered_map>
 
 using std::function;
@@ -78,6 +82,7 @@ class provider;
 class uar;
 class umem;
 class compchannel;
+class cmd_comp;
 struct modify_action;
 struct fwd_dst_desc;
 } // namespace dcmd
@@ -95,6 +100,11 @@ class flow_matcher;
 class pd;
 class td;
 class uar_collection;
+class buf_stack;
+class cmd_queue;
+class cmd_batch;
+class aging_worker;
+class flow_counter_bulk;
 struct flow_table_attr;
 struct flow_group_attr;
 struct flow_rule_attr_ex;
@@ -197,6 +207,18 @@ public:
      * @retval Returns DPCP_OK on success.
      */
     status query(void* in, size_t in_sz, void* out, size_t& out_sz);
+    /**
+     * @brief Posts query of object in HW, result is delivered by @a comp
+     *
+     * @param [in]  in              Pointer to input structure describing object
+     * @param [in]  in_sz           Size of input structure in bytes
+     * @param [in]  out_sz          Size of expected output in bytes
+     * @param [in]  wr_id           User identifier returned with the completion
+     * @param [in]  comp            Asynchronous command completion channel
+     * @retval Returns DPCP_OK on success.
+     */
+    status query_async(void* in, size_t in_sz, size_t out_sz, uint64_t wr_id,
+                       dcmd::cmd_comp* comp);
     virtual status destroy();
 };
 
@@ -233,16 +255,37 @@ typedef dcmd::uar* uar;
 
 enum mkey_flags {
     MKEY_NONE = 0, // dummy flag
-    MKEY_ZERO_BASED = 1 << 0 // mkey address space starts at 0
+    MKEY_ZERO_BASED = 1 << 0, // mkey address space starts at 0
+    MKEY_RELAXED_ORDERING_WRITE = 1 << 1, // PCIe writes to the memory may be reordered
+    MKEY_RELAXED_ORDERING_READ = 1 << 2, // PCIe reads from the memory may be reordered
+    MKEY_RELAXED_ORDERING = MKEY_RELAXED_ORDERING_WRITE | MKEY_RELAXED_ORDERING_READ
 };
 
 class mkey : public obj {
+    uint32_t m_devx_key; // key created by create_mkey(), 0 if none
+
 protected:
     mkey(dcmd::ctx* ctx)
         : obj(ctx)
+        , m_devx_key(0)
     {
     }
     static void init_mkeys(void);
+    /**
+     * @brief Creates mkey object in HW with unique variant part of the key
+     *
+     * Sets mkey_7_0 of the mkey context in @a in, a key just deregistered
+     * with the same index is never returned.
+     *
+     * @param [in]  in              Pointer to create_mkey_in structure
+     * @param [in]  in_sz           Size of input structure in bytes
+     * @param [in/out] out          Pointer to buffer with operation result
+     * @param [in/out] out_sz       Size of output buffer
+     * @param [out] key             Created memory key (index and variant)
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status create_mkey(void* in, size_t in_sz, void* out, size_t& out_sz, uint32_t& key);
 
 public:
     virtual status get_address(void*& address) = 0;
@@ -251,12 +294,13 @@ public:
     /**
      * @brief Returns global MKey counter
      *
+     * The counter is approximate: MKey variants are reserved by threads in blocks
+     * of 16, so it may run ahead of created MKeys by up to 15 per thread.
+     *
      * @retval Returns DPCP_OK on success.
      */
     status get_mkey_num(int& num);
-    virtual ~mkey()
-    {
-    }
+    virtual ~mkey();
 };
 
 /**
@@ -447,6 +491,109 @@ public:
     virtual status get_id(uint32_t& id); // override;
 };
 
+enum chunked_mkey_flags {
+    CHUNKED_MKEY_NONE = 0, // dummy flag
+    CHUNKED_MKEY_PREFAULT = 1 << 0 // fault in chunk pages by workers before pinning
+};
+
+/**
+ * @brief struct chunked_mkey_attr - Chunked Memory Key registration attributes
+ *
+ * Memory allocated with mmap(MAP_POPULATE) is already faulted in,
+ * CHUNKED_MKEY_PREFAULT is not needed for it.
+ */
+struct chunked_mkey_attr {
+    size_t chunk_sz; // chunk size in bytes, rounded up to page size, 0 - default
+    uint32_t workers_num; // registration threads number, 0 - number of online CPUs
+    uint32_t flags; // chunked_mkey_flags
+};
+
+/**
+ * @brief class chunked_mkey - Represent Memory Key for large memory regions
+ *
+ * Memory region is split into chunks aligned to chunk size, chunks are registered
+ * in parallel by a pool of worker threads and stitched by indirect KLM Memory Key,
+ * so the whole region is accessed by a single key.
+ *
+ * Application can create a dpcp::chunked_mkey only via
+ * dpcp::adapter->create_chunked_mkey().
+ */
+class chunked_mkey : public indirect_mkey {
+    friend class adapter;
+    adapter* m_adapter;
+    void* m_address;
+    size_t m_length;
+    mkey_flags m_flags;
+    chunked_mkey_attr m_attr;
+    std::vector<mkey*> m_chunks;
+    uint32_t m_idx; // memory key index
+
+    chunked_mkey(adapter* ad, void* address, size_t length, mkey_flags flags,
+                 const chunked_mkey_attr& attr);
+    status reg_chunks(void* verbs_pd, size_t first, size_t step);
+
+public:
+    static const size_t DEFAULT_CHUNK_SZ = 1UL << 28; // 256MB
+    static const size_t MAX_CHUNK_SZ = 1UL << 30; // KLM byte count limit
+    virtual ~chunked_mkey();
+    /**
+     * @brief Registers memory region chunks in parallel
+     *
+     * @param [in]  verbs_pd        Pointer to ibv_pd
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status reg_mem(void* verbs_pd);
+    /**
+     * @brief Creates indirect Memory Key over registered chunks
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status create();
+    /**
+     * @brief Returns virtual address of memory region.
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_address(void*& address); // override;
+    /**
+     * @brief Returns length of memory region
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_length(size_t& len);
+    /**
+     * @brief Returns memory region flags
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_flags(mkey_flags& flags);
+    /**
+     * @brief Returns number of chunk memory keys
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_mkeys_num(size_t& mkeys_num);
+    /**
+     * @brief Returns array of chunk memory keys
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_mkeys_lst(mkey*& arr);
+    /**
+     * @brief Returns chunk size used for registration
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status get_chunk_sz(size_t& chunk_sz);
+    /**
+     * @brief Returns MKEY ID created by create()
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_id(uint32_t& id); // override;
+};
+
 enum reserved_mkey_type { MKEY_RESERVED_NONE = 0, MKEY_RESERVED_DUMP_AND_FILL = 1 };
 
 class reserved_mkey : public mkey {
@@ -597,6 +744,7 @@ class crypto_mkey : public mkey {
     adapter* m_adapter;
     uint32_t m_idx; // memory key index
     const uint32_t m_max_sge; // max number of scatter gather elements
+    mkey_flags m_flags; // MKEY_RELAXED_ORDERING_* flags supported by HCA
 
 public:
     /**
@@ -604,8 +752,9 @@ public:
      *
      * @param [in]  ad              Pointer to Adapter
      * @param [in]  max_sge         Max number of scatter gather elements
+     * @param [in]  flags           MKEY_RELAXED_ORDERING_* flags, other flags are ignored
      */
-    explicit crypto_mkey(adapter* ad, uint32_t max_sge);
+    explicit crypto_mkey(adapter* ad, uint32_t max_sge, mkey_flags flags = MKEY_NONE);
     virtual ~crypto_mkey() = default;
     /**
      * @brief Creates Memory Key for given type
@@ -945,6 +1094,15 @@ protected:
     rq_attr m_attr;
     rq_state m_state;
 
+    /**
+     * @brief Sets additional RQ context fields of MODIFY_RQ
+     */
+    virtual void prepare_modify(void* p_rqc, rq_state new_state)
+    {
+        (void)p_rqc;
+        (void)new_state;
+    }
+
 public:
     rq(dcmd::ctx* ctx, const rq_attr& attr);
     /**
@@ -1099,6 +1257,318 @@ public:
     status get_mkey(uint32_t& mkey);
 };
 
+/**
+ * @brief struct hairpin_attr - Hairpin queues attributes
+ *
+ */
+struct hairpin_attr {
+    uint8_t log_data_sz; // log2 of queue data buffer size in bytes, 0 - maximal supported
+    uint8_t log_num_packets; // log2 of maximal number of packets in queue, 0 - derived from
+                             // log_data_sz with 64 bytes per packet, capped by HW limit
+    uint32_t tis_num; // TIS of hairpin SQ, required
+};
+
+/**
+ * @brief class hairpin_rq - Handles hairpin ReceiveQueue
+ *
+ * Packets received by hairpin RQ are transmitted by its peer hairpin_sq,
+ * buffers are managed by HW. Hairpin RQ is used as destination of TIR.
+ * Application can create hairpin queues only via
+ * dpcp::adapter->create_hairpin_pair().
+ */
+class hairpin_rq : public rq {
+    friend class adapter;
+    hairpin_attr m_hp_attr;
+    uint32_t m_peer_sqn;
+    uint16_t m_peer_vhca;
+
+    hairpin_rq(dcmd::ctx* ctx, const hairpin_attr& attr);
+
+    status create();
+    virtual void prepare_modify(void* p_rqc, rq_state new_state) override;
+
+public:
+    virtual ~hairpin_rq()
+    {
+    }
+};
+
+/**
+ * @brief struct buffer_pool_attr - Receive buffer pool attributes
+ *
+ */
+struct buffer_pool_attr {
+    size_t buf_sz; // data room size of each buffer in bytes
+    uint32_t headroom; // bytes reserved before data room
+    uint32_t tailroom; // bytes reserved after data room
+    uint32_t slab_bufs_num; // number of buffers registered by one slab
+    uint32_t max_slabs_num; // pool grows on demand up to this number of slabs, 0 - 1
+    uint32_t cache_sz; // per-core cache size in buffers, 0 - no per-core caching
+    uint32_t slab_mkey_flags; // mkey_flags of slab registration, e.g. MKEY_RELAXED_ORDERING
+};
+
+/**
+ * @brief struct pool_buf - Buffer owned by dpcp::buffer_pool
+ *
+ * Buffer is returned to the pool when the last reference is released.
+ */
+struct pool_buf {
+    void* addr; // data room address, headroom precedes it
+    uint32_t len; // data room size
+    uint32_t lkey; // memory key of the slab the buffer belongs to
+    std::atomic<uint32_t> refcnt;
+    uint32_t idx; // buffer index in pool, internal
+    std::atomic<uint32_t> next; // free list link, internal
+};
+
+/**
+ * @brief class buffer_pool - Zero-copy receive buffer pool
+ *
+ * Buffers are carved from slabs, each slab is registered once by direct_mkey.
+ * Free buffers are kept in per-core lock-free caches with a global overflow
+ * stack behind them, so alloc() and release() may be called from any thread.
+ *
+ * Application can create a dpcp::buffer_pool only via
+ * dpcp::adapter->create_buffer_pool().
+ */
+class buffer_pool {
+    friend class adapter;
+
+    struct slab {
+        void* m_mem;
+        direct_mkey* m_mkey;
+        pool_buf* m_bufs;
+    };
+
+    adapter* m_adapter;
+    buffer_pool_attr m_attr;
+    size_t m_stride_sz;
+    std::vector<slab> m_slabs;
+    std::atomic<uint32_t> m_slabs_num;
+    std::mutex m_grow_lock;
+    buf_stack* m_caches;
+    uint32_t m_caches_num;
+    buf_stack* m_global;
+
+    buffer_pool(adapter* ad, const buffer_pool_attr& attr);
+    status add_slab();
+    pool_buf* get_buf(uint32_t idx) const;
+    pool_buf* pop(buf_stack& stack);
+    void push(buf_stack& stack, pool_buf* buf);
+
+public:
+    virtual ~buffer_pool();
+    /**
+     * @brief Takes free buffer from the pool, grows the pool when it is empty
+     *
+     * @param [out] buf     Buffer with reference count of 1
+     *
+     * @retval Returns DPCP_OK on success.
+     *         Returns DPCP_ERR_NO_MEMORY if the pool is exhausted.
+     */
+    status alloc(pool_buf*& buf);
+    /**
+     * @brief Takes additional reference to the buffer
+     *
+     * @param [in] buf      Buffer obtained by alloc()
+     */
+    inline void ref(pool_buf* buf)
+    {
+        buf->refcnt.fetch_add(1, std::memory_order_relaxed);
+    }
+    /**
+     * @brief Releases buffer reference, last reference returns it to the pool
+     *
+     * @param [in] buf      Buffer obtained by alloc()
+     */
+    void release(pool_buf* buf);
+    /**
+     * @brief Posts pool buffers to RQ and rings its DoorBell record
+     *
+     * Each WQE gets one buffer, striding RQ buffers must fit all WQE strides.
+     *
+     * @param [in]     rq           Regular or striding RQ
+     * @param [in,out] wqe_head     RQ producer counter, advanced by posted WQEs
+     * @param [in,out] wqe_cnt      WQEs to post, on return number of posted WQEs
+     * @param [out]    ring         Array of RQ WQEs number, buffers are stored by WQE index
+     *
+     * @retval Returns DPCP_OK if any WQE was posted.
+     */
+    status refill(basic_rq& rq, uint32_t& wqe_head, uint32_t& wqe_cnt, pool_buf** ring);
+    /**
+     * @brief Returns number of slabs registered by the pool
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status get_slabs_num(uint32_t& slabs_num);
+    /**
+     * @brief Returns buffer stride, i.e. headroom, data room and tailroom aligned to cache line
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status get_stride_sz(size_t& stride_sz);
+
+    buffer_pool(buffer_pool const&) = delete;
+    buffer_pool& operator=(buffer_pool const&) = delete;
+};
+
+/**
+ * @brief Represent and handles RQT object, an indirection table of RQs used by
+ *        indirect TIR to spread received packets by hash.
+ */
+class rqt : public obj {
+public:
+    struct attr {
+        uint32_t max_size; /**< Maximum number of entries, 0 means rqns.size() */
+        std::vector<uint32_t> rqns; /**< Table entries, an RQ can appear more than once,
+                                       number of entries must be a power of two */
+    };
+
+public:
+    /**
+     * @brief RQT Object constructor, object is initialized but not created yet
+     *
+     * @param [in]  ctx          Pointer to adapter context
+     * @param [in]  size_limit   Maximum number of entries supported by HW, 0 if unknown
+     */
+    rqt(dcmd::ctx* ctx, uint32_t size_limit);
+    virtual ~rqt();
+    /**
+     * @brief Create RQT object using requested properties
+     *
+     * @param [in]  rqt_attr     Object attributes
+     *
+     * @retval Returns DPCP_OK on success
+     *         Returns DPCP_ERR_INVALID_PARAM if number of entries is not a power of two
+     *         Returns DPCP_ERR_OUT_OF_RANGE if max size exceeds HW limit
+     */
+    status create(const rqt::attr& rqt_attr);
+    /**
+     * @brief Replace RQT entries in HW, table size can not exceed max_size
+     *
+     * @param [in]  rqns         New table entries
+     *
+     * @retval Returns DPCP_OK on success
+     *         Returns DPCP_ERR_INVALID_PARAM if number of entries is not a power of two
+     *         or exceeds max size
+     */
+    status modify(const std::vector<uint32_t>& rqns);
+    /**
+     * @brief Query RQT entries from HW
+     *
+     * @param [out] rqns         Table entries
+     *
+     * @retval Returns DPCP_OK on success
+     */
+    status query(std::vector<uint32_t>& rqns);
+    /**
+     * @brief Get RQT Number
+     */
+    inline uint32_t get_rqtn() const
+    {
+        return m_rqtn;
+    }
+    /**
+     * @brief Get maximum number of RQT entries
+     */
+    inline uint32_t get_max_size() const
+    {
+        return m_max_size;
+    }
+
+private:
+    status set_rq_list(void* rqt_ctx, const std::vector<uint32_t>& rqns);
+
+    uint32_t m_rqtn;
+    uint32_t m_max_size;
+    uint32_t m_size_limit;
+};
+
+/**
+ * @brief struct rqt_rebalancer_attr - RSS indirection table rebalancer attributes
+ */
+struct rqt_rebalancer_attr {
+    uint32_t imbalance_pct; // rebalance once the busiest RQ exceeds mean load by this percent
+    uint32_t target_pct; // stop moving entries once the busiest RQ is within this percent of
+                         // mean load, lower than imbalance_pct to avoid ping-pong
+    uint32_t max_moves; // maximum entries moved by one MODIFY_RQT, 0 - unlimited
+    uint32_t min_interval_ms; // minimum time between two MODIFY_RQT commands
+};
+
+/**
+ * @brief class rqt_rebalancer - Dynamic RSS indirection table rebalancer
+ *
+ * Moves RQT entries (hash buckets) from the most loaded RQs to the least loaded ones
+ * according to load samples collected on the completion path, e.g. number of CQEs polled
+ * from every RQ since the previous call. When per-bucket samples are not available
+ * (bucket is rss_hash_result modulo table size) the load of an RQ is considered to be
+ * spread evenly over its entries.
+ *
+ * All moves of one rebalance are applied by a single MODIFY_RQT command.
+ * Thrashing is avoided by the gap between imbalance_pct and target_pct, by max_moves
+ * and by min_interval_ms.
+ */
+class rqt_rebalancer {
+public:
+    /**
+     * @brief Rebalancer constructor, the table is not read until init()
+     *
+     * @param [in] table        RQT created by adapter::create_rqt(), owned by the caller
+     * @param [in] rqns         All RQs the table may point to, including unused ones
+     * @param [in] attr         Rebalancer attributes
+     */
+    rqt_rebalancer(rqt* table, const std::vector<uint32_t>& rqns,
+                   const rqt_rebalancer_attr& attr);
+    /**
+     * @brief Reads current table entries from HW
+     *
+     * @retval Returns DPCP_OK on success.
+     *         Returns DPCP_ERR_INVALID_PARAM if the table points to an RQ not in rqns.
+     */
+    status init();
+    /**
+     * @brief Rebalances the table according to new load samples
+     *
+     * @param [in]  rq_loads     Load of every RQ since the previous call, indexed as rqns
+     * @param [in]  bucket_loads Optional load of every table entry, indexed as the table,
+     *                           empty if not available
+     * @param [out] moved        Number of entries moved, 0 if the table was not modified
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status rebalance(const std::vector<uint64_t>& rq_loads,
+                     const std::vector<uint64_t>& bucket_loads, uint32_t& moved);
+    /**
+     * @brief Computes new table entries, does not access HW
+     *
+     * @param [in,out] entries      Table entries, RQ numbers from rqns
+     * @param [in]     rqns         All RQs the table may point to
+     * @param [in]     rq_loads     Load of every RQ, indexed as rqns
+     * @param [in]     bucket_loads Optional load of every entry, empty if not available
+     * @param [in]     attr         Rebalancer attributes
+     *
+     * @retval Returns number of moved entries.
+     */
+    static uint32_t plan(std::vector<uint32_t>& entries, const std::vector<uint32_t>& rqns,
+                         const std::vector<uint64_t>& rq_loads,
+                         const std::vector<uint64_t>& bucket_loads,
+                         const rqt_rebalancer_attr& attr);
+    /**
+     * @brief Returns table entries as last written to HW
+     */
+    inline const std::vector<uint32_t>& get_entries() const
+    {
+        return m_entries;
+    }
+
+private:
+    rqt* m_rqt;
+    std::vector<uint32_t> m_rqns;
+    std::vector<uint32_t> m_entries;
+    rqt_rebalancer_attr m_attr;
+    uint64_t m_last_modify_ms;
+};
+
 /**
  * @brief Represent and handles TIR object
  *
@@ -1111,8 +1581,41 @@ enum {
     TIR_ATTR_TLS = (1 << 4),
     TIR_ATTR_NVMEOTCP_ZERO_COPY = (1 << 5),
     TIR_ATTR_NVMEOTCP_CRC = (1 << 6),
+    TIR_ATTR_INDIRECT = (1 << 7), /**< Indirect dispatch to RQT with RX hash, can not be used
+                                       together with TIR_ATTR_INLINE_RQN */
 };
 
+/**
+ * @brief TIR RX hash function.
+ */
+enum tir_rx_hash_fn {
+    TIR_RX_HASH_FN_NONE = 0x0,
+    TIR_RX_HASH_FN_INVERTED_XOR8 = 0x1,
+    TIR_RX_HASH_FN_TOEPLITZ = 0x2,
+};
+
+/**
+ * @brief TIR RX hash selected fields.
+ */
+enum tir_rx_hash_field {
+    TIR_RX_HASH_SRC_IP = (1 << 0),
+    TIR_RX_HASH_DST_IP = (1 << 1),
+    TIR_RX_HASH_L4_SPORT = (1 << 2),
+    TIR_RX_HASH_L4_DPORT = (1 << 3),
+    TIR_RX_HASH_IPSEC_SPI = (1 << 4),
+};
+
+/**
+ * @brief TIR RX hash field selector.
+ */
+struct tir_rx_hash_field_select {
+    uint32_t l3_prot_type : 1; /**< 0 - IPv4, 1 - IPv6 */
+    uint32_t l4_prot_type : 1; /**< 0 - TCP, 1 - UDP */
+    uint32_t selected_fields : 30; /**< @ref tir_rx_hash_field, 0 means hash is not used */
+};
+
+enum { TIR_RX_HASH_TOEPLITZ_KEY_SIZE = 40 };
+
 class tir : public forwardable_obj {
 public:
     struct attr {
@@ -1130,6 +1633,15 @@ public:
             uint32_t crc_en : 1;
             uint32_t tag_buffer_table_id;
         } nvmeotcp;
+        struct {
+            uint32_t indirect_table : 24; /**< RQT number @ref rqt::get_rqtn */
+            uint32_t hash_fn : 4; /**< @ref tir_rx_hash_fn */
+            uint32_t symmetric : 1; /**< Same hash for both directions of a flow */
+            uint8_t toeplitz_key[TIR_RX_HASH_TOEPLITZ_KEY_SIZE];
+            tir_rx_hash_field_select outer; /**< Fields of outer headers */
+            tir_rx_hash_field_select inner; /**< Fields of inner headers, enables tunneled
+                                                 offload */
+        } rss;
     };
 
 public:
@@ -1172,6 +1684,87 @@ private:
     uint32_t m_tirn;
 };
 
+/**
+ * @brief struct rx_hash_tuple - Packet fields hashed by @ref rx_hash, network byte order
+ */
+struct rx_hash_tuple {
+    uint8_t src_ip[16]; // IPv4 address takes the first 4 bytes
+    uint8_t dst_ip[16];
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint32_t spi;
+};
+
+/**
+ * @brief class rx_hash - Software RX hash matching indirect TIR hashing
+ *
+ * Computes the value HW reports in CQE rss_hash_result (after be32toh) for the same hash
+ * function, key and field selection as @ref tir::attr::rss, so flows can be placed or RSS
+ * configuration validated before packets arrive.
+ *
+ * Toeplitz is table driven, init() expands the key to a lookup table of 256 entries per
+ * input byte, so a hash costs one lookup per byte. Input is the selected fields in order
+ * source address, destination address, source port, destination port and SPI.
+ *
+ * Symmetric hashing (tir::attr::rss::symmetric) is not supported, its HW input layout
+ * is not documented and can not be reproduced bit exact.
+ */
+class rx_hash {
+public:
+    rx_hash();
+    /**
+     * @brief Configures hashing as of indirect TIR attributes
+     *
+     * @param [in] tir_attr     TIR attributes with TIR_ATTR_INDIRECT set
+     * @param [in] inner        Use inner headers field selector
+     *
+     * @retval Returns DPCP_OK on success.
+     *         Returns DPCP_ERR_NO_SUPPORT for hash functions other than Toeplitz
+     *         and for symmetric hashing.
+     */
+    status init(const tir::attr& tir_attr, bool inner = false);
+    /**
+     * @brief Configures hashing
+     *
+     * @param [in] hash_fn      @ref tir_rx_hash_fn
+     * @param [in] key          Toeplitz key of TIR_RX_HASH_TOEPLITZ_KEY_SIZE bytes
+     * @param [in] symmetric    Same hash for both directions of a flow, see @ref rx_hash
+     * @param [in] fields       Hashed fields
+     *
+     * @retval Returns DPCP_OK on success.
+     *         Returns DPCP_ERR_NO_SUPPORT for hash functions other than Toeplitz
+     *         and for symmetric hashing.
+     */
+    status init(uint32_t hash_fn, const uint8_t* key, bool symmetric,
+                const tir_rx_hash_field_select& fields);
+    /**
+     * @brief Computes hash of a single tuple
+     */
+    uint32_t hash(const rx_hash_tuple& tuple) const;
+    /**
+     * @brief Computes hashes of a batch of tuples
+     *
+     * @param [in]  tuples      Array of num tuples
+     * @param [out] hashes      Array of num hashes
+     * @param [in]  num         Number of tuples
+     */
+    void hash_burst(const rx_hash_tuple* tuples, uint32_t* hashes, size_t num) const;
+    /**
+     * @brief Returns number of bytes hashed for every tuple
+     */
+    inline uint32_t get_input_len() const
+    {
+        return m_input_len;
+    }
+
+private:
+    uint32_t get_input(const rx_hash_tuple& tuple, uint8_t* input) const;
+
+    std::vector<uint32_t> m_table;
+    tir_rx_hash_field_select m_fields;
+    uint32_t m_input_len;
+};
+
 /**
  * @brief Represent and handles TIS object
  */
@@ -1447,6 +2040,8 @@ struct match_params_lyr_2 {
     uint8_t dst_mac[8]; /**< 6 bytes(48 bits) mac address + 2 bytes(16 bits) alignment to 64 bits */
     uint16_t ethertype;
     uint16_t first_vlan_id;
+    uint16_t second_vlan_id; /**< Second (inner) C-VLAN id, requires
+                                  @ref flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS */
 };
 
 /**
@@ -1457,7 +2052,14 @@ struct match_params_lyr_3 {
     uint32_t dst_ip;
     uint8_t ip_protocol;
     uint8_t ip_version : 4;
-    // TODO: Add ipv6 support
+    uint8_t traffic_class; /**< IPv6 traffic class or IPv4 TOS: DSCP in 6 high bits, ECN in
+                                2 low bits */
+    uint8_t src_ipv6[16]; /**< Network byte order, can not be used together with src_ip */
+    uint8_t dst_ipv6[16]; /**< Network byte order, can not be used together with dst_ip */
+    uint32_t flow_label; /**< IPv6 flow label (20 bits), requires
+                              @ref flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS */
+    uint8_t ttl; /**< IPv4 TTL or IPv6 hop limit */
+    uint8_t frag; /**< Set for IP fragments (1 bit) */
 };
 
 /**
@@ -1467,6 +2069,10 @@ enum match_params_lyr_4_type {
     NONE = 0x0,
     TCP,
     UDP,
+    ICMP, /**< Outer header only, requires
+               @ref flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS_3 */
+    ICMPV6, /**< Outer header only, requires
+                 @ref flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS_3 */
 };
 
 /**
@@ -1476,6 +2082,26 @@ struct match_params_lyr_4 {
     match_params_lyr_4_type type;
     uint16_t src_port;
     uint16_t dst_port;
+    uint16_t tcp_flags; /**< TCP flags (9 bits), FIN is bit 0, used with TCP type */
+    uint8_t icmp_type; /**< Used with ICMP and ICMPV6 types */
+    uint8_t icmp_code; /**< Used with ICMP and ICMPV6 types */
+};
+
+/**
+ * @brief: Represent tunnel header match params.
+ *
+ * VNI, GENEVE OAM, option length and protocol type require
+ * @ref flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS.
+ * GENEVE TLV option 0 data requires @ref flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS_3
+ * and a GENEVE TLV option to be configured on the device.
+ */
+struct match_params_tunnel {
+    uint32_t vxlan_vni; /**< VXLAN network identifier (24 bits) */
+    uint32_t geneve_vni; /**< GENEVE virtual network identifier (24 bits) */
+    uint16_t geneve_protocol_type; /**< GENEVE protocol type of the inner frame */
+    uint8_t geneve_opt_len; /**< GENEVE options length in 4 bytes units (6 bits) */
+    uint8_t geneve_oam; /**< GENEVE OAM bit (1 bit) */
+    uint32_t geneve_tlv_option_0_data; /**< First 4 bytes of GENEVE TLV option 0 data */
 };
 
 /**
@@ -1488,13 +2114,43 @@ struct match_params_ex {
     std::vector<parser_sample_field> match_parser_sample_field_vec; /**< Samples received by
                                                                          @ref parser_graph_node. */
     uint32_t match_metadata_reg_c_0;
+    uint32_t match_metadata_reg_c_1;
+    uint32_t match_metadata_reg_c_2;
+    uint32_t match_metadata_reg_c_3;
+    uint32_t match_metadata_reg_c_4;
+    uint32_t match_metadata_reg_c_5;
+    uint32_t match_metadata_reg_c_6;
+    uint32_t match_metadata_reg_c_7;
+    uint32_t match_metadata_reg_a;
+    match_params_lyr_2 match_inner_lyr2; /**< Inner layer 2 match params, requires
+                                              @ref flow_group_match_criteria_enable::
+                                              FG_MATCH_INNER_HDR */
+    match_params_lyr_3 match_inner_lyr3; /**< Inner layer 3 match params, requires
+                                              @ref flow_group_match_criteria_enable::
+                                              FG_MATCH_INNER_HDR */
+    match_params_lyr_4 match_inner_lyr4; /**< Inner layer 4 match params, requires
+                                              @ref flow_group_match_criteria_enable::
+                                              FG_MATCH_INNER_HDR */
+    match_params_tunnel match_tunnel;
 
     match_params_ex()
         : match_metadata_reg_c_0(0)
+        , match_metadata_reg_c_1(0)
+        , match_metadata_reg_c_2(0)
+        , match_metadata_reg_c_3(0)
+        , match_metadata_reg_c_4(0)
+        , match_metadata_reg_c_5(0)
+        , match_metadata_reg_c_6(0)
+        , match_metadata_reg_c_7(0)
+        , match_metadata_reg_a(0)
     {
         memset(&match_lyr2, 0, sizeof(match_lyr2));
         memset(&match_lyr3, 0, sizeof(match_lyr3));
         memset(&match_lyr4, 0, sizeof(match_lyr4));
+        memset(&match_inner_lyr2, 0, sizeof(match_inner_lyr2));
+        memset(&match_inner_lyr3, 0, sizeof(match_inner_lyr3));
+        memset(&match_inner_lyr4, 0, sizeof(match_inner_lyr4));
+        memset(&match_tunnel, 0, sizeof(match_tunnel));
     }
 };
 
@@ -1503,9 +2159,15 @@ struct match_params_ex {
  */
 enum flow_group_match_criteria_enable {
     FG_MATCH_OUTER_HDR = 0x1, /**< Enable match on outer header fields */
+    FG_MATCH_MISC_PARAMS = 0x2, /**< Enable match on misc fields e.g. IPv6 flow label, VNI */
+    FG_MATCH_INNER_HDR = 0x4, /**< Enable match on inner (tunneled) header fields */
     FG_MATCH_METADATA_REG_C_0 = 0x8, /**< Enable match on metadata register 0 */
+    FG_MATCH_MISC_PARAMS_3 = 0x10, /**< Enable match on misc 3 fields e.g. GENEVE TLV option */
     FG_MATCH_PARSER_FIELDS = 0x20, /**< Enable match on samples received by
                                         @ref parser_graph_node.*/
+    FG_MATCH_METADATA_REGS = 0x80, /**< Enable match on metadata registers reg_c_0..7 and reg_a,
+                                        programmed to the device as
+                                        @ref FG_MATCH_METADATA_REG_C_0 */
 };
 
 /**
@@ -1529,6 +2191,20 @@ struct flow_group_attr {
     }
 };
 
+/**
+ * @brief: Handle of flow rule added by @ref flow_group::add_flow_rule_compact.
+ */
+typedef uint32_t flow_rule_handle;
+
+/**
+ * @brief: Flow index occupancy of a flow group.
+ */
+struct flow_index_stats {
+    uint32_t capacity; /**< Number of flow indexes in the group range */
+    uint32_t used; /**< Flow indexes taken by rules of the group */
+    uint32_t auto_allocated; /**< Rules which got flow index from the group */
+};
+
 /**
  * @brief: Flow Group
  *
@@ -1537,14 +2213,17 @@ struct flow_group_attr {
  * which set on which fields and masks the packet should be matched on.
  * see @ref flow_table for more information.
  *
- * @note class flow_group is not thread-safe, instance of that class should not be accessed
- * from different threads unless thread-safety measures were taken by the application.
+ * @note Flow rules may be added and removed from different threads at the same time,
+ * the group serializes only its bookkeeping and issues HW commands without a lock.
+ * Other methods of class flow_group are not thread-safe, e.g. create() should not be called
+ * concurrently with any other method.
  */
 class flow_group : public obj, public std::enable_shared_from_this<flow_group> {
 protected:
     flow_group_attr m_attr;
     std::weak_ptr<const flow_table> m_table;
     bool m_is_initialized;
+    std::mutex m_rules_lock; /*< protects m_rules */
     std::unordered_set<std::shared_ptr<flow_rule_ex>> m_rules;
     std::shared_ptr<flow_matcher> m_matcher;
 
@@ -1592,14 +2271,93 @@ public:
      */
     virtual status add_flow_rule(const flow_rule_attr_ex& attr,
                                  std::weak_ptr<flow_rule_ex>& rule) = 0;
+    /**
+     * @brief Add and create a batch of flow rules in the group.
+     *
+     * The whole batch is validated before any HW command is issued, so an invalid
+     * attribute fails the batch without touching the HW. Then the command buffers of
+     * all rules are prepared in one allocation and submitted to @a batch, which keeps
+     * up to its depth of them in flight. The call waits for all commands of @a batch.
+     *
+     * @param [in] batch: command batch executing the rule commands.
+     * @param [in] attrs: array of flow rules attributes.
+     * @param [in] num: number of entries in @a attrs.
+     * @param [out] rules: flow rule objects in @a attrs order, empty for failed rules.
+     * @param [out] results: status of every rule in @a attrs order.
+     *
+     * @retval Returns DPCP_OK if all rules were created, otherwise status of the first
+     *         failed rule. Rules that failed are removed from the group.
+     */
+    status add_flow_rules(cmd_batch& batch, const flow_rule_attr_ex* attrs, size_t num,
+                          std::vector<std::weak_ptr<flow_rule_ex>>& rules,
+                          std::vector<status>& results);
+    /**
+     * @brief Add and create a batch of flow rules in the group.
+     *
+     * @param [in] batch: command batch executing the rule commands.
+     * @param [in] attrs: flow rules attributes.
+     * @param [out] rules: flow rule objects in @a attrs order, empty for failed rules.
+     *
+     * @retval Returns DPCP_OK if all rules were created, otherwise status of the first
+     *         failed rule.
+     */
+    status add_flow_rules(cmd_batch& batch, const std::vector<flow_rule_attr_ex>& attrs,
+                          std::vector<std::weak_ptr<flow_rule_ex>>& rules)
+    {
+        std::vector<status> results;
+        return add_flow_rules(batch, attrs.data(), attrs.size(), rules, results);
+    }
     /**
      * @brief Remove flow rule from group.
      *
+     * @note: Flow index of the rule can be reused by the next added rule.
+     *
      * @param [in/out] rule: flow rule.
      *
      * @retval Returns @ref dpcp::status with the status code.
      */
-    status remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule);
+    virtual status remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule);
+    /**
+     * @brief Get flow index occupancy of the group.
+     *
+     * @param [out] stats: flow index statistics.
+     *
+     * @retval Returns DPCP_OK on success, DPCP_ERR_NO_SUPPORT if rules of the group
+     *         have no flow index.
+     */
+    virtual status get_flow_index_stats(flow_index_stats& stats) const;
+    /**
+     * @brief Add and create flow rule kept in compact form by the group.
+     *
+     * No @ref flow_rule_ex object is allocated, the group stores the rule in its slab
+     * with match value packed to the bytes set in the group mask and actions as index
+     * to the group table of action sets. Intended for tables with millions of rules.
+     *
+     * @param [in] attr: flow rule attr, flow index can be FLOW_INDEX_AUTO.
+     * @param [out] handle: rule handle, stale handles of removed rules are rejected.
+     *
+     * @retval Returns @ref dpcp::status with the status code.
+     */
+    virtual status add_flow_rule_compact(const flow_rule_attr_ex& attr, flow_rule_handle& handle);
+    /**
+     * @brief Remove flow rule added by @ref add_flow_rule_compact.
+     *
+     * @param [in] handle: rule handle.
+     *
+     * @retval Returns @ref dpcp::status with the status code.
+     */
+    virtual status remove_flow_rule_compact(flow_rule_handle handle);
+    /**
+     * @brief Get flow rule added by @ref add_flow_rule_compact.
+     *
+     * @param [in] handle: rule handle.
+     * @param [out] flow_index: flow index of the rule.
+     * @param [out] match: packed match value, bytes of PRM match param set in the group mask.
+     *
+     * @retval Returns @ref dpcp::status with the status code.
+     */
+    virtual status get_flow_rule_compact(flow_rule_handle handle, uint32_t& flow_index,
+                                         std::vector<uint8_t>& match) const;
     /**
      * @brief Get group match criteria.
      *
@@ -1617,6 +2375,15 @@ protected:
     // Help functions
     template <class FR>
     status create_flow_rule_ex(const flow_rule_attr_ex& attr, std::weak_ptr<flow_rule_ex>& rule);
+    virtual status validate_flow_rules(const flow_rule_attr_ex* attrs, size_t num,
+                                       std::vector<status>& results) const;
+    virtual void create_flow_rules(cmd_batch& batch,
+                                   const std::vector<std::shared_ptr<flow_rule_ex>>& rules,
+                                   std::vector<status>& results);
+    static void run_flow_rules(cmd_batch& batch, size_t num,
+                               const std::function<status(size_t)>& fn,
+                               std::vector<status>& results);
+    static bool verify_flow_actions(const std::vector<std::shared_ptr<flow_action>>& actions);
 };
 
 enum flow_action_reformat_anchor {
@@ -1641,8 +2408,16 @@ enum flow_action_modify_field {
     OUT_IP_TTL = 0xa,
     OUT_UDP_SPORT = 0xb,
     OUT_UDP_DPORT = 0xc,
+    METADATA_REG_A = 0x49,
+    METADATA_REG_B = 0x50,
     METADATA_REG_C_0 = 0x51,
     METADATA_REG_C_1 = 0x52,
+    METADATA_REG_C_2 = 0x53,
+    METADATA_REG_C_3 = 0x54,
+    METADATA_REG_C_4 = 0x55,
+    METADATA_REG_C_5 = 0x56,
+    METADATA_REG_C_6 = 0x57,
+    METADATA_REG_C_7 = 0x58,
 };
 
 /**
@@ -1740,6 +2515,19 @@ struct flow_action_modify_attr {
     std::vector<flow_action_modify_type_attr> actions; /**< list of modify actions to perform */
 };
 
+/**
+ * @brief: Statistics of shared flow actions, see @ref flow_action_generator::get_shared_modify.
+ */
+struct flow_action_cache_stats {
+    uint64_t hits; /**< Requests served by existing shared action */
+    uint64_t misses; /**< Requests which created new shared action */
+    uint32_t modify_entries[FT_END]; /**< Shared modify actions in use, by flow_table_type */
+    uint32_t modify_capacity[FT_END]; /**< Modify header contexts supported by HW, by
+                                           flow_table_type */
+    uint32_t reformat_entries; /**< Shared reformat actions in use */
+    uint32_t reformat_capacity; /**< Packet reformat contexts supported by HW */
+};
+
 /**
  * @brief: Flow Action generator - see @ref flow_table for more information.
  *
@@ -1749,10 +2537,16 @@ struct flow_action_modify_attr {
  */
 class flow_action_generator {
     friend class adapter;
+    typedef std::unordered_map<std::string, std::weak_ptr<flow_action>> action_cache_t;
 
 private:
     dcmd::ctx* m_ctx;
     const adapter_hca_capabilities* m_caps;
+    std::mutex m_cache_lock;
+    action_cache_t m_modify_cache; /**< key is PRM command of the action */
+    action_cache_t m_reformat_cache;
+    uint64_t m_cache_hits;
+    uint64_t m_cache_misses;
 
 public:
     /**
@@ -1798,21 +2592,77 @@ public:
      * @retval flow_action action pointer or nullptr.
      */
     std::shared_ptr<flow_action> create_reparse();
+    /**
+     * @brief Create flow action counter, packets and bytes matched on the flow rule are
+     *        counted by a counter of the bulk. Forward action is still required.
+     *
+     * @param [in] bulk: Counters bulk, must outlive rules using the action.
+     * @param [in] offset: Counter offset in the bulk.
+     *
+     * @retval flow_action action pointer or nullptr.
+     */
+    std::shared_ptr<flow_action> create_counter(flow_counter_bulk& bulk, uint32_t offset);
+    /**
+     * @brief Create flow action allow, on transmit Flow Table the packet continues to the
+     *        NIC vport. Used instead of forward on the last transmit table.
+     *
+     * @retval flow_action action pointer or nullptr.
+     */
+    std::shared_ptr<flow_action> create_allow();
+    /**
+     * @brief Get flow action modify shared by all users of the same modify actions.
+     *
+     * HW modify header contexts are limited, identical action lists should use one.
+     * The action is released when the last user drops it. New action is created
+     * without holding the cache lock, threads creating the same action at once
+     * get the one inserted first.
+     *
+     * @param [in] attr: Modify action attributes.
+     *
+     * @retval flow_action action pointer or nullptr.
+     *
+     * @note: Thread-safe
+     */
+    std::shared_ptr<flow_action> get_shared_modify(flow_action_modify_attr& attr);
+    /**
+     * @brief Get flow action reformat shared by all users of the same reformat data.
+     *
+     * @param [in] attr: Reformat action attributes.
+     *
+     * @retval flow_action action pointer or nullptr.
+     *
+     * @note: Thread-safe
+     */
+    std::shared_ptr<flow_action> get_shared_reformat(flow_action_reformat_attr& attr);
+    /**
+     * @brief Get statistics of shared flow actions.
+     *
+     * @param [out] stats: hit/miss counters, shared actions in use and HW capacity.
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status get_cache_stats(flow_action_cache_stats& stats);
 
 private:
     // Should be created only by @ref class adapter
     flow_action_generator(dcmd::ctx* ctx, const adapter_hca_capabilities* caps);
+
+    // Help functions
+    std::shared_ptr<flow_action> get_shared(action_cache_t& cache, const std::string& key,
+                                            const std::function<flow_action*()>& create);
 };
 
 /**
  * @brief: flow_rule_ex attributes.
  */
 struct flow_rule_attr_ex {
+    static const uint32_t FLOW_INDEX_AUTO = 0xFFFFFFFF; /*< group picks a free flow index */
+
     uint16_t priority; /*< flow rule priority */
     match_params_ex match_value; /*< flow rule match value, should be same fields as the masks
                                      provided to flow_group. */
     uint32_t flow_index; /*< The location of the rule on the flow table,
-                             index 0 will matched first. */
+                             index 0 will matched first, or FLOW_INDEX_AUTO. */
     std::vector<std::shared_ptr<flow_action>> actions; /* Flow actions to perform on the packet
                                                           when rule matched */
 
@@ -1830,9 +2680,9 @@ struct flow_rule_attr_ex {
  * from different threads unless thread-safety measures were taken by the application.
  */
 class flow_rule_ex : public obj {
+protected:
     typedef unordered_map<std::type_index, std::shared_ptr<flow_action>> action_map_t;
 
-protected:
     match_params_ex m_match_value;
     bool m_is_initialized;
     std::weak_ptr<const flow_table> m_table;
@@ -1862,27 +2712,152 @@ public:
      */
     const flow_rule_ex& operator=(const flow_rule_ex& fr) = delete;
     /**
-     * @brief Get flow_rule match values
+     * @brief Get flow_rule match values
+     *
+     * @param [out] match_val: Flow Rule Match Value
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status get_match_value(match_params_ex& match_val);
+    /**
+     * @brief Create flow rule HW object.
+     *
+     * @note: only after create is called the flow rule settings will actually configured
+     *        on the HW
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status create() = 0;
+    /**
+     * @brief Replace actions of created flow rule.
+     *
+     * @note: On flow tables created by the application the entry is modified in place,
+     *        the rule keeps matching packets and they hit either old or new actions.
+     *        Root table rules are kernel flows, the new flow is added before the old
+     *        one is removed. When the kernel refuses a second flow with the same match,
+     *        the old flow is removed first and packets are not matched by the rule
+     *        until the new flow is added.
+     *
+     * @param [in] actions: new flow actions, same restrictions as in @ref flow_rule_attr_ex.
+     *
+     * @retval Returns DPCP_OK on success, the old actions stay in effect otherwise.
+     */
+    virtual status modify(const std::vector<std::shared_ptr<flow_action>>& actions) = 0;
+    /**
+     * @brief Get flow index of the rule in the flow table.
+     *
+     * @param [out] index: flow index, also the one allocated by the group.
+     *
+     * @retval Returns DPCP_OK on success, DPCP_ERR_NO_SUPPORT for rules without index.
+     */
+    virtual status get_flow_index(uint32_t& index) const;
+    virtual ~flow_rule_ex() = default;
+
+protected:
+    // Help functions
+    static bool verify_flow_actions(const std::vector<std::shared_ptr<flow_action>>& actions,
+                                    action_map_t& action_map);
+
+private:
+    friend class flow_group;
+};
+
+/**
+ * @brief: Flow rule for @ref flow_rule_compiler, every rule brings its own mask.
+ */
+struct flow_rule_spec {
+    uint16_t priority; /**< Rules with lower value are looked up first. Order of overlapping
+                            rules with the same priority is not defined. */
+    uint8_t match_criteria_enable; /**< @ref flow_group_match_criteria_enable */
+    match_params_ex match_criteria; /**< Mask of the fields used by the rule. */
+    match_params_ex match_value;
+    std::vector<std::shared_ptr<flow_action>> actions;
+
+    flow_rule_spec()
+        : priority(0)
+        , match_criteria_enable(FG_MATCH_OUTER_HDR)
+    {
+    }
+};
+
+/**
+ * @brief: Flow table of @ref flow_plan.
+ */
+struct flow_plan_table {
+    flow_table_attr attr; /**< Level, size and miss action, table_miss of a chained table is
+                               set by @ref flow_rule_compiler::apply. */
+    uint16_t priority; /**< Priority of the rules placed in the table. */
+};
+
+/**
+ * @brief: Flow group of @ref flow_plan.
+ */
+struct flow_plan_group {
+    size_t table; /**< Index of the table in @ref flow_plan::tables. */
+    flow_group_attr attr;
+    std::vector<size_t> rules; /**< Indexes of the compiled rules, in flow index order. */
+};
+
+/**
+ * @brief: Flow tables and groups layout computed by @ref flow_rule_compiler::compile.
+ *
+ * Tables are ordered by lookup, every table forwards a miss to the next one and the last
+ * table keeps the miss action given to the compiler.
+ */
+struct flow_plan {
+    std::vector<flow_plan_table> tables;
+    std::vector<flow_plan_group> groups;
+};
+
+/**
+ * @brief: Objects created by @ref flow_rule_compiler::apply.
+ */
+struct flow_plan_objs {
+    std::vector<std::shared_ptr<flow_table>> tables; /**< The first one is the entry table. */
+    std::vector<std::weak_ptr<flow_group>> groups;
+    std::vector<std::weak_ptr<flow_rule_ex>> rules; /**< Indexed as the compiled rules. */
+};
+
+/**
+ * @brief: Flow rule set compiler.
+ *
+ * Computes flow tables and groups for a list of rules with arbitrary masks:
+ * rules with the same priority share a table, rules of a table with the same mask share
+ * a group, table size fits its groups and tables of lower priorities are chained behind by
+ * @ref FT_MISS_ACTION_FWD. The plan is created with @ref flow_table_prm and
+ * @ref flow_group_prm objects.
+ *
+ * Example (pseudo code):
+ * flow_rule_compiler::compile(rules, table_attr, plan);
+ * flow_rule_compiler::apply(adapter, plan, rules, objs);
+ * root_rule = root_group->add_flow_rule(match_params, fwd(objs.tables[0]));
+ */
+class flow_rule_compiler {
+public:
+    /**
+     * @brief Compute tables and groups for the rules.
      *
-     * @param [out] match_val: Flow Rule Match Value
+     * @param [in] rules: flow rules.
+     * @param [in] attr: attributes of the entry table: type, level, flags and miss action of
+     *                   the last table, log_size is computed.
+     * @param [out] plan: computed layout.
      *
-     * @retval Returns DPCP_OK on success.
+     * @retval Returns @ref dpcp::status with the status code.
      */
-    status get_match_value(match_params_ex& match_val);
+    static status compile(const std::vector<flow_rule_spec>& rules, const flow_table_attr& attr,
+                          flow_plan& plan);
     /**
-     * @brief Create flow rule HW object.
+     * @brief Create tables, groups and rules of the plan in HW.
      *
-     * @note: only after create is called the flow rule settings will actually configured
-     *        on the HW
+     * @param [in] ad: adapter to create flow tables on.
+     * @param [in] plan: layout computed by @ref compile.
+     * @param [in] rules: flow rules the plan was compiled for.
+     * @param [out] objs: created objects, released by the caller.
      *
-     * @retval Returns DPCP_OK on success.
+     * @retval Returns @ref dpcp::status with the status code, on failure nothing is kept.
      */
-    virtual status create() = 0;
-    virtual ~flow_rule_ex() = default;
-
-private:
-    // Help functions
-    bool verify_flow_actions(const std::vector<std::shared_ptr<flow_action>>& actions);
+    static status apply(adapter* ad, const flow_plan& plan,
+                        const std::vector<flow_rule_spec>& rules, flow_plan_objs& objs);
 };
 
 struct match_params {
@@ -1903,6 +2878,8 @@ struct match_params {
         uint32_t ipv4;
         uint8_t ipv6[16];
     } src;
+    uint32_t flow_label; // 20 bits, IPv6 only
+    uint8_t traffic_class; // IPv6 traffic class or IPv4 TOS: DSCP and ECN
 };
 
 typedef std::vector<tir*> dst_tir_vec;
@@ -2199,6 +3176,26 @@ struct flow_table_fields_capabilities {
     bool prog_sample_field; /**< When set, match on Flex programmable parser fields supported */
     bool metadata_reg_c_0; /**< When set, match on metadata reg_c_0 supported */
     bool metadata_reg_c_1; /**< When set, match on metadata reg_c_1 supported */
+    bool metadata_reg_c_2; /**< When set, match on metadata reg_c_2 supported */
+    bool metadata_reg_c_3; /**< When set, match on metadata reg_c_3 supported */
+    bool metadata_reg_c_4; /**< When set, match on metadata reg_c_4 supported */
+    bool metadata_reg_c_5; /**< When set, match on metadata reg_c_5 supported */
+    bool metadata_reg_c_6; /**< When set, match on metadata reg_c_6 supported */
+    bool metadata_reg_c_7; /**< When set, match on metadata reg_c_7 supported */
+    bool metadata_reg_a; /**< When set, metadata reg_a supported. Derived from the table type */
+    bool metadata_reg_b; /**< When set, metadata reg_b supported. Derived from the table type */
+    bool outer_ipv4_ttl; /**< When set, match on outer TTL/hop limit supported */
+    bool outer_second_vid; /**< When set, match on outer second VLAN id supported */
+    bool outer_frag; /**< When set, match on outer fragment flag supported */
+    bool outer_ip_ecn; /**< When set, match on outer IP ECN supported */
+    bool outer_ip_dscp; /**< When set, match on outer IP DSCP supported */
+    bool outer_tcp_flags; /**< When set, match on outer TCP flags supported */
+    bool inner_ipv4_ttl; /**< When set, match on inner TTL/hop limit supported */
+    bool inner_second_vid; /**< When set, match on inner second VLAN id supported */
+    bool inner_frag; /**< When set, match on inner fragment flag supported */
+    bool inner_ip_ecn; /**< When set, match on inner IP ECN supported */
+    bool inner_ip_dscp; /**< When set, match on inner IP DSCP supported */
+    bool inner_tcp_flags; /**< When set, match on inner TCP flags supported */
 };
 
 /*
@@ -2269,6 +3266,7 @@ struct flow_table_type_capabilities {
                                                 Entries with reparse indication or Rule Table
                                                 Context(RTC) with always reparse mode.
                                             */
+    bool is_flow_action_counter_supported; /**< Flow counters can be attached to Flow Rules */
     modify_flow_action_capabilities modify_flow_action_caps; /**< Flow Action modify capabilities */
     flow_table_fields_capabilities ft_field_support; /**< Supported fields for the table. */
 };
@@ -2278,8 +3276,12 @@ struct flow_table_type_capabilities {
  */
 struct flow_table_capabilities {
     reformat_flow_action_capabilities reformat_flow_action_caps;
+    uint32_t max_flow_counter; /**< Maximum number of flow counters, 0 if not supported */
+    uint8_t log_max_flow_counter_bulk; /**< Log (base 2) of maximum flow counters allocated
+                                            in one bulk @ref flow_counter_bulk */
 
     flow_table_type_capabilities receive;
+    flow_table_type_capabilities transmit;
 };
 
 /*
@@ -2353,6 +3355,12 @@ typedef struct adapter_hca_capabilities {
     bool ibq; /** <indicates Inline Buffer Queue capability (IBQ) */
     uint64_t ibq_wire_protocol; /**< List of supported protocols for IBQ @ref dpcp_ibq_protocol */
     uint16_t ibq_max_scatter_offset; /**< IBQ maximum supported scatter offset */
+    bool hairpin; /**< Hairpin RQ and SQ are supported */
+    uint8_t log_max_hairpin_queues; /**< Log (base 2) of maximum number of hairpin queues */
+    uint8_t log_max_hairpin_wq_data_sz; /**< Log (base 2) of maximum data size of hairpin queue */
+    uint8_t log_min_hairpin_wq_data_sz; /**< Log (base 2) of minimum data size of hairpin queue */
+    uint8_t log_max_hairpin_num_packets; /**< Log (base 2) of maximum packets in hairpin queue */
+    uint16_t vhca_id; /**< Virtual HCA id of the device */
     bool general_object_types_parse_graph_node; /**< If set, creation of programmable parse graph
                                                    node is supported. */
     uint32_t parse_graph_node_in; /**< Bitmask for the supported protocol headers that programmable
@@ -2394,6 +3402,9 @@ typedef struct adapter_hca_capabilities {
     bool is_flow_table_caps_supported; /**< Capability to query flow table HCH.cap */
     flow_table_capabilities flow_table_caps; /**< Flow table from type receive capabilities */
     nvmeotcp_capabilities nvmeotcp_caps; /**< NVMe/TCP capabilities flags */
+    bool relaxed_ordering_write; /**< Relaxed ordering of PCIe writes is supported */
+    bool relaxed_ordering_read; /**< Relaxed ordering of PCIe reads is supported */
+    uint8_t log_max_rqt_size; /**< Log (base 2) of maximum number of RQT entries */
 } adapter_hca_capabilities;
 
 typedef std::unordered_map<int, void*> caps_map_t;
@@ -2429,6 +3440,15 @@ protected:
     uint32_t m_wqe_num; // should be **2
     uint32_t m_wqe_sz; // should be 64 bytes
 
+    /**
+     * @brief Sets additional SQ context fields of MODIFY_SQ
+     */
+    virtual void prepare_modify(void* p_sqc, sq_state new_state)
+    {
+        (void)p_sqc;
+        (void)new_state;
+    }
+
 public:
     sq(dcmd::ctx* ctx, sq_attr& attr);
     /**
@@ -2541,6 +3561,27 @@ public:
     virtual status destroy();
 };
 
+/**
+ * @brief class hairpin_sq - Handles hairpin SendQueue, peer of hairpin_rq
+ *
+ */
+class hairpin_sq : public sq {
+    friend class adapter;
+    hairpin_attr m_hp_attr;
+    uint32_t m_peer_rqn;
+    uint16_t m_peer_vhca;
+
+    hairpin_sq(dcmd::ctx* ctx, sq_attr& attr, const hairpin_attr& hp_attr);
+
+    status create();
+    virtual void prepare_modify(void* p_sqc, sq_state new_state) override;
+
+public:
+    virtual ~hairpin_sq()
+    {
+    }
+};
+
 /**
  * @brief: Header tunneling type for parser graph node sampling.
  *
@@ -2807,6 +3848,396 @@ struct adapter_info {
     uint32_t vendor_part_id; /**< PCI Vendor Device Id */
 };
 
+typedef std::function<status()> cmd_fn;
+typedef std::function<void(status)> cmd_cb;
+
+/**
+ * @brief class cmd_batch - Executes many DevX commands concurrently
+ *
+ * Firmware commands are blocking round trips, cmd_batch keeps up to depth
+ * of them in flight. Create and modify commands are executed by worker threads
+ * of the adapter, which are shared by all its batches, submit() blocks while
+ * depth commands of the batch are queued or running.
+ * Queries use asynchronous DevX command channel when it is supported. If the
+ * channel fails, outstanding queries are completed with DPCP_ERR_QUERY and
+ * next queries are executed by workers.
+ * Commands in one batch must not depend on each other.
+ *
+ * Application can create a dpcp::cmd_batch only via
+ * dpcp::adapter->create_cmd_batch().
+ */
+class cmd_batch {
+    friend class adapter;
+    friend class cmd_queue;
+
+    struct query_slot {
+        void* m_out;
+        size_t m_out_sz;
+        cmd_cb m_cb;
+    };
+
+    adapter* m_adapter;
+    uint32_t m_depth;
+    cmd_queue* m_queue;
+    uint32_t m_queued; // commands in m_queue, guarded by its lock
+    uint32_t m_running; // commands executed by workers, guarded by m_queue lock
+    dcmd::cmd_comp* m_comp;
+    std::mutex m_query_lock;
+    std::vector<query_slot> m_slots;
+    std::vector<uint32_t> m_free_slots;
+    std::vector<uint8_t> m_resp;
+
+    cmd_batch(adapter* ad, cmd_queue* queue, uint32_t depth);
+    status init();
+    status reap_query(cmd_cb& cb, status& cb_ret);
+    void fail_queries(std::unique_lock<std::mutex>& lock);
+
+public:
+    virtual ~cmd_batch();
+    /**
+     * @brief Submits command for execution by the batch
+     *
+     * @param [in]  fn              Command, e.g. lambda calling tir::create()
+     * @param [in]  cb              Called with command status from worker thread, may be empty
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status submit(cmd_fn fn, cmd_cb cb);
+    /**
+     * @brief Submits command for execution by the batch
+     *
+     * @param [in]  fn              Command, e.g. lambda calling tir::create()
+     * @param [out] result          Future receiving command status
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status submit(cmd_fn fn, std::future<status>& result);
+    /**
+     * @brief Queries object in HW without waiting for the result
+     *
+     * @param [in]  o               Object to query
+     * @param [in]  in              Query command, must be valid until the call returns
+     * @param [in]  in_sz           Size of query command in bytes
+     * @param [out] out             Query output, must be valid until completion
+     * @param [in]  out_sz          Size of output buffer in bytes
+     * @param [in]  cb              Called with query status from query() or wait_all(),
+     *                              may be empty
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status query(obj& o, void* in, size_t in_sz, void* out, size_t out_sz, cmd_cb cb);
+    /**
+     * @brief Waits for completion of all submitted commands
+     *
+     * @retval Returns DPCP_OK on success, or the error of query completion
+     *         channel.
+     */
+    status wait_all();
+    /**
+     * @brief Returns maximal number of commands in flight
+     */
+    inline uint32_t get_depth() const
+    {
+        return m_depth;
+    }
+    /**
+     * @brief Returns true when queries use asynchronous DevX commands
+     */
+    inline bool is_async_query() const
+    {
+        return nullptr != m_comp;
+    }
+};
+
+/**
+ * @brief struct flow_counter_stats - Traffic counted by a flow counter
+ */
+struct flow_counter_stats {
+    uint64_t packets;
+    uint64_t bytes;
+};
+
+/**
+ * @brief struct flow_counter_snapshot - Cached values of a flow counter bulk
+ */
+struct flow_counter_snapshot {
+    std::vector<flow_counter_stats> stats; // indexed by counter offset in the bulk
+    uint64_t timestamp_ms; // steady clock time of the query
+    uint64_t generation; // incremented by every refresh
+};
+
+/**
+ * @brief class flow_counter_bulk - Flow counters allocated by one ALLOC_FLOW_COUNTER
+ *
+ * Counters of a bulk have consecutive ids and are queried together by a single
+ * QUERY_FLOW_COUNTER for any range. A counter is attached to flow rules by
+ * @ref flow_action_generator::create_counter.
+ *
+ * refresh_snapshot() queries the whole bulk and publishes the values, get_snapshot()
+ * returns the last published values without issuing a command, so monitoring threads
+ * never block the control thread and vice versa.
+ *
+ * Application can create a dpcp::flow_counter_bulk only via
+ * dpcp::adapter->create_flow_counter_bulk().
+ */
+class flow_counter_bulk : public obj {
+    friend class adapter;
+
+    uint32_t m_size;
+    std::mutex m_refresh_lock;
+    std::shared_ptr<const flow_counter_snapshot> m_snapshot; /**< atomic access only */
+
+    flow_counter_bulk(dcmd::ctx* ctx, uint32_t size);
+    status create();
+    status prepare_query(void* in, uint32_t offset, uint32_t num, bool clear);
+    status query_range(uint32_t first, uint32_t count, uint32_t offset, uint32_t num,
+                       flow_counter_stats* stats, bool clear);
+
+public:
+    virtual ~flow_counter_bulk() = default;
+    /**
+     * @brief Returns number of counters in the bulk
+     */
+    inline uint32_t get_size() const
+    {
+        return m_size;
+    }
+    /**
+     * @brief Returns HW id of a counter
+     *
+     * @param [in]  offset          Counter offset in the bulk
+     * @param [out] id              Counter id
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status get_counter_id(uint32_t offset, uint32_t& id);
+    /**
+     * @brief Queries range of counters by a single command
+     *
+     * @param [in]  offset          First counter offset in the bulk
+     * @param [in]  num             Number of counters
+     * @param [out] stats           Values of num counters
+     * @param [in]  clear           Reset counters after read. Only the requested counters
+     *                              are reset, an unaligned range is then read by one
+     *                              command per counter.
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status query(uint32_t offset, uint32_t num, std::vector<flow_counter_stats>& stats,
+                 bool clear = false);
+    /**
+     * @brief Queries range of counters, HW writes the values to registered memory
+     *
+     * Memory receives num records in HW format, convert them by @ref parse.
+     *
+     * @param [in]  offset          First counter offset in the bulk
+     * @param [in]  num             Number of counters
+     * @param [in]  lkey            Key of memory registration covering addr
+     * @param [in]  addr            Buffer of num * FLOW_COUNTER_RECORD_SIZE bytes
+     * @param [in]  clear           Reset counters after read
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status query_to_memory(uint32_t offset, uint32_t num, uint32_t lkey, void* addr,
+                           bool clear = false);
+    /**
+     * @brief Posts query of range of counters to registered memory without waiting
+     *
+     * @param [in]  batch           Command batch executing the query
+     * @param [in]  offset          First counter offset in the bulk
+     * @param [in]  num             Number of counters
+     * @param [in]  lkey            Key of memory registration covering addr
+     * @param [in]  addr            Buffer of num * FLOW_COUNTER_RECORD_SIZE bytes
+     * @param [in]  cb              Called with query status when memory is written,
+     *                              may be empty
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status query_to_memory(cmd_batch& batch, uint32_t offset, uint32_t num, uint32_t lkey,
+                           void* addr, std::function<void(status)> cb);
+    /**
+     * @brief Converts counter records written by HW
+     *
+     * @param [in]  records         Records written by @ref query_to_memory
+     * @param [in]  num             Number of records
+     * @param [out] stats           Array of num values
+     */
+    static void parse(const void* records, uint32_t num, flow_counter_stats* stats);
+    /**
+     * @brief Queries the whole bulk and publishes a new snapshot
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status refresh_snapshot();
+    /**
+     * @brief Returns the last published snapshot, does not issue commands
+     *
+     * @retval Returns nullptr before the first refresh_snapshot().
+     */
+    std::shared_ptr<const flow_counter_snapshot> get_snapshot() const;
+
+    enum { FLOW_COUNTER_RECORD_SIZE = 16 };
+};
+
+/**
+ * @brief struct flow_aging_attr - Flow aging attributes
+ */
+struct flow_aging_attr {
+    uint32_t timeout_ms; // rule is aged when its counter did not change for timeout_ms
+    uint32_t sweep_interval_ms; // period of background sweep, 0 - sweep() by application only
+    uint32_t remove_batch; // maximal number of aged rules removed per sweep, 0 - report only
+};
+
+/**
+ * @brief struct flow_aging_entry - Aged flow rule reported by flow_aging
+ */
+struct flow_aging_entry {
+    std::weak_ptr<flow_group> group;
+    std::weak_ptr<flow_rule_ex> rule; // empty for compact rules
+    flow_rule_handle handle; // handle of compact rule
+    bool is_compact;
+    flow_counter_bulk* bulk;
+    uint32_t offset; // counter offset in the bulk
+    uint64_t cookie; // application data passed on track
+    uint64_t idle_ms; // time since the last counter change
+    bool removed; // rule was removed by flow_aging
+};
+
+typedef std::function<void(const std::vector<flow_aging_entry>&)> flow_aging_cb;
+
+/**
+ * @brief class flow_aging - Finds flow rules without traffic
+ *
+ * Every tracked rule counts its traffic by a counter of flow_counter_bulk.
+ * A sweep refreshes snapshot of every bulk by a single query and compares
+ * counters with the previous sweep. Rules whose counters did not change
+ * for timeout_ms are reported once and are not tracked anymore.
+ * Aged rules are passed to the callback, called from the sweeping thread,
+ * or are queued for get_aged() when the callback is empty.
+ * With remove_batch set, aged rules are removed from their flow groups,
+ * at most remove_batch per sweep, and reported after the removal.
+ *
+ * Tracked groups must stay alive until untrack or destruction. Before a tracked bulk
+ * is deleted, untrack_bulk() or untrack() of its last counter must return, both wait
+ * for a running sweep to finish querying the bulk.
+ */
+class flow_aging {
+    struct slot {
+        std::weak_ptr<flow_group> group;
+        std::weak_ptr<flow_rule_ex> rule;
+        flow_rule_handle handle;
+        bool compact;
+        uint64_t cookie;
+        uint64_t packets;
+        uint64_t bytes;
+        uint64_t last_change_ms;
+        uint8_t state;
+    };
+
+    struct bulk_slots {
+        std::vector<slot> slots;
+        uint32_t used; // number of tracked slots
+        bool querying; // bulk is queried by a sweep, it can't be released
+    };
+
+    enum { SLOT_FREE = 0, SLOT_NEW, SLOT_TRACKED };
+
+    flow_aging_attr m_attr;
+    flow_aging_cb m_cb;
+    std::mutex m_lock; // protects m_bulks, m_tracked and m_aged
+    std::condition_variable m_query_cv; // signals end of bulk queries of a sweep
+    std::unordered_map<flow_counter_bulk*, bulk_slots> m_bulks;
+    size_t m_tracked;
+    std::vector<flow_aging_entry> m_aged;
+    std::mutex m_sweep_lock; // serializes sweeps, protects m_remove
+    std::vector<flow_aging_entry> m_remove;
+    aging_worker* m_worker;
+
+    status track(flow_counter_bulk& bulk, uint32_t offset, const slot& s);
+    void release_bulk(std::unique_lock<std::mutex>& lock, flow_counter_bulk* bulk);
+    void worker();
+
+public:
+    /**
+     * @brief Flow aging constructor, background sweep is not running until start()
+     *
+     * @param [in] attr         Flow aging attributes
+     * @param [in] cb           Called with aged rules, may be empty
+     */
+    flow_aging(const flow_aging_attr& attr, flow_aging_cb cb);
+    virtual ~flow_aging();
+    /**
+     * @brief Starts background sweep every sweep_interval_ms
+     *
+     * @retval Returns DPCP_OK on success.
+     *         Returns DPCP_ERR_INVALID_PARAM if sweep_interval_ms is 0.
+     */
+    status start();
+    /**
+     * @brief Stops background sweep, waits for the running sweep
+     */
+    void stop();
+    /**
+     * @brief Starts tracking of flow rule
+     *
+     * @param [in] bulk         Bulk of the counter attached to the rule
+     * @param [in] offset       Counter offset in the bulk
+     * @param [in] group        Flow group of the rule
+     * @param [in] rule         Flow rule
+     * @param [in] cookie       Application data reported with the rule
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status track(flow_counter_bulk& bulk, uint32_t offset, std::weak_ptr<flow_group> group,
+                 std::weak_ptr<flow_rule_ex> rule, uint64_t cookie = 0);
+    /**
+     * @brief Starts tracking of flow rule added by flow_group::add_flow_rule_compact()
+     *
+     * @param [in] bulk         Bulk of the counter attached to the rule
+     * @param [in] offset       Counter offset in the bulk
+     * @param [in] group        Flow group of the rule
+     * @param [in] handle       Flow rule handle
+     * @param [in] cookie       Application data reported with the rule
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status track_compact(flow_counter_bulk& bulk, uint32_t offset,
+                         std::weak_ptr<flow_group> group, flow_rule_handle handle,
+                         uint64_t cookie = 0);
+    /**
+     * @brief Stops tracking of counter, e.g. before the rule is removed by application
+     *
+     * @retval Returns DPCP_OK on success.
+     *         Returns DPCP_ERR_INVALID_PARAM if the counter is not tracked.
+     */
+    status untrack(flow_counter_bulk& bulk, uint32_t offset);
+    /**
+     * @brief Stops tracking of all counters of bulk, e.g. before the bulk is deleted
+     *
+     * @retval Returns DPCP_OK on success.
+     *         Returns DPCP_ERR_INVALID_PARAM if no counter of the bulk is tracked.
+     */
+    status untrack_bulk(flow_counter_bulk& bulk);
+    /**
+     * @brief Checks all tracked rules once
+     *
+     * @param [out] aged        Number of rules reported by this sweep
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status sweep(uint32_t& aged);
+    /**
+     * @brief Takes rules aged since the previous call, used when callback is empty
+     *
+     * @param [out] entries     Aged rules
+     */
+    void get_aged(std::vector<flow_aging_entry>& entries);
+    /**
+     * @brief Returns number of tracked rules
+     */
+    size_t get_tracked();
+};
+
 class adapter {
 private:
     status query_hca_caps();
@@ -2817,6 +4248,7 @@ private:
     td* m_td;
     pd* m_pd;
     uar_collection* m_uarpool;
+    cmd_queue* m_cmd_queue;
     void* m_ibv_pd;
     uint32_t m_pd_id;
     uint32_t m_td_id;
@@ -2826,10 +4258,11 @@ private:
     adapter_hca_capabilities* m_external_hca_caps;
     std::vector<cap_cb_fn> m_caps_callbacks;
     bool m_opened;
+    bool m_queue_relaxed_ordering;
     flow_action_generator m_flow_action_generator;
     std::shared_ptr<flow_table> m_root_table_arr[flow_table_type::FT_END];
     status prepare_basic_rq(basic_rq& srq);
-    status verify_flow_table_receive_attr(const flow_table_attr& attr);
+    status verify_flow_table_attr(const flow_table_attr& attr);
 
 public:
     adapter(dcmd::device* dev, dcmd::ctx* ctx);
@@ -2939,6 +4372,79 @@ public:
      */
     status create_pattern_mkey(void* address, mkey_flags flags, size_t stride_num, size_t bb_num,
                                pattern_mkey_bb bb_arr[], pattern_mkey*& mkey);
+
+    /**
+     * @brief Creates and returns chunked_mkey
+     *
+     * Registers large memory region by chunks in parallel, see chunked_mkey.
+     *
+     * @param [in]  address         Virtual Address
+     * @param [in]  length          Address Length in bytes
+     * @param [in]  flags           Modification flags for Chunked Mkey
+     * @param [in]  attr            Chunked registration attributes
+     * @param [out] mkey            On Success created chunked_mkey
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_chunked_mkey(void* address, size_t length, mkey_flags flags,
+                               const chunked_mkey_attr& attr, chunked_mkey*& mkey);
+
+    /**
+     * @brief Filters out mkey flags which are not supported by HCA
+     *
+     * Relaxed ordering flags are dropped when HCA capabilities do not allow them,
+     * other flags are returned as is.
+     *
+     * @param [in]  flags           Requested Mkey flags
+     *
+     * @retval      Returns flags which can be used on this adapter
+     */
+    mkey_flags get_supported_mkey_flags(mkey_flags flags) const;
+
+    /**
+     * @brief Enables relaxed ordering for queue memory
+     *
+     * Disabled by default. When enabled, WQ and CQ buffers of queues created
+     * afterwards are registered with relaxed ordering access, doorbell records
+     * are always strictly ordered. Enable it only when the platform is known to
+     * keep CQE writes ordered after the data they complete.
+     *
+     * @param [in]  enable          true to enable, false to disable
+     *
+     * @retval      Returns DPCP_OK on success
+     *              DPCP_ERR_NO_SUPPORT if HCA does not support relaxed ordering
+     */
+    status set_queue_relaxed_ordering(bool enable);
+
+    /**
+     * @brief Creates and returns buffer_pool with the first slab registered
+     *
+     * @param [in]  attr            Buffer pool attributes
+     * @param [out] pool            On Success created buffer_pool
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_buffer_pool(const buffer_pool_attr& attr, buffer_pool*& pool);
+
+    /**
+     * @brief Creates and returns cmd_batch
+     *
+     * @param [in]  depth           Maximal number of commands in flight
+     * @param [out] batch           On Success created cmd_batch
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_cmd_batch(uint32_t depth, cmd_batch*& batch);
+    /**
+     * @brief Creates and returns flow_counter_bulk
+     *
+     * @param [in]  num             Number of counters, rounded up to bulk size supported
+     *                              by HW: 1 or power of 2 from 128
+     * @param [out] bulk            On Success created flow_counter_bulk
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_flow_counter_bulk(uint32_t num, flow_counter_bulk*& bulk);
     /**
      * @brief Creates and returns reserved_mkey
      *
@@ -2976,7 +4482,18 @@ public:
      */
     status create_extern_mkey(void* address, size_t length, uint32_t id, extern_mkey*& mkey);
 
-    status create_crypto_mkey(crypto_mkey*& mkey, uint32_t max_sge);
+    /**
+     * @brief Creates and returns a crypto_mkey
+     *
+     * @param [out] mkey            On Success created crypto_mkey
+     * @param [in]  max_sge         Max number of scatter gather elements
+     * @param [in]  flags           MKEY_RELAXED_ORDERING_* flags, relaxed ordering is off
+     *                              by default
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_crypto_mkey(crypto_mkey*& mkey, uint32_t max_sge,
+                              mkey_flags flags = MKEY_NONE);
 
     /**
      * @brief Creates and returns CQ
@@ -3032,6 +4549,18 @@ public:
      */
     status create_tir(const tir::attr& tir_attr, tir*& tir_obj);
 
+    /**
+     * @brief Creates and returns DPCP RQT
+     *
+     * @param [in]  rqt_attr        Object attributes
+     * @param [out] rqt_obj         Pointer to RQT object on success
+     *
+     * @retval      Returns DPCP_OK on success
+     *              Returns DPCP_ERR_INVALID_PARAM if number of entries is not a power of two
+     *              Returns DPCP_ERR_OUT_OF_RANGE if max size exceeds log_max_rqt_size
+     */
+    status create_rqt(const rqt::attr& rqt_attr, rqt*& rqt_obj);
+
     /**
      * @brief Creates and returns DPCP TIS
      *
@@ -3045,6 +4574,9 @@ public:
     /**
      * @brief Get root flow table by type
      *
+     * Rules of the root table are created through the driver with the table type of the
+     * root table. On Windows only the receive root table accepts rules.
+     *
      * @param [in] type: Flow table type
      *
      * @retval Returns pointer to @ref flow_table or nullptr
@@ -3095,6 +4627,21 @@ public:
      */
     status create_pp_sq(sq_attr& sq_attr, pp_sq*& sq);
 
+    /**
+     * @brief Creates hairpin RQ and SQ bound to each other, both in ready state
+     *
+     * Packets steered to the RQ are sent by the SQ without CPU involvement,
+     * headers can be changed by modify and reformat actions of the steering.
+     *
+     * @param [in]  attr            Hairpin attributes
+     * @param [out] rq              On Success created hairpin_rq
+     * @param [out] sq              On Success created hairpin_sq
+     *
+     * @retval      Returns DPCP_OK on success
+     *              Returns DPCP_ERR_INVALID_PARAM if attr.tis_num is not set
+     */
+    status create_hairpin_pair(const hairpin_attr& attr, hairpin_rq*& rq, hairpin_sq*& sq);
+
     /**
      * @brief Get general HCA capabilities
      *
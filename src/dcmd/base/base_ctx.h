@@ -43,6 +43,8 @@ class obj;
 class uar;
 class umem;
 class flow;
+class flow_matcher;
+class cmd_comp;
 class action_fwd;
 
 class base_ctx {
@@ -59,6 +61,8 @@ public:
     virtual uar* create_uar(struct uar_desc* desc) = 0;
     virtual umem* create_umem(struct umem_desc* desc) = 0;
     virtual flow* create_flow(struct flow_desc* desc) = 0;
+    virtual flow_matcher* create_flow_matcher(struct flow_desc* desc) = 0;
+    virtual cmd_comp* create_cmd_comp() = 0;
     std::unique_ptr<action_fwd> create_action_fwd(const std::vector<fwd_dst_desc>& dests);
 };
 
@@ -34,6 +34,8 @@
 
 namespace dcmd {
 
+class cmd_comp;
+
 class base_obj {
 public:
     base_obj()
@@ -45,6 +47,7 @@ public:
 
     virtual int query(struct obj_desc* desc) = 0;
     virtual int modify(struct obj_desc* desc) = 0;
+    virtual int query_async(struct obj_desc* desc, uint64_t wr_id, cmd_comp* comp) = 0;
 };
 
 } /* namespace dcmd */
@@ -158,6 +158,9 @@ struct modify_action {
 struct flow_desc {
     struct flow_match_parameters* match_criteria;
     struct flow_match_parameters* match_value;
+    flow_matcher* matcher; /* shared matcher, flow creates own one if not set */
+    uint8_t match_criteria_enable;
+    uint8_t table_type; /* MLX5_FLOW_TABLE_TYPE_* of the root table */
     obj_handle* dst_obj;
     mlx5_ifc_dest_format_struct_bits* dst_formats;
     uint32_t flow_id;
@@ -170,6 +173,9 @@ struct flow_desc {
     flow_desc()
         : match_criteria()
         , match_value()
+        , matcher()
+        , match_criteria_enable(1 << MLX5_CREATE_FLOW_GROUP_IN_MATCH_CRITERIA_ENABLE_OUTER_HEADERS)
+        , table_type(MLX5_FLOW_TABLE_TYPE_NIC_RX)
         , dst_obj()
         , dst_formats()
         , flow_id()
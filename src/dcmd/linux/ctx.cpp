@@ -93,6 +93,19 @@ obj* ctx::create_obj(struct obj_desc* desc)
     return obj_ptr;
 }
 
+cmd_comp* ctx::create_cmd_comp()
+{
+    cmd_comp* obj_ptr = nullptr;
+
+    try {
+        obj_ptr = new cmd_comp(m_handle);
+    } catch (...) {
+        return nullptr;
+    }
+
+    return obj_ptr;
+}
+
 uar* ctx::create_uar(struct uar_desc* desc)
 {
 
@@ -135,6 +148,19 @@ flow* ctx::create_flow(struct flow_desc* desc)
     return obj_ptr;
 }
 
+flow_matcher* ctx::create_flow_matcher(struct flow_desc* desc)
+{
+    flow_matcher* obj_ptr = nullptr;
+
+    try {
+        obj_ptr = new flow_matcher(m_handle, desc);
+    } catch (...) {
+        return nullptr;
+    }
+
+    return obj_ptr;
+}
+
 int ctx::query_eqn(uint32_t cpu_num, uint32_t& eqn)
 {
     int ret = mlx5dv_devx_query_eqn(m_handle, cpu_num, &eqn);
@@ -48,6 +48,7 @@ public:
     void* get_context();
     int exec_cmd(const void* in, size_t inlen, void* out, size_t outlen);
     obj* create_obj(struct obj_desc* desc);
+    cmd_comp* create_cmd_comp();
     uar* create_uar(struct uar_desc* desc);
     umem* create_umem(struct umem_desc* desc);
     ibv_mr* ibv_reg_mem_reg_iova(struct ibv_pd* verbs_pd, void* addr, size_t length, uint64_t iova,
@@ -56,6 +57,7 @@ public:
                             unsigned int access);
     int ibv_dereg_mem_reg(struct ibv_mr* umem);
     flow* create_flow(struct flow_desc* desc);
+    flow_matcher* create_flow_matcher(struct flow_desc* desc);
     int query_eqn(uint32_t cpu_num, uint32_t& eqn);
     int hca_iseg_mapping();
     uint64_t get_real_time();
@@ -64,6 +66,10 @@ public:
     {
         return IBV_ACCESS_LOCAL_WRITE;
     }
+    inline int ibv_get_relaxed_ordering_flags()
+    {
+        return IBV_ACCESS_RELAXED_ORDERING;
+    }
 
 private:
     ctx_handle m_handle;
@@ -36,27 +36,60 @@
 
 using namespace dcmd;
 
-flow::flow(ctx_handle handle, struct flow_desc* desc)
+static enum mlx5dv_flow_table_type get_table_type(struct flow_desc* desc)
+{
+    return desc->table_type == MLX5_FLOW_TABLE_TYPE_NIC_TX ? MLX5_IB_UAPI_FLOW_TABLE_TYPE_NIC_TX
+                                                           : MLX5_IB_UAPI_FLOW_TABLE_TYPE_NIC_RX;
+}
+
+static struct mlx5dv_flow_matcher* create_matcher(ctx_handle handle, struct flow_desc* desc)
 {
-    struct ibv_flow* ib_flow;
-    struct mlx5dv_flow_matcher* matcher = NULL;
     struct mlx5dv_flow_matcher_attr matcher_attr;
 
     memset(&matcher_attr, 0, sizeof(matcher_attr));
     matcher_attr.type = IBV_FLOW_ATTR_NORMAL;
     matcher_attr.flags = 0;
     matcher_attr.priority = desc->priority;
-    // Only outer header for now!!!
-    matcher_attr.match_criteria_enable = 1
-        << MLX5_CREATE_FLOW_GROUP_IN_MATCH_CRITERIA_ENABLE_OUTER_HEADERS;
+    matcher_attr.match_criteria_enable = desc->match_criteria_enable;
     matcher_attr.match_mask = (struct mlx5dv_flow_match_parameters*)desc->match_criteria;
     matcher_attr.comp_mask = MLX5DV_FLOW_MATCHER_MASK_FT_TYPE;
-    matcher_attr.ft_type = MLX5_IB_UAPI_FLOW_TABLE_TYPE_NIC_RX;
+    matcher_attr.ft_type = get_table_type(desc);
+
+    return mlx5dv_create_flow_matcher(handle, &matcher_attr);
+}
 
-    matcher = mlx5dv_create_flow_matcher(handle, &matcher_attr);
-    if (NULL == matcher) {
+flow_matcher::flow_matcher(ctx_handle handle, struct flow_desc* desc)
+{
+    m_handle = create_matcher(handle, desc);
+    if (NULL == m_handle) {
         throw DCMD_ENOTSUP;
     }
+}
+
+flow_matcher::~flow_matcher()
+{
+    if (m_handle) {
+        mlx5dv_destroy_flow_matcher(m_handle);
+        m_handle = nullptr;
+    }
+}
+
+flow::flow(ctx_handle handle, struct flow_desc* desc)
+{
+    struct ibv_flow* ib_flow;
+    struct mlx5dv_flow_matcher* matcher = NULL;
+    struct mlx5dv_flow_matcher* own_matcher = NULL;
+
+    // Rules of one group share the matcher, otherwise the flow owns its matcher.
+    if (desc->matcher) {
+        matcher = desc->matcher->get_handle();
+    } else {
+        own_matcher = create_matcher(handle, desc);
+        if (NULL == own_matcher) {
+            throw DCMD_ENOTSUP;
+        }
+        matcher = own_matcher;
+    }
 
     size_t num_actions = (desc->flow_id ? (desc->num_dst_obj + 1) : desc->num_dst_obj);
     num_actions += desc->modify_actions ? 1 : 0;
@@ -73,8 +106,11 @@ flow::flow(ctx_handle handle, struct flow_desc* desc)
         actions_attr[i].type = MLX5DV_FLOW_ACTION_IBV_FLOW_ACTION;
         actions_attr[i].action = mlx5dv_create_flow_action_modify_header(
             handle, sizeof(modify_action) * desc->num_of_actions, (uint64_t*)desc->modify_actions,
-            MLX5_IB_UAPI_FLOW_TABLE_TYPE_NIC_RX);
+            get_table_type(desc));
         if (!actions_attr[i].action) {
+            if (own_matcher) {
+                mlx5dv_destroy_flow_matcher(own_matcher);
+            }
             throw DCMD_ENOTSUP;
         }
         i++;
@@ -87,10 +123,12 @@ flow::flow(ctx_handle handle, struct flow_desc* desc)
     ib_flow = mlx5dv_create_flow(matcher, (struct mlx5dv_flow_match_parameters*)desc->match_value,
                                  num_actions, actions_attr);
     if (NULL == ib_flow) {
-        mlx5dv_destroy_flow_matcher(matcher);
+        if (own_matcher) {
+            mlx5dv_destroy_flow_matcher(own_matcher);
+        }
         throw DCMD_ENOTSUP;
     }
-    m_matcher = matcher;
+    m_matcher = own_matcher;
     m_handle = ib_flow;
 }
 
@@ -99,7 +137,9 @@ flow::~flow()
     if (m_handle) {
         ibv_destroy_flow(m_handle);
         m_handle = nullptr;
-        mlx5dv_destroy_flow_matcher(m_matcher);
-        m_matcher = nullptr;
+        if (m_matcher) {
+            mlx5dv_destroy_flow_matcher(m_matcher);
+            m_matcher = nullptr;
+        }
     }
 }
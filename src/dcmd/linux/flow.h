@@ -36,18 +36,32 @@
 
 namespace dcmd {
 
+class flow_matcher {
+public:
+    flow_matcher(ctx_handle handle, struct flow_desc* desc);
+    virtual ~flow_matcher();
+    struct mlx5dv_flow_matcher* get_handle() const
+    {
+        return m_handle;
+    }
+
+private:
+    struct mlx5dv_flow_matcher* m_handle;
+};
+
 class flow : public base_flow {
 public:
     flow()
     {
         m_handle = nullptr;
+        m_matcher = nullptr;
     }
     flow(ctx_handle handle, struct flow_desc* desc);
     virtual ~flow();
 
 private:
     flow_handle m_handle;
-    struct mlx5dv_flow_matcher* m_matcher;
+    struct mlx5dv_flow_matcher* m_matcher; /* own matcher, nullptr if shared one is used */
 };
 
 } /* namespace dcmd */
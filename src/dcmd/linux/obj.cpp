@@ -96,3 +96,63 @@ int obj::modify(struct obj_desc* desc)
               desc->in, desc->inlen, desc->out, desc->outlen, errno, ret);
     return (ret ? DCMD_EIO : DCMD_EOK);
 }
+
+int obj::query_async(struct obj_desc* desc, uint64_t wr_id, cmd_comp* comp)
+{
+    if (!desc || !comp) {
+        return DCMD_EINVAL;
+    }
+
+    int ret = mlx5dv_devx_obj_query_async(m_handle, desc->in, desc->inlen, desc->outlen, wr_id,
+                                          comp->get_handle());
+    log_trace("obj::query_async(%p) in: %p in_sz: %ld out_sz: %ld wr_id: %llu errno=%d ret=%d\n",
+              m_handle, desc->in, desc->inlen, desc->outlen, (unsigned long long)wr_id, errno, ret);
+    return (ret ? DCMD_EIO : DCMD_EOK);
+}
+
+cmd_comp::cmd_comp(ctx_handle handle)
+    : m_handle(nullptr)
+    , m_resp()
+{
+    if (!handle) {
+        throw DCMD_EINVAL;
+    }
+
+    m_handle = mlx5dv_devx_create_cmd_comp(handle);
+    log_trace("cmd_comp(%p) handle: %p errno=%d\n", m_handle, handle, errno);
+    if (nullptr == m_handle) {
+        throw DCMD_ENOTSUP;
+    }
+}
+
+cmd_comp::~cmd_comp()
+{
+    if (m_handle) {
+        mlx5dv_devx_destroy_cmd_comp(m_handle);
+        m_handle = nullptr;
+    }
+}
+
+int cmd_comp::get_fd()
+{
+    return m_handle->fd;
+}
+
+int cmd_comp::get_comp(uint64_t& wr_id, void* out, size_t outlen)
+{
+    size_t resp_len = sizeof(struct mlx5dv_devx_async_cmd_hdr) + outlen;
+    if (m_resp.size() < resp_len) {
+        m_resp.resize(resp_len);
+    }
+
+    // Blocks until the next command completes
+    struct mlx5dv_devx_async_cmd_hdr* hdr = (struct mlx5dv_devx_async_cmd_hdr*)m_resp.data();
+    int ret = mlx5dv_devx_get_async_cmd_comp(m_handle, hdr, resp_len);
+    if (ret) {
+        log_trace("cmd_comp::get_comp(%p) errno=%d ret=%d\n", m_handle, errno, ret);
+        return DCMD_EIO;
+    }
+    wr_id = hdr->wr_id;
+    memcpy(out, hdr->out_data, outlen);
+    return DCMD_EOK;
+}
@@ -355,7 +355,7 @@ struct mlx5_ifc_flow_table_fields_supported_bits {
     u8 inner_first_prio[0x1];
     u8 inner_first_cfi[0x1];
     u8 inner_first_vid[0x1];
-    u8 reserved_at_27[0x1];
+    u8 inner_ipv4_ttl[0x1];
     u8 inner_second_prio[0x1];
     u8 inner_second_cfi[0x1];
     u8 inner_second_vid[0x1];
@@ -561,7 +561,10 @@ struct mlx5_ifc_fte_match_set_misc_bits {
     u8 vxlan_vni[0x18];
     u8 reserved_at_b8[0x8];
 
-    u8 reserved_at_c0[0x20];
+    u8 geneve_vni[0x18];
+    u8 reserved_at_d8[0x6];
+    u8 geneve_tlv_option_0_exist[0x1];
+    u8 geneve_oam[0x1];
 
     u8 reserved_at_e0[0xc];
     u8 outer_ipv6_flow_label[0x14];
@@ -569,7 +572,11 @@ struct mlx5_ifc_fte_match_set_misc_bits {
     u8 reserved_at_100[0xc];
     u8 inner_ipv6_flow_label[0x14];
 
-    u8 reserved_at_120[0x28];
+    u8 reserved_at_120[0xa];
+    u8 geneve_opt_len[0x6];
+    u8 geneve_protocol_type[0x10];
+
+    u8 reserved_at_140[0x8];
     u8 bth_dst_qp[0x18];
     u8 reserved_at_160[0x20];
     u8 outer_esp_spi[0x20];
@@ -1051,7 +1058,8 @@ struct mlx5_ifc_cmd_hca_cap_bits {
     u8 log_max_cq[0x5];
 
     u8 log_max_eq_sz[0x8];
-    u8 reserved_at_e8[0x2];
+    u8 relaxed_ordering_write[0x1];
+    u8 relaxed_ordering_read_pci_enabled[0x1];
     u8 log_max_mkey[0x6];
     u8 reserved_at_f0[0x4];
     u8 cmd_on_behalf[0x1];
@@ -3374,7 +3382,9 @@ struct mlx5_ifc_mkc_bits {
 
     u8 translations_octword_size[0x20];
 
-    u8 reserved_at_1c0[0x1b];
+    u8 reserved_at_1c0[0x19];
+    u8 relaxed_ordering_read[0x1];
+    u8 reserved_at_1da[0x1];
     u8 log_entity_size[0x5];
 
     u8 reserved_at_1e0[0x3];
@@ -4077,6 +4087,11 @@ struct mlx5_ifc_set_hca_cap_in_bits {
     union mlx5_ifc_hca_cap_union_bits capability;
 };
 
+enum {
+    MLX5_SET_FTE_OP_MOD_SET = 0x0,
+    MLX5_SET_FTE_OP_MOD_MODIFY = 0x1,
+};
+
 enum {
     MLX5_SET_FTE_MODIFY_ENABLE_MASK_ACTION = 0x0,
     MLX5_SET_FTE_MODIFY_ENABLE_MASK_FLOW_TAG = 0x1,
@@ -5217,11 +5232,15 @@ struct mlx5_ifc_query_flow_counter_in_bits {
     u8 reserved_at_20[0x10];
     u8 op_mod[0x10];
 
-    u8 reserved_at_40[0x80];
+    u8 reserved_at_40[0x20];
+
+    u8 mkey[0x20];
+
+    u8 address[0x40];
 
     u8 clear[0x1];
-    u8 reserved_at_c1[0xf];
-    u8 num_of_counters[0x10];
+    u8 dump_to_memory[0x1];
+    u8 num_of_counters[0x1e];
 
     u8 flow_counter_id[0x20];
 };
@@ -5566,6 +5585,16 @@ enum {
     MLX5_ACTION_IN_FIELD_OUT_SIPV4 = 0x15,
     MLX5_ACTION_IN_FIELD_OUT_DIPV4 = 0x16,
     MLX5_ACTION_IN_FIELD_OUT_IPV6_HOPLIMIT = 0x47,
+    MLX5_ACTION_IN_FIELD_METADATA_REG_A = 0x49,
+    MLX5_ACTION_IN_FIELD_METADATA_REG_B = 0x50,
+    MLX5_ACTION_IN_FIELD_METADATA_REG_C_0 = 0x51,
+    MLX5_ACTION_IN_FIELD_METADATA_REG_C_1 = 0x52,
+    MLX5_ACTION_IN_FIELD_METADATA_REG_C_2 = 0x53,
+    MLX5_ACTION_IN_FIELD_METADATA_REG_C_3 = 0x54,
+    MLX5_ACTION_IN_FIELD_METADATA_REG_C_4 = 0x55,
+    MLX5_ACTION_IN_FIELD_METADATA_REG_C_5 = 0x56,
+    MLX5_ACTION_IN_FIELD_METADATA_REG_C_6 = 0x57,
+    MLX5_ACTION_IN_FIELD_METADATA_REG_C_7 = 0x58,
 };
 
 struct mlx5_ifc_alloc_modify_header_context_out_bits {
@@ -7674,6 +7703,11 @@ struct mlx5_ifc_flow_table_context_bits {
     u8 sw_owner_icm_root_0[0x40];
 };
 
+enum {
+    MLX5_FLOW_TABLE_TYPE_NIC_RX = 0x0,
+    MLX5_FLOW_TABLE_TYPE_NIC_TX = 0x1,
+};
+
 struct mlx5_ifc_create_flow_table_in_bits {
     u8 opcode[0x10];
     u8 reserved_at_10[0x10];
@@ -8124,7 +8158,8 @@ struct mlx5_ifc_alloc_flow_counter_in_bits {
     u8 reserved_at_20[0x10];
     u8 op_mod[0x10];
 
-    u8 reserved_at_40[0x40];
+    u8 reserved_at_40[0x38];
+    u8 flow_counter_bulk[0x8];
 };
 
 struct mlx5_ifc_add_vxlan_udp_dport_out_bits {
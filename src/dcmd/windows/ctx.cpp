@@ -78,6 +78,19 @@ obj* ctx::create_obj(struct obj_desc* desc)
     return obj_ptr;
 }
 
+cmd_comp* ctx::create_cmd_comp()
+{
+    cmd_comp* obj_ptr = nullptr;
+
+    try {
+        obj_ptr = new cmd_comp(m_handle);
+    } catch (...) {
+        return nullptr;
+    }
+
+    return obj_ptr;
+}
+
 uar* ctx::create_uar(struct uar_desc* desc)
 {
     uar* obj_ptr = nullptr;
@@ -117,6 +130,13 @@ flow* ctx::create_flow(struct flow_desc* desc)
     return obj_ptr;
 }
 
+flow_matcher* ctx::create_flow_matcher(struct flow_desc* desc)
+{
+    UNUSED(desc);
+    // Match criteria are passed with every rule.
+    return nullptr;
+}
+
 int ctx::query_eqn(uint32_t cpu_num, uint32_t& eqn)
 {
     int ret = devx_query_eqn(m_handle, cpu_num, &eqn);
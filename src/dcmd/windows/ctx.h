@@ -50,9 +50,11 @@ public:
     void* get_context();
     int exec_cmd(const void* in, size_t inlen, void* out, size_t outlen);
     obj* create_obj(struct obj_desc* desc);
+    cmd_comp* create_cmd_comp();
     uar* create_uar(struct uar_desc* desc);
     umem* create_umem(struct umem_desc* desc);
     flow* create_flow(struct flow_desc* desc);
+    flow_matcher* create_flow_matcher(struct flow_desc* desc);
     int query_eqn(uint32_t cpu_num, uint32_t& eqn);
     int hca_iseg_mapping();
     uint64_t get_real_time();
@@ -66,6 +68,10 @@ public:
     {
         return WIN_IBV_ACCESS_LOCAL_WRITE;
     }
+    inline int ibv_get_relaxed_ordering_flags()
+    {
+        return 0;
+    }
 
 private:
     ctx_handle m_handle;
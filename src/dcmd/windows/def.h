@@ -207,6 +207,7 @@ typedef struct mlx5dv_devx_obj* cq_handle;
 typedef struct mlx5dv_devx_umem* umem_handle;
 typedef struct mlx5dv_devx_uar* uar_handle;
 typedef struct devx_obj_handle* flow_handle;
+typedef void* cmd_comp_handle;
 typedef devx_pp_handle pp_handle;
 
 inline uint32_t get_pp_index(pp_handle* pp)
@@ -247,6 +248,23 @@ struct mlx5_wqe_umr_repeat_block_seg {
     __be16 num_ent;
     struct mlx5_wqe_umr_repeat_ent_seg entries[0];
 };
+
+struct mlx5_wqe_data_seg {
+    __be32 byte_count;
+    __be32 lkey;
+    __be64 addr;
+};
+
+struct mlx5_wqe_srq_next_seg {
+    uint8_t rsvd0[2];
+    __be16 next_wqe_index;
+    uint8_t signature;
+    uint8_t rsvd1[11];
+};
+
+enum {
+    MLX5_INVALID_LKEY = 0x100,
+};
 #pragma warning(pop)
 
 inline void* aligned_alloc(size_t alignment, size_t size)
@@ -37,7 +37,8 @@ using namespace dcmd;
 
 flow::flow(ctx_handle handle, struct flow_desc* desc)
 {
-    if (!desc->num_dst_obj) {
+    // Root table rules are added to the NIC receive table only.
+    if (!desc->num_dst_obj || desc->table_type != MLX5_FLOW_TABLE_TYPE_NIC_RX) {
         throw DCMD_ENOTSUP;
     }
     size_t extra_dest_num = desc->num_dst_obj - 1; // the first is within devx_fs_rule_add_in
@@ -49,9 +50,7 @@ flow::flow(ctx_handle handle, struct flow_desc* desc)
     DEVX_SET(devx_fs_rule_add_in, in, prio, desc->priority);
     // FlowTag Id
     DEVX_SET(devx_fs_rule_add_in, in, flow_tag, desc->flow_id);
-    // Only outer header for now!!!
-    DEVX_SET(devx_fs_rule_add_in, in, match_criteria_enable,
-             1 << MLX5_CREATE_FLOW_GROUP_IN_MATCH_CRITERIA_ENABLE_OUTER_HEADERS);
+    DEVX_SET(devx_fs_rule_add_in, in, match_criteria_enable, desc->match_criteria_enable);
 
     // mask
     void* prm_mc = DEVX_ADDR_OF(devx_fs_rule_add_in, in, match_criteria);
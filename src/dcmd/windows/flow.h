@@ -39,6 +39,13 @@
 
 namespace dcmd {
 
+class flow_matcher {
+public:
+    virtual ~flow_matcher()
+    {
+    }
+};
+
 class flow : public base_flow {
 public:
     flow()
@@ -91,3 +91,37 @@ int obj::modify(struct obj_desc* desc)
         mlx5dv_devx_obj_modify(m_ctx_handle, (void*)desc->in, desc->inlen, desc->out, desc->outlen);
     return (ret ? DCMD_EIO : DCMD_EOK);
 }
+
+int obj::query_async(struct obj_desc* desc, uint64_t wr_id, cmd_comp* comp)
+{
+    UNUSED(desc);
+    UNUSED(wr_id);
+    UNUSED(comp);
+    return DCMD_ENOTSUP;
+}
+
+cmd_comp::cmd_comp(ctx_handle handle)
+    : m_handle(nullptr)
+    , m_resp()
+{
+    UNUSED(handle);
+    // Asynchronous DevX commands are not available in Windows DevX
+    throw DCMD_ENOTSUP;
+}
+
+cmd_comp::~cmd_comp()
+{
+}
+
+int cmd_comp::get_fd()
+{
+    return -1;
+}
+
+int cmd_comp::get_comp(uint64_t& wr_id, void* out, size_t outlen)
+{
+    UNUSED(wr_id);
+    UNUSED(out);
+    UNUSED(outlen);
+    return DCMD_ENOTSUP;
+}
@@ -32,10 +32,30 @@
 #ifndef SRC_DCMD_WINDOWS_OBJ_H_
 #define SRC_DCMD_WINDOWS_OBJ_H_
 
+#include <vector>
+
 #include "dcmd/base/base_obj.h"
 
 namespace dcmd {
 
+class cmd_comp {
+public:
+    cmd_comp(ctx_handle handle);
+    virtual ~cmd_comp();
+
+    int get_fd();
+    int get_comp(uint64_t& wr_id, void* out, size_t outlen);
+
+    cmd_comp_handle get_handle()
+    {
+        return m_handle;
+    }
+
+private:
+    cmd_comp_handle m_handle;
+    std::vector<uint8_t> m_resp;
+};
+
 class obj : public base_obj {
 public:
     obj()
@@ -49,6 +69,7 @@ public:
 
     int query(struct obj_desc* desc);
     int modify(struct obj_desc* desc);
+    int query_async(struct obj_desc* desc, uint64_t wr_id, cmd_comp* comp);
 
     uintptr_t get_handle()
     {
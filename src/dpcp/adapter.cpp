@@ -294,6 +294,36 @@ static void store_hca_ibq_caps(adapter_hca_capabilities* external_hca_caps,
               external_hca_caps->ibq_max_scatter_offset);
 }
 
+static void store_hca_hairpin_caps(adapter_hca_capabilities* external_hca_caps,
+                                   const caps_map_t& caps_map)
+{
+    auto general_cap = caps_map.find(MLX5_CAP_GENERAL);
+    if (general_cap == caps_map.end()) {
+        log_fatal("Incorrect caps_map object - couldn't find MLX5_CAP_GENERAL\n");
+        return;
+    }
+
+    external_hca_caps->hairpin =
+        DEVX_GET(query_hca_cap_out, general_cap->second, capability.cmd_hca_cap.hairpin);
+    external_hca_caps->log_max_hairpin_queues = DEVX_GET(
+        query_hca_cap_out, general_cap->second, capability.cmd_hca_cap.log_max_hairpin_queues);
+    external_hca_caps->log_max_hairpin_wq_data_sz = DEVX_GET(
+        query_hca_cap_out, general_cap->second, capability.cmd_hca_cap.log_max_hairpin_wq_data_sz);
+    external_hca_caps->log_min_hairpin_wq_data_sz = DEVX_GET(
+        query_hca_cap_out, general_cap->second, capability.cmd_hca_cap.log_min_hairpin_wq_data_sz);
+    external_hca_caps->log_max_hairpin_num_packets =
+        DEVX_GET(query_hca_cap_out, general_cap->second,
+                 capability.cmd_hca_cap.log_max_hairpin_num_packets);
+    external_hca_caps->vhca_id =
+        DEVX_GET(query_hca_cap_out, general_cap->second, capability.cmd_hca_cap.vhca_id);
+    log_trace("Capability - hairpin: %d log_max_hairpin_queues: %d log_hairpin_wq_data_sz: "
+              "[%d, %d] log_max_hairpin_num_packets: %d vhca_id: %d\n",
+              external_hca_caps->hairpin, external_hca_caps->log_max_hairpin_queues,
+              external_hca_caps->log_min_hairpin_wq_data_sz,
+              external_hca_caps->log_max_hairpin_wq_data_sz,
+              external_hca_caps->log_max_hairpin_num_packets, external_hca_caps->vhca_id);
+}
+
 static void store_hca_parse_graph_node_caps(adapter_hca_capabilities* external_hca_caps,
                                             const caps_map_t& caps_map)
 {
@@ -397,6 +427,10 @@ static void store_hca_2_reformat_caps(adapter_hca_capabilities* external_hca_cap
               "%d\n",
               external_hca_caps->flow_table_caps.receive
                   .is_flow_action_non_tunnel_reformat_and_fwd_to_flow_table);
+    external_hca_caps->flow_table_caps.transmit
+        .is_flow_action_non_tunnel_reformat_and_fwd_to_flow_table =
+        external_hca_caps->flow_table_caps.receive
+            .is_flow_action_non_tunnel_reformat_and_fwd_to_flow_table;
 }
 
 static void store_hca_flow_table_caps(adapter_hca_capabilities* external_hca_caps,
@@ -431,253 +465,270 @@ static void store_hca_flow_table_caps(adapter_hca_capabilities* external_hca_cap
               "flow_table_caps.reformat_flow_action_caps.max_log_num_of_packet_reformat: %d\n",
               external_hca_caps->flow_table_caps.reformat_flow_action_caps
                   .max_log_num_of_packet_reformat);
+
+    external_hca_caps->flow_table_caps.max_flow_counter =
+        (DEVX_GET(query_hca_cap_out, general_cap->second,
+                  capability.cmd_hca_cap.max_flow_counter_31_16)
+         << 16) |
+        DEVX_GET(query_hca_cap_out, general_cap->second,
+                 capability.cmd_hca_cap.max_flow_counter_15_0);
+    log_trace("Capability - flow_table_caps.max_flow_counter: %u\n",
+              external_hca_caps->flow_table_caps.max_flow_counter);
+
+    external_hca_caps->flow_table_caps.log_max_flow_counter_bulk = DEVX_GET(
+        query_hca_cap_out, general_cap->second, capability.cmd_hca_cap.log_max_flow_counter_bulk);
+    log_trace("Capability - flow_table_caps.log_max_flow_counter_bulk: %d\n",
+              external_hca_caps->flow_table_caps.log_max_flow_counter_bulk);
 }
 
-static void store_hca_flow_table_nic_receive_caps(adapter_hca_capabilities* external_hca_caps,
-                                                  const caps_map_t& caps_map)
+static void store_flow_table_fields_caps(flow_table_fields_capabilities& fields, void* support,
+                                         const std::string& name)
 {
-    auto flow_table_cap = caps_map.find(MLX5_CAP_FLOW_TABLE);
-    if (flow_table_cap == caps_map.end()) {
-        log_fatal("Incorrect caps_map object - couldn't find MLX5_CAP_FLOW_TABLE\n");
-        return;
-    }
-    auto general_cap = caps_map.find(MLX5_CAP_GENERAL);
-    if (general_cap == caps_map.end()) {
-        log_fatal("Incorrect caps_map object - couldn't find MLX5_CAP_GENERAL\n");
-        return;
-    }
+    fields.outer_ethertype = DEVX_GET(flow_table_fields_supported, support, outer_ether_type);
+    log_trace("Capability - %s.outer_ethertype: %d\n", name.c_str(), fields.outer_ethertype);
 
-    external_hca_caps->flow_table_caps.receive.is_flow_table_supported =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.ft_support);
-    log_trace("Capability - flow_table_caps.receive.is_flow_table_supported: %d\n",
-              external_hca_caps->flow_table_caps.receive.is_flow_table_supported);
+    fields.outer_udp_dport = DEVX_GET(flow_table_fields_supported, support, outer_udp_dport);
+    log_trace("Capability - %s.outer_udp_dport: %d\n", name.c_str(), fields.outer_udp_dport);
 
-    external_hca_caps->flow_table_caps.receive.is_flow_action_tag_supported =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.flow_tag);
-    log_trace("Capability - flow_table_caps.receive.is_flow_action_tag_supported: %d\n",
-              external_hca_caps->flow_table_caps.receive.is_flow_action_tag_supported);
+    fields.prog_sample_field = DEVX_GET(flow_table_fields_supported, support, prog_sample_field);
+    log_trace("Capability - %s.prog_sample_field: %d\n", name.c_str(), fields.prog_sample_field);
 
-    external_hca_caps->flow_table_caps.receive.is_flow_action_modify_supported =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.flow_modify_en);
-    log_trace("Capability - flow_table_caps.receive.is_flow_action_modify_supported: %d\n",
-              external_hca_caps->flow_table_caps.receive.is_flow_action_modify_supported);
+    fields.metadata_reg_c_0 = DEVX_GET(flow_table_fields_supported, support, metadata_reg_c_0);
+    log_trace("Capability - %s.metadata_reg_c_0: %d\n", name.c_str(), fields.metadata_reg_c_0);
 
-    external_hca_caps->flow_table_caps.receive.is_flow_action_reformat_supported =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.reformat);
-    log_trace("Capability - flow_table_caps.receive.is_flow_action_reformat_supported: %d\n",
-              external_hca_caps->flow_table_caps.receive.is_flow_action_reformat_supported);
+    fields.metadata_reg_c_1 = DEVX_GET(flow_table_fields_supported, support, metadata_reg_c_1);
+    log_trace("Capability - %s.metadata_reg_c_1: %d\n", name.c_str(), fields.metadata_reg_c_1);
 
-    external_hca_caps->flow_table_caps.receive
-        .is_flow_action_reformat_and_modify_supported = DEVX_GET(
-        query_hca_cap_out, flow_table_cap->second,
-        capability.flow_table_nic_cap.flow_table_properties_nic_receive.reformat_and_modify_action);
-    log_trace(
-        "Capability - flow_table_caps.receive.is_flow_action_reformat_and_modify_supported: %d\n",
-        external_hca_caps->flow_table_caps.receive.is_flow_action_reformat_and_modify_supported);
+    fields.metadata_reg_c_2 = DEVX_GET(flow_table_fields_supported, support, metadata_reg_c_2);
+    log_trace("Capability - %s.metadata_reg_c_2: %d\n", name.c_str(), fields.metadata_reg_c_2);
 
-    external_hca_caps->flow_table_caps.receive
-        .is_flow_action_reformat_and_fwd_to_flow_table = DEVX_GET(
-        query_hca_cap_out, flow_table_cap->second,
-        capability.flow_table_nic_cap.flow_table_properties_nic_receive.reformat_and_fwd_to_table);
-    log_trace(
-        "Capability - flow_table_caps.receive.is_flow_action_reformat_and_fwd_to_flow_table: %d\n",
-        external_hca_caps->flow_table_caps.receive.is_flow_action_reformat_and_fwd_to_flow_table);
+    fields.metadata_reg_c_3 = DEVX_GET(flow_table_fields_supported, support, metadata_reg_c_3);
+    log_trace("Capability - %s.metadata_reg_c_3: %d\n", name.c_str(), fields.metadata_reg_c_3);
 
-    external_hca_caps->flow_table_caps.receive.max_log_size_flow_table =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.log_max_ft_size);
-    log_trace("Capability - flow_table_caps.receive.max_log_size_flow_table: %d\n",
-              external_hca_caps->flow_table_caps.receive.max_log_size_flow_table);
+    fields.metadata_reg_c_4 = DEVX_GET(flow_table_fields_supported, support, metadata_reg_c_4);
+    log_trace("Capability - %s.metadata_reg_c_4: %d\n", name.c_str(), fields.metadata_reg_c_4);
 
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.max_obj_log_num =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive
-                     .log_max_modify_header_context);
-    log_trace("Capability - flow_table_caps.receive.modify_flow_action_caps.max_obj_log_num: %d\n",
-              external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.max_obj_log_num);
+    fields.metadata_reg_c_5 = DEVX_GET(flow_table_fields_supported, support, metadata_reg_c_5);
+    log_trace("Capability - %s.metadata_reg_c_5: %d\n", name.c_str(), fields.metadata_reg_c_5);
 
-    external_hca_caps->flow_table_caps.receive.ft_field_support.outer_udp_dport =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.ft_field_support
-                     .outer_udp_dport);
-    log_trace("Capability - "
-              "flow_table_caps.receive.ft_field_support.outer_udp_dport: %d\n",
-              external_hca_caps->flow_table_caps.receive.ft_field_support.outer_udp_dport);
+    fields.metadata_reg_c_6 = DEVX_GET(flow_table_fields_supported, support, metadata_reg_c_6);
+    log_trace("Capability - %s.metadata_reg_c_6: %d\n", name.c_str(), fields.metadata_reg_c_6);
 
-    external_hca_caps->flow_table_caps.receive.ft_field_support.prog_sample_field =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.ft_field_support
-                     .prog_sample_field);
-    log_trace("Capability - "
-              "flow_table_caps.receive.ft_field_support.prog_sample_field: %d\n",
-              external_hca_caps->flow_table_caps.receive.ft_field_support.prog_sample_field);
+    fields.metadata_reg_c_7 = DEVX_GET(flow_table_fields_supported, support, metadata_reg_c_7);
+    log_trace("Capability - %s.metadata_reg_c_7: %d\n", name.c_str(), fields.metadata_reg_c_7);
 
-    external_hca_caps->flow_table_caps.receive.ft_field_support.metadata_reg_c_0 =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.ft_field_support
-                     .metadata_reg_c_0);
-    log_trace("Capability - "
-              "flow_table_caps.receive.ft_field_support.metadata_reg_c_0: %d\n",
-              external_hca_caps->flow_table_caps.receive.ft_field_support.metadata_reg_c_0);
+    fields.outer_ipv4_ttl = DEVX_GET(flow_table_fields_supported, support, outer_ipv4_ttl);
+    log_trace("Capability - %s.outer_ipv4_ttl: %d\n", name.c_str(), fields.outer_ipv4_ttl);
 
-    external_hca_caps->flow_table_caps.receive.ft_field_support.metadata_reg_c_1 =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.ft_field_support
-                     .metadata_reg_c_1);
-    log_trace("Capability - "
-              "flow_table_caps.receive.ft_field_support.metadata_reg_c_1: %d\n",
-              external_hca_caps->flow_table_caps.receive.ft_field_support.metadata_reg_c_1);
+    fields.outer_second_vid = DEVX_GET(flow_table_fields_supported, support, outer_second_vid);
+    log_trace("Capability - %s.outer_second_vid: %d\n", name.c_str(), fields.outer_second_vid);
 
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps
-        .max_obj_in_flow_rule = DEVX_GET(
-        query_hca_cap_out, flow_table_cap->second,
-        capability.flow_table_nic_cap.flow_table_properties_nic_receive.max_modify_header_actions);
-    log_trace(
-        "Capability - flow_table_caps.receive.modify_flow_action_caps.max_obj_in_flow_rule: %d\n",
-        external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.max_obj_in_flow_rule);
+    fields.outer_frag = DEVX_GET(flow_table_fields_supported, support, outer_frag);
+    log_trace("Capability - %s.outer_frag: %d\n", name.c_str(), fields.outer_frag);
 
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps
-        .log_max_num_header_modify_argument =
-        DEVX_GET(query_hca_cap_out, general_cap->second,
-                 capability.cmd_hca_cap.log_max_num_header_modify_argument);
-    log_trace(
-        "Capability - "
-        "flow_table_caps.receive.modify_flow_action_caps.log_max_num_header_modify_argument: %d\n",
-        external_hca_caps->flow_table_caps.receive.modify_flow_action_caps
-            .log_max_num_header_modify_argument);
+    fields.outer_ip_ecn = DEVX_GET(flow_table_fields_supported, support, outer_ip_ecn);
+    log_trace("Capability - %s.outer_ip_ecn: %d\n", name.c_str(), fields.outer_ip_ecn);
 
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps
-        .log_header_modify_argument_granularity =
-        DEVX_GET(query_hca_cap_out, general_cap->second,
-                 capability.cmd_hca_cap.log_header_modify_argument_granularity);
-    log_trace("Capability - "
-              "flow_table_caps.receive.modify_flow_action_caps.log_header_modify_argument_"
-              "granularity: %d\n",
-              external_hca_caps->flow_table_caps.receive.modify_flow_action_caps
-                  .log_header_modify_argument_granularity);
+    fields.outer_ip_dscp = DEVX_GET(flow_table_fields_supported, support, outer_ip_dscp);
+    log_trace("Capability - %s.outer_ip_dscp: %d\n", name.c_str(), fields.outer_ip_dscp);
 
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps
-        .log_header_modify_argument_max_alloc =
-        DEVX_GET(query_hca_cap_out, general_cap->second,
-                 capability.cmd_hca_cap.log_header_modify_argument_max_alloc);
-    log_trace("Capability - "
-              "flow_table_caps.receive.modify_flow_action_caps.log_header_modify_argument_max_"
-              "alloc: %d\n",
-              external_hca_caps->flow_table_caps.receive.modify_flow_action_caps
-                  .log_header_modify_argument_max_alloc);
+    fields.outer_tcp_flags = DEVX_GET(flow_table_fields_supported, support, outer_tcp_flags);
+    log_trace("Capability - %s.outer_tcp_flags: %d\n", name.c_str(), fields.outer_tcp_flags);
 
-    external_hca_caps->flow_table_caps.receive.max_flow_table_level =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.max_ft_level);
-    log_trace("Capability - flow_table_caps.receive.max_flow_table_level: %d\n",
-              external_hca_caps->flow_table_caps.receive.max_flow_table_level);
+    fields.inner_ipv4_ttl = DEVX_GET(flow_table_fields_supported, support, inner_ipv4_ttl);
+    log_trace("Capability - %s.inner_ipv4_ttl: %d\n", name.c_str(), fields.inner_ipv4_ttl);
 
-    external_hca_caps->flow_table_caps.receive.is_flow_action_reformat_from_type_insert_supported =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.reformat_insert);
-    log_trace("Capability - "
-              "flow_table_caps.receive.is_flow_action_reformat_from_type_insert_supported: %d\n",
-              external_hca_caps->flow_table_caps.receive
-                  .is_flow_action_reformat_from_type_insert_supported);
+    fields.inner_second_vid = DEVX_GET(flow_table_fields_supported, support, inner_second_vid);
+    log_trace("Capability - %s.inner_second_vid: %d\n", name.c_str(), fields.inner_second_vid);
 
-    external_hca_caps->flow_table_caps.receive.max_log_num_of_flow_table =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.log_max_ft_num);
-    log_trace("Capability - flow_table_caps.receive.max_log_num_of_flow_table: %d\n",
-              external_hca_caps->flow_table_caps.receive.max_log_num_of_flow_table);
+    fields.inner_frag = DEVX_GET(flow_table_fields_supported, support, inner_frag);
+    log_trace("Capability - %s.inner_frag: %d\n", name.c_str(), fields.inner_frag);
 
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.max_obj_log_num =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive
-                     .log_max_modify_header_context);
-    log_trace("Capability - flow_table_caps.receive.modify_flow_action_caps.max_obj_log_num: %d\n",
-              external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.max_obj_log_num);
+    fields.inner_ip_ecn = DEVX_GET(flow_table_fields_supported, support, inner_ip_ecn);
+    log_trace("Capability - %s.inner_ip_ecn: %d\n", name.c_str(), fields.inner_ip_ecn);
 
-    external_hca_caps->flow_table_caps.receive.max_log_num_of_flow_rule =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.log_max_flow);
-    log_trace("Capability - flow_table_caps.receive.max_log_num_of_flow_rule: %d\n",
-              external_hca_caps->flow_table_caps.receive.max_log_num_of_flow_rule);
+    fields.inner_ip_dscp = DEVX_GET(flow_table_fields_supported, support, inner_ip_dscp);
+    log_trace("Capability - %s.inner_ip_dscp: %d\n", name.c_str(), fields.inner_ip_dscp);
 
-    external_hca_caps->flow_table_caps.receive.is_flow_action_reparse_supported =
-        DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.reparse);
-    log_trace("Capability - flow_table_caps.receive.is_flow_action_reparse_supported: %d\n",
-              external_hca_caps->flow_table_caps.receive.is_flow_action_reparse_supported);
-
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.set_fields_support
-        .outer_ethertype = DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                                    capability.flow_table_nic_cap.header_modify_nic_receive
-                                        .set_action_field_support.outer_ether_type);
-    log_trace(
-        "Capability - "
-        "flow_table_caps.receive.modify_flow_action_caps.set_fields_support.outer_ethertype: %d\n",
-        external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.set_fields_support
-            .outer_ethertype);
-
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.set_fields_support
-        .outer_udp_dport = DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                                    capability.flow_table_nic_cap.header_modify_nic_receive
-                                        .set_action_field_support.outer_udp_dport);
-    log_trace(
-        "Capability - "
-        "flow_table_caps.receive.modify_flow_action_caps.set_fields_support.outer_udp_dport: %d\n",
-        external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.set_fields_support
-            .outer_udp_dport);
-
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.set_fields_support
-        .metadata_reg_c_0 = DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                                     capability.flow_table_nic_cap.header_modify_nic_receive
-                                         .set_action_field_support.metadata_reg_c_0);
-    log_trace(
-        "Capability - "
-        "flow_table_caps.receive.modify_flow_action_caps.set_fields_support.metadata_reg_c_0: %d\n",
-        external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.set_fields_support
-            .metadata_reg_c_0);
-
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.set_fields_support
-        .metadata_reg_c_1 = DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                                     capability.flow_table_nic_cap.header_modify_nic_receive
-                                         .set_action_field_support.metadata_reg_c_1);
-    log_trace(
-        "Capability - "
-        "flow_table_caps.receive.modify_flow_action_caps.set_fields_support.metadata_reg_c_1: %d\n",
-        external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.set_fields_support
-            .metadata_reg_c_1);
-
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.copy_fields_support
-        .outer_udp_dport = DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                                    capability.flow_table_nic_cap.header_modify_nic_receive
-                                        .copy_action_field_support.outer_udp_dport);
-    log_trace(
-        "Capability - "
-        "flow_table_caps.receive.modify_flow_action_caps.copy_fields_support.outer_udp_dport: %d\n",
-        external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.copy_fields_support
-            .outer_udp_dport);
-
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.copy_fields_support
-        .metadata_reg_c_0 = DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                                     capability.flow_table_nic_cap.header_modify_nic_receive
-                                         .copy_action_field_support.metadata_reg_c_0);
-    log_trace("Capability - "
-              "flow_table_caps.receive.modify_flow_action_caps.copy_fields_support.metadata_reg_c_"
-              "0: %d\n",
-              external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.copy_fields_support
-                  .metadata_reg_c_0);
-
-    external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.copy_fields_support
-        .metadata_reg_c_1 = DEVX_GET(query_hca_cap_out, flow_table_cap->second,
-                                     capability.flow_table_nic_cap.header_modify_nic_receive
-                                         .copy_action_field_support.metadata_reg_c_1);
-    log_trace("Capability - "
-              "flow_table_caps.receive.modify_flow_action_caps.copy_fields_support.metadata_reg_c_"
-              "1: %d\n",
-              external_hca_caps->flow_table_caps.receive.modify_flow_action_caps.copy_fields_support
-                  .metadata_reg_c_1);
+    fields.inner_tcp_flags = DEVX_GET(flow_table_fields_supported, support, inner_tcp_flags);
+    log_trace("Capability - %s.inner_tcp_flags: %d\n", name.c_str(), fields.inner_tcp_flags);
+}
+
+static void store_flow_table_type_caps(flow_table_type_capabilities& caps, void* props,
+                                       void* header_modify, void* hca_cap,
+                                       const std::string& name)
+{
+    caps.is_flow_table_supported = DEVX_GET(flow_table_prop_layout, props, ft_support);
+    log_trace("Capability - %s.is_flow_table_supported: %d\n", name.c_str(),
+              caps.is_flow_table_supported);
+
+    caps.is_flow_action_tag_supported = DEVX_GET(flow_table_prop_layout, props, flow_tag);
+    log_trace("Capability - %s.is_flow_action_tag_supported: %d\n", name.c_str(),
+              caps.is_flow_action_tag_supported);
+
+    caps.is_flow_action_modify_supported = DEVX_GET(flow_table_prop_layout, props, flow_modify_en);
+    log_trace("Capability - %s.is_flow_action_modify_supported: %d\n", name.c_str(),
+              caps.is_flow_action_modify_supported);
+
+    caps.is_flow_action_reformat_supported = DEVX_GET(flow_table_prop_layout, props, reformat);
+    log_trace("Capability - %s.is_flow_action_reformat_supported: %d\n", name.c_str(),
+              caps.is_flow_action_reformat_supported);
+
+    caps.is_flow_action_reformat_from_type_insert_supported =
+        DEVX_GET(flow_table_prop_layout, props, reformat_insert);
+    log_trace("Capability - %s."
+              "is_flow_action_reformat_from_type_insert_supported: %d\n",
+              name.c_str(), caps.is_flow_action_reformat_from_type_insert_supported);
+
+    caps.is_flow_action_reformat_and_modify_supported =
+        DEVX_GET(flow_table_prop_layout, props, reformat_and_modify_action);
+    log_trace("Capability - %s.is_flow_action_reformat_and_modify_supported: %d\n", name.c_str(),
+              caps.is_flow_action_reformat_and_modify_supported);
+
+    caps.is_flow_action_reformat_and_fwd_to_flow_table =
+        DEVX_GET(flow_table_prop_layout, props, reformat_and_fwd_to_table);
+    log_trace("Capability - %s.is_flow_action_reformat_and_fwd_to_flow_table: %d\n", name.c_str(),
+              caps.is_flow_action_reformat_and_fwd_to_flow_table);
+
+    caps.is_flow_action_reparse_supported = DEVX_GET(flow_table_prop_layout, props, reparse);
+    log_trace("Capability - %s.is_flow_action_reparse_supported: %d\n", name.c_str(),
+              caps.is_flow_action_reparse_supported);
+
+    caps.is_flow_action_counter_supported = DEVX_GET(flow_table_prop_layout, props, flow_counter);
+    log_trace("Capability - %s.is_flow_action_counter_supported: %d\n", name.c_str(),
+              caps.is_flow_action_counter_supported);
+
+    caps.max_log_size_flow_table = DEVX_GET(flow_table_prop_layout, props, log_max_ft_size);
+    log_trace("Capability - %s.max_log_size_flow_table: %d\n", name.c_str(),
+              caps.max_log_size_flow_table);
+
+    caps.max_flow_table_level = DEVX_GET(flow_table_prop_layout, props, max_ft_level);
+    log_trace("Capability - %s.max_flow_table_level: %d\n", name.c_str(),
+              caps.max_flow_table_level);
+
+    caps.max_log_num_of_flow_table = DEVX_GET(flow_table_prop_layout, props, log_max_ft_num);
+    log_trace("Capability - %s.max_log_num_of_flow_table: %d\n", name.c_str(),
+              caps.max_log_num_of_flow_table);
+
+    caps.max_log_num_of_flow_rule = DEVX_GET(flow_table_prop_layout, props, log_max_flow);
+    log_trace("Capability - %s.max_log_num_of_flow_rule: %d\n", name.c_str(),
+              caps.max_log_num_of_flow_rule);
+
+    store_flow_table_fields_caps(caps.ft_field_support,
+                                 DEVX_ADDR_OF(flow_table_prop_layout, props, ft_field_support),
+                                 name + ".ft_field_support");
+
+    modify_flow_action_capabilities& modify = caps.modify_flow_action_caps;
+    modify.max_obj_log_num = DEVX_GET(flow_table_prop_layout, props, log_max_modify_header_context);
+    log_trace("Capability - %s.modify_flow_action_caps.max_obj_log_num: %d\n", name.c_str(),
+              modify.max_obj_log_num);
+
+    modify.max_obj_in_flow_rule =
+        DEVX_GET(flow_table_prop_layout, props, max_modify_header_actions);
+    log_trace("Capability - %s.modify_flow_action_caps.max_obj_in_flow_rule: %u\n", name.c_str(),
+              modify.max_obj_in_flow_rule);
+
+    modify.log_max_num_header_modify_argument =
+        DEVX_GET(cmd_hca_cap, hca_cap, log_max_num_header_modify_argument);
+    log_trace("Capability - %s.modify_flow_action_caps."
+              "log_max_num_header_modify_argument: %d\n",
+              name.c_str(), modify.log_max_num_header_modify_argument);
+
+    modify.log_header_modify_argument_granularity =
+        DEVX_GET(cmd_hca_cap, hca_cap, log_header_modify_argument_granularity);
+    log_trace("Capability - %s.modify_flow_action_caps."
+              "log_header_modify_argument_granularity: %d\n",
+              name.c_str(), modify.log_header_modify_argument_granularity);
+
+    modify.log_header_modify_argument_max_alloc =
+        DEVX_GET(cmd_hca_cap, hca_cap, log_header_modify_argument_max_alloc);
+    log_trace("Capability - %s.modify_flow_action_caps."
+              "log_header_modify_argument_max_alloc: %d\n",
+              name.c_str(), modify.log_header_modify_argument_max_alloc);
+
+    store_flow_table_fields_caps(
+        modify.set_fields_support,
+        DEVX_ADDR_OF(header_modify_cap_properties, header_modify, set_action_field_support),
+        name + ".modify_flow_action_caps.set_fields_support");
+    store_flow_table_fields_caps(
+        modify.copy_fields_support,
+        DEVX_ADDR_OF(header_modify_cap_properties, header_modify, copy_action_field_support),
+        name + ".modify_flow_action_caps.copy_fields_support");
+}
+
+static void store_hca_flow_table_nic_receive_caps(adapter_hca_capabilities* external_hca_caps,
+                                                  const caps_map_t& caps_map)
+{
+    auto flow_table_cap = caps_map.find(MLX5_CAP_FLOW_TABLE);
+    if (flow_table_cap == caps_map.end()) {
+        log_fatal("Incorrect caps_map object - couldn't find MLX5_CAP_FLOW_TABLE\n");
+        return;
+    }
+    auto general_cap = caps_map.find(MLX5_CAP_GENERAL);
+    if (general_cap == caps_map.end()) {
+        log_fatal("Incorrect caps_map object - couldn't find MLX5_CAP_GENERAL\n");
+        return;
+    }
+
+    void* nic_cap =
+        DEVX_ADDR_OF(query_hca_cap_out, flow_table_cap->second, capability.flow_table_nic_cap);
+    void* props = DEVX_ADDR_OF(flow_table_nic_cap, nic_cap, flow_table_properties_nic_receive);
+    void* header_modify = DEVX_ADDR_OF(flow_table_nic_cap, nic_cap, header_modify_nic_receive);
+    void* hca_cap = DEVX_ADDR_OF(query_hca_cap_out, general_cap->second, capability.cmd_hca_cap);
+    flow_table_type_capabilities& receive = external_hca_caps->flow_table_caps.receive;
+    store_flow_table_type_caps(receive, props, header_modify, hca_cap, "flow_table_caps.receive");
+
+    // reg_a and reg_b have no support bits, the PRM binds them to the table type.
+    // reg_b passes receive metadata to the CQE and can only be written on receive.
+    modify_flow_action_capabilities& modify = receive.modify_flow_action_caps;
+    receive.ft_field_support.metadata_reg_a = false;
+    receive.ft_field_support.metadata_reg_b = false;
+    modify.set_fields_support.metadata_reg_a = false;
+    modify.set_fields_support.metadata_reg_b = receive.is_flow_table_supported;
+    modify.copy_fields_support.metadata_reg_a = false;
+    modify.copy_fields_support.metadata_reg_b = receive.is_flow_table_supported;
+    log_trace("Capability - flow_table_caps.receive metadata_reg_a: match %d set %d copy %d "
+              "metadata_reg_b: match %d set %d copy %d\n",
+              receive.ft_field_support.metadata_reg_a, modify.set_fields_support.metadata_reg_a,
+              modify.copy_fields_support.metadata_reg_a, receive.ft_field_support.metadata_reg_b,
+              modify.set_fields_support.metadata_reg_b, modify.copy_fields_support.metadata_reg_b);
+}
+
+static void store_hca_flow_table_nic_transmit_caps(adapter_hca_capabilities* external_hca_caps,
+                                                   const caps_map_t& caps_map)
+{
+    auto flow_table_cap = caps_map.find(MLX5_CAP_FLOW_TABLE);
+    if (flow_table_cap == caps_map.end()) {
+        log_fatal("Incorrect caps_map object - couldn't find MLX5_CAP_FLOW_TABLE\n");
+        return;
+    }
+    auto general_cap = caps_map.find(MLX5_CAP_GENERAL);
+    if (general_cap == caps_map.end()) {
+        log_fatal("Incorrect caps_map object - couldn't find MLX5_CAP_GENERAL\n");
+        return;
+    }
+
+    void* nic_cap =
+        DEVX_ADDR_OF(query_hca_cap_out, flow_table_cap->second, capability.flow_table_nic_cap);
+    void* props = DEVX_ADDR_OF(flow_table_nic_cap, nic_cap, flow_table_properties_nic_transmit);
+    void* header_modify = DEVX_ADDR_OF(flow_table_nic_cap, nic_cap, header_modify_nic_transmit);
+    void* hca_cap = DEVX_ADDR_OF(query_hca_cap_out, general_cap->second, capability.cmd_hca_cap);
+    flow_table_type_capabilities& transmit = external_hca_caps->flow_table_caps.transmit;
+    store_flow_table_type_caps(transmit, props, header_modify, hca_cap, "flow_table_caps.transmit");
+
+    // reg_a carries transmit metadata, it can be matched and written on transmit only.
+    modify_flow_action_capabilities& modify = transmit.modify_flow_action_caps;
+    transmit.ft_field_support.metadata_reg_a = transmit.is_flow_table_supported;
+    transmit.ft_field_support.metadata_reg_b = false;
+    modify.set_fields_support.metadata_reg_a = transmit.is_flow_table_supported;
+    modify.set_fields_support.metadata_reg_b = false;
+    modify.copy_fields_support.metadata_reg_a = transmit.is_flow_table_supported;
+    modify.copy_fields_support.metadata_reg_b = false;
+    log_trace("Capability - flow_table_caps.transmit metadata_reg_a: match %d set %d copy %d "
+              "metadata_reg_b: match %d set %d copy %d\n",
+              transmit.ft_field_support.metadata_reg_a, modify.set_fields_support.metadata_reg_a,
+              modify.copy_fields_support.metadata_reg_a, transmit.ft_field_support.metadata_reg_b,
+              modify.set_fields_support.metadata_reg_b, modify.copy_fields_support.metadata_reg_b);
 }
 
 static void store_hca_crypto_caps(adapter_hca_capabilities* external_hca_caps,
@@ -744,6 +795,39 @@ static void store_hca_nvmeotcp_caps(adapter_hca_capabilities* external_hca_caps,
     }
 }
 
+static void store_hca_relaxed_ordering_caps(adapter_hca_capabilities* external_hca_caps,
+                                            const caps_map_t& caps_map)
+{
+    auto general_cap = caps_map.find(MLX5_CAP_GENERAL);
+    if (general_cap == caps_map.end()) {
+        log_fatal("Incorrect caps_map object - couldn't find MLX5_CAP_GENERAL\n");
+        return;
+    }
+
+    external_hca_caps->relaxed_ordering_write = DEVX_GET(
+        query_hca_cap_out, general_cap->second, capability.cmd_hca_cap.relaxed_ordering_write);
+    external_hca_caps->relaxed_ordering_read =
+        DEVX_GET(query_hca_cap_out, general_cap->second,
+                 capability.cmd_hca_cap.relaxed_ordering_read_pci_enabled);
+    log_trace("Capability - relaxed_ordering_write: %d relaxed_ordering_read: %d\n",
+              external_hca_caps->relaxed_ordering_write,
+              external_hca_caps->relaxed_ordering_read);
+}
+
+static void store_hca_rqt_caps(adapter_hca_capabilities* external_hca_caps,
+                               const caps_map_t& caps_map)
+{
+    auto general_cap = caps_map.find(MLX5_CAP_GENERAL);
+    if (general_cap == caps_map.end()) {
+        log_fatal("Incorrect caps_map object - couldn't find MLX5_CAP_GENERAL\n");
+        return;
+    }
+
+    external_hca_caps->log_max_rqt_size =
+        DEVX_GET(query_hca_cap_out, general_cap->second, capability.cmd_hca_cap.log_max_rqt_size);
+    log_trace("Capability - log_max_rqt_size: %d\n", external_hca_caps->log_max_rqt_size);
+}
+
 static const std::vector<cap_cb_fn> caps_callbacks = {
     store_hca_device_frequency_khz_caps,
     store_hca_tls_caps,
@@ -755,12 +839,16 @@ static const std::vector<cap_cb_fn> caps_callbacks = {
     store_hca_rq_ts_format_caps,
     store_hca_lro_caps,
     store_hca_ibq_caps,
+    store_hca_hairpin_caps,
     store_hca_parse_graph_node_caps,
     store_hca_2_reformat_caps,
     store_hca_flow_table_caps,
     store_hca_flow_table_nic_receive_caps,
+    store_hca_flow_table_nic_transmit_caps,
     store_hca_crypto_caps,
     store_hca_nvmeotcp_caps,
+    store_hca_relaxed_ordering_caps,
+    store_hca_rqt_caps,
 };
 
 status pd_devx::create()
@@ -822,6 +910,7 @@ adapter::adapter(dcmd::device* dev, dcmd::ctx* ctx)
     , m_td(nullptr)
     , m_pd(nullptr)
     , m_uarpool(nullptr)
+    , m_cmd_queue(nullptr)
     , m_ibv_pd(nullptr)
     , m_pd_id(0)
     , m_td_id(0)
@@ -831,6 +920,7 @@ adapter::adapter(dcmd::device* dev, dcmd::ctx* ctx)
     , m_external_hca_caps(nullptr)
     , m_caps_callbacks(caps_callbacks)
     , m_opened(false)
+    , m_queue_relaxed_ordering(false)
     , m_flow_action_generator(m_dcmd_ctx, m_external_hca_caps)
 {
     for (auto cap_type : s_supported_cap_types) {
@@ -1003,6 +1093,29 @@ status adapter::create_tir(const tir::attr& tir_attr, tir*& tir_obj)
     return DPCP_OK;
 }
 
+status adapter::create_rqt(const rqt::attr& rqt_attr, rqt*& rqt_obj)
+{
+    status ret = DPCP_OK;
+    rqt* _rqt_obj = nullptr;
+
+    uint32_t size_limit =
+        m_is_caps_available ? (1U << m_external_hca_caps->log_max_rqt_size) : 0;
+    _rqt_obj = new (std::nothrow) rqt(get_ctx(), size_limit);
+    if (nullptr == _rqt_obj) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+
+    ret = _rqt_obj->create(rqt_attr);
+    if (DPCP_OK != ret) {
+        delete _rqt_obj;
+        return (DPCP_ERR_INVALID_PARAM == ret || DPCP_ERR_OUT_OF_RANGE == ret) ? ret
+                                                                               : DPCP_ERR_CREATE;
+    }
+    rqt_obj = _rqt_obj;
+
+    return DPCP_OK;
+}
+
 status adapter::create_tis(const tis::attr& tis_attr, tis*& tis_obj)
 {
     status ret = DPCP_OK;
@@ -1023,9 +1136,38 @@ status adapter::create_tis(const tis::attr& tis_attr, tis*& tis_obj)
     return DPCP_OK;
 }
 
+mkey_flags adapter::get_supported_mkey_flags(mkey_flags flags) const
+{
+    uint32_t supported = flags;
+    bool ro_write = m_is_caps_available && m_external_hca_caps->relaxed_ordering_write;
+    bool ro_read = m_is_caps_available && m_external_hca_caps->relaxed_ordering_read;
+
+    if ((flags & MKEY_RELAXED_ORDERING_WRITE) && !ro_write) {
+        supported &= ~MKEY_RELAXED_ORDERING_WRITE;
+    }
+    if ((flags & MKEY_RELAXED_ORDERING_READ) && !ro_read) {
+        supported &= ~MKEY_RELAXED_ORDERING_READ;
+    }
+    if (supported != (uint32_t)flags) {
+        log_trace("mkey flags 0x%x are reduced to 0x%x by HCA caps\n", flags, supported);
+    }
+    return (mkey_flags)supported;
+}
+
+status adapter::set_queue_relaxed_ordering(bool enable)
+{
+    if (enable && (MKEY_NONE == get_supported_mkey_flags(MKEY_RELAXED_ORDERING))) {
+        log_warn("Relaxed ordering is not supported by HCA\n");
+        return DPCP_ERR_NO_SUPPORT;
+    }
+    m_queue_relaxed_ordering = enable;
+    return DPCP_OK;
+}
+
 status adapter::create_direct_mkey(void* address, size_t length, mkey_flags flags,
                                    direct_mkey*& dmk)
 {
+    flags = get_supported_mkey_flags(flags);
     dmk = new (std::nothrow) direct_mkey(this, address, length, flags);
     log_trace("dmk: %p\n", dmk);
     if (nullptr == dmk) {
@@ -1050,6 +1192,7 @@ status adapter::create_direct_mkey(void* address, size_t length, mkey_flags flag
 status adapter::create_pattern_mkey(void* addr, mkey_flags flags, size_t stride_num, size_t bb_num,
                                     pattern_mkey_bb bb_arr[], pattern_mkey*& pmk)
 {
+    flags = get_supported_mkey_flags(flags);
     pmk = new (std::nothrow) pattern_mkey(this, addr, flags, stride_num, bb_num, bb_arr);
     log_trace("pattern mkey: %p\n", pmk);
     if (nullptr == pmk) {
@@ -1066,7 +1209,119 @@ status adapter::create_pattern_mkey(void* addr, mkey_flags flags, size_t stride_
     return DPCP_OK;
 }
 
-status reg_mem(dcmd::ctx* ctx, void* buf, size_t sz, dcmd::umem*& umem, uint32_t& mem_id)
+status adapter::create_chunked_mkey(void* address, size_t length, mkey_flags flags,
+                                    const chunked_mkey_attr& attr, chunked_mkey*& cmk)
+{
+    flags = get_supported_mkey_flags(flags);
+    cmk = new (std::nothrow) chunked_mkey(this, address, length, flags, attr);
+    log_trace("chunked mkey: %p\n", cmk);
+    if (nullptr == cmk) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    // Register chunks in parallel
+    status ret = cmk->reg_mem(m_ibv_pd);
+    if (DPCP_OK != ret) {
+        delete cmk;
+        return DPCP_ERR_UMEM;
+    }
+    // Create indirect MKey over chunks
+    ret = cmk->create();
+    if (DPCP_OK != ret) {
+        delete cmk;
+        return DPCP_ERR_CREATE;
+    }
+
+    return DPCP_OK;
+}
+
+status adapter::create_buffer_pool(const buffer_pool_attr& attr, buffer_pool*& pool)
+{
+    if (0 == attr.buf_sz || 0 == attr.slab_bufs_num) {
+        log_error("Buffer pool buf_sz %zd and slab_bufs_num %u must be set\n", attr.buf_sz,
+                  attr.slab_bufs_num);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    pool = new (std::nothrow) buffer_pool(this, attr);
+    log_trace("buffer pool: %p\n", pool);
+    if (nullptr == pool || nullptr == pool->m_global ||
+        (attr.cache_sz && nullptr == pool->m_caches)) {
+        delete pool;
+        return DPCP_ERR_NO_MEMORY;
+    }
+    // Register the first slab
+    status ret = pool->add_slab();
+    if (DPCP_OK != ret) {
+        delete pool;
+        return DPCP_ERR_UMEM;
+    }
+
+    return DPCP_OK;
+}
+
+status adapter::create_cmd_batch(uint32_t depth, cmd_batch*& batch)
+{
+    if (0 == depth) {
+        log_error("Command batch depth must be set\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    if (nullptr == m_cmd_queue) {
+        // Allocate worker pool shared by command batches
+        m_cmd_queue = new (std::nothrow) cmd_queue();
+        if (nullptr == m_cmd_queue) {
+            return DPCP_ERR_NO_MEMORY;
+        }
+    }
+    batch = new (std::nothrow) cmd_batch(this, m_cmd_queue, depth);
+    log_trace("cmd batch: %p depth: %u\n", batch, depth);
+    if (nullptr == batch) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    status ret = batch->init();
+    if (DPCP_OK != ret) {
+        delete batch;
+        return ret;
+    }
+
+    return DPCP_OK;
+}
+
+status adapter::create_flow_counter_bulk(uint32_t num, flow_counter_bulk*& bulk)
+{
+    // Single counter or power of 2 bulk in units of 128 counters, up to 8 bits of units.
+    const uint32_t bulk_unit = 128;
+    const uint32_t max_bulk_size = bulk_unit << 7;
+    uint32_t size = 1;
+    if (num > 1) {
+        size = bulk_unit;
+        while (size < num && size < max_bulk_size) {
+            size <<= 1;
+        }
+    }
+    if (0 == num || num > size ||
+        (m_is_caps_available && size > 1 &&
+         size > (1ULL << m_external_hca_caps->flow_table_caps.log_max_flow_counter_bulk))) {
+        log_error("Flow counter bulk of %u counters is not supported\n", num);
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+
+    flow_counter_bulk* _bulk = new (std::nothrow) flow_counter_bulk(get_ctx(), size);
+    if (nullptr == _bulk) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    status ret = _bulk->create();
+    if (DPCP_OK != ret) {
+        delete _bulk;
+        return DPCP_ERR_CREATE;
+    }
+    bulk = _bulk;
+
+    return DPCP_OK;
+}
+
+status reg_mem(dcmd::ctx* ctx, void* buf, size_t sz, dcmd::umem*& umem, uint32_t& mem_id,
+               bool relaxed_ordering = false)
 {
     if (nullptr == ctx) {
         return DPCP_ERR_NO_CONTEXT;
@@ -1079,6 +1334,9 @@ status reg_mem(dcmd::ctx* ctx, void* buf, size_t sz, dcmd::umem*& umem, uint32_t
     }
 
     dcmd::umem_desc dscr = {(void*)buf, sz, 1};
+    if (relaxed_ordering) {
+        dscr.access |= ctx->ibv_get_relaxed_ordering_flags();
+    }
 
     umem = ctx->create_umem(&dscr);
     if (nullptr == umem) {
@@ -1130,9 +1388,9 @@ status adapter::create_extern_mkey(void* address, size_t length, uint32_t id, ex
     return (nullptr == mkey) ? DPCP_ERR_NO_MEMORY : DPCP_OK;
 }
 
-status adapter::create_crypto_mkey(crypto_mkey*& cmk, const uint32_t max_sge)
+status adapter::create_crypto_mkey(crypto_mkey*& cmk, const uint32_t max_sge, mkey_flags flags)
 {
-    cmk = new (std::nothrow) crypto_mkey(this, max_sge);
+    cmk = new (std::nothrow) crypto_mkey(this, max_sge, flags);
     if (nullptr == cmk) {
         return DPCP_ERR_NO_MEMORY;
     }
@@ -1189,7 +1447,8 @@ status adapter::create_cq(const cq_attr& attrs, cq*& out_cq)
         return ret;
     }
     // Register UMEM for CQ Buffer
-    ret = reg_mem(get_ctx(), (void*)cq_buf, cq_buf_sz, cq64->m_cq_buf_umem, cq64->m_cq_buf_umem_id);
+    ret = reg_mem(get_ctx(), (void*)cq_buf, cq_buf_sz, cq64->m_cq_buf_umem, cq64->m_cq_buf_umem_id,
+                  m_queue_relaxed_ordering);
     if (DPCP_OK != ret) {
         cq64->release_cq_buf(cq_buf);
         delete cq64;
@@ -1253,7 +1512,8 @@ status adapter::prepare_basic_rq(basic_rq& srq)
         return ret;
     }
     // Register UMEM for WQ Buffer
-    ret = reg_mem(get_ctx(), (void*)wq_buf, wq_buf_sz, srq.m_wq_buf_umem, srq.m_wq_buf_umem_id);
+    ret = reg_mem(get_ctx(), (void*)wq_buf, wq_buf_sz, srq.m_wq_buf_umem, srq.m_wq_buf_umem_id,
+                  m_queue_relaxed_ordering);
     if (DPCP_OK != ret) {
         return ret;
     }
@@ -1349,22 +1609,24 @@ std::shared_ptr<flow_table> adapter::get_root_table(flow_table_type type)
     return m_root_table_arr[type];
 }
 
-status adapter::verify_flow_table_receive_attr(const flow_table_attr& attr)
+status adapter::verify_flow_table_attr(const flow_table_attr& attr)
 {
-    auto caps = m_external_hca_caps;
+    const flow_table_type_capabilities* caps =
+        get_flow_table_type_caps(m_external_hca_caps, attr.type);
 
-    if (!caps->flow_table_caps.receive.is_flow_table_supported) {
-        log_error("Flow Table from type receive is not supported\n");
+    if (!caps->is_flow_table_supported) {
+        log_error("Flow Table from type %s is not supported\n",
+                  attr.type == flow_table_type::FT_TX ? "transmit" : "receive");
         return DPCP_ERR_CREATE;
     }
-    if (caps->flow_table_caps.receive.max_log_size_flow_table < attr.log_size) {
-        log_error("Flow Table max log size %d, requested %d\n",
-                  caps->flow_table_caps.receive.max_log_size_flow_table, attr.log_size);
+    if (caps->max_log_size_flow_table < attr.log_size) {
+        log_error("Flow Table max log size %d, requested %d\n", caps->max_log_size_flow_table,
+                  attr.log_size);
         return DPCP_ERR_INVALID_PARAM;
     }
-    if (caps->flow_table_caps.receive.max_flow_table_level < attr.level) {
-        log_error("Flow Table max level %d, requested %d\n",
-                  caps->flow_table_caps.receive.max_flow_table_level, attr.level);
+    if (caps->max_flow_table_level < attr.level) {
+        log_error("Flow Table max level %d, requested %d\n", caps->max_flow_table_level,
+                  attr.level);
         return DPCP_ERR_INVALID_PARAM;
     }
 
@@ -1382,7 +1644,8 @@ status adapter::create_flow_table(flow_table_attr& attr, std::shared_ptr<flow_ta
 
     switch (attr.type) {
     case flow_table_type::FT_RX:
-        ret = verify_flow_table_receive_attr(attr);
+    case flow_table_type::FT_TX:
+        ret = verify_flow_table_attr(attr);
         break;
     default:
         log_error("Adapter do not support Flow Table from type %d\n", attr.type);
@@ -1393,7 +1656,7 @@ status adapter::create_flow_table(flow_table_attr& attr, std::shared_ptr<flow_ta
         return ret;
     }
 
-    table.reset(new (std::nothrow) flow_table_prm(m_dcmd_ctx, attr));
+    table.reset(new (std::nothrow) flow_table_prm(m_dcmd_ctx, attr, m_external_hca_caps));
     if (!table) {
         log_error("Flow table allocation failed\n");
         return DPCP_ERR_NO_MEMORY;
@@ -1435,6 +1698,91 @@ status adapter::query_eqn(uint32_t& eqn, uint32_t cpu_vector)
     return DPCP_ERR_QUERY;
 }
 
+// Hairpin queue data buffer is split to packets in strides of 64 bytes
+static const uint8_t HAIRPIN_LOG_STRIDE_SZ = 6;
+
+status adapter::create_hairpin_pair(const hairpin_attr& attr, hairpin_rq*& rq, hairpin_sq*& sq)
+{
+    hairpin_attr hp_attr = attr;
+    uint16_t vhca_id = 0;
+    if (0 == hp_attr.tis_num) {
+        log_error("Hairpin SQ requires a TIS\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    if (m_is_caps_available) {
+        if (!m_external_hca_caps->hairpin) {
+            log_error("Hairpin queues are not supported\n");
+            return DPCP_ERR_NO_SUPPORT;
+        }
+        // Zero selects the largest queue
+        if (0 == hp_attr.log_data_sz) {
+            hp_attr.log_data_sz = m_external_hca_caps->log_max_hairpin_wq_data_sz;
+        }
+    } else if (0 == hp_attr.log_data_sz) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    // Zero fits one packet per stride of the data buffer
+    if (0 == hp_attr.log_num_packets && hp_attr.log_data_sz > HAIRPIN_LOG_STRIDE_SZ) {
+        hp_attr.log_num_packets = hp_attr.log_data_sz - HAIRPIN_LOG_STRIDE_SZ;
+        if (m_is_caps_available) {
+            hp_attr.log_num_packets = std::min(hp_attr.log_num_packets,
+                                               m_external_hca_caps->log_max_hairpin_num_packets);
+        }
+    }
+    if (m_is_caps_available) {
+        if (hp_attr.log_data_sz < m_external_hca_caps->log_min_hairpin_wq_data_sz ||
+            hp_attr.log_data_sz > m_external_hca_caps->log_max_hairpin_wq_data_sz ||
+            hp_attr.log_num_packets > m_external_hca_caps->log_max_hairpin_num_packets) {
+            log_error("Hairpin log_data_sz %u log_num_packets %u are out of range\n",
+                      hp_attr.log_data_sz, hp_attr.log_num_packets);
+            return DPCP_ERR_OUT_OF_RANGE;
+        }
+        vhca_id = m_external_hca_caps->vhca_id;
+    }
+
+    std::unique_ptr<hairpin_rq> hp_rq(new (std::nothrow) hairpin_rq(get_ctx(), hp_attr));
+    if (nullptr == hp_rq) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    sq_attr hp_sq_attr = {};
+    hp_sq_attr.tis_num = hp_attr.tis_num;
+    std::unique_ptr<hairpin_sq> hp_sq(new (std::nothrow)
+                                          hairpin_sq(get_ctx(), hp_sq_attr, hp_attr));
+    if (nullptr == hp_sq) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    status ret = hp_rq->create();
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = hp_sq->create();
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+
+    // Bind the peers, SQ goes ready first as RQ starts to receive immediately
+    hp_rq->get_id(hp_sq->m_peer_rqn);
+    hp_sq->get_id(hp_rq->m_peer_sqn);
+    hp_sq->m_peer_vhca = vhca_id;
+    hp_rq->m_peer_vhca = vhca_id;
+    ret = hp_sq->modify_state(SQ_RDY);
+    if (DPCP_OK != ret) {
+        log_error("Hairpin SQ 0x%x can't be bound to RQ 0x%x, ret %d\n", hp_rq->m_peer_sqn,
+                  hp_sq->m_peer_rqn, ret);
+        return ret;
+    }
+    ret = hp_rq->modify_state(RQ_RDY);
+    if (DPCP_OK != ret) {
+        log_error("Hairpin RQ 0x%x can't be bound to SQ 0x%x, ret %d\n", hp_sq->m_peer_rqn,
+                  hp_rq->m_peer_sqn, ret);
+        return ret;
+    }
+
+    rq = hp_rq.release();
+    sq = hp_sq.release();
+    return DPCP_OK;
+}
+
 status adapter::create_pp_sq(sq_attr& sq_attr, pp_sq*& packet_pacing_sq)
 {
     if (nullptr == m_uarpool) {
@@ -1467,7 +1815,8 @@ status adapter::create_pp_sq(sq_attr& sq_attr, pp_sq*& packet_pacing_sq)
         return ret;
     }
     // Register UMEM for WQ Buffer
-    ret = reg_mem(get_ctx(), (void*)wq_buf, wq_buf_sz, ppsq->m_wq_buf_umem, ppsq->m_wq_buf_umem_id);
+    ret = reg_mem(get_ctx(), (void*)wq_buf, wq_buf_sz, ppsq->m_wq_buf_umem, ppsq->m_wq_buf_umem_id,
+                  m_queue_relaxed_ordering);
     if (DPCP_OK != ret) {
         return ret;
     }
@@ -1521,6 +1870,7 @@ void adapter::set_external_hca_caps()
         callback(m_external_hca_caps, m_caps);
     }
     m_is_caps_available = true;
+    m_flow_action_generator.m_caps = m_external_hca_caps;
 }
 
 status adapter::get_hca_caps_frequency_khz(uint32_t& freq)
@@ -1667,6 +2017,10 @@ adapter::~adapter()
         delete m_uarpool;
         m_uarpool = nullptr;
     }
+    if (m_cmd_queue) {
+        delete m_cmd_queue;
+        m_cmd_queue = nullptr;
+    }
     for (auto cap_type : m_caps) {
         free(cap_type.second);
     }
@@ -0,0 +1,298 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <thread>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+buffer_pool::buffer_pool(adapter* ad, const buffer_pool_attr& attr)
+    : m_adapter(ad)
+    , m_attr(attr)
+    , m_stride_sz(0)
+    , m_slabs()
+    , m_slabs_num(0)
+    , m_grow_lock()
+    , m_caches(nullptr)
+    , m_caches_num(0)
+    , m_global(nullptr)
+{
+    size_t cacheline_sz = get_cacheline_size();
+    m_stride_sz = m_attr.headroom + m_attr.buf_sz + m_attr.tailroom;
+    m_stride_sz = (m_stride_sz + cacheline_sz - 1) & ~(cacheline_sz - 1);
+    if (0 == m_attr.max_slabs_num) {
+        m_attr.max_slabs_num = 1;
+    }
+    // Slabs array is never reallocated, so buffers lookup needs no lock.
+    m_slabs.resize(m_attr.max_slabs_num, slab {nullptr, nullptr, nullptr});
+
+    m_global = new (std::nothrow) buf_stack();
+    if (m_attr.cache_sz) {
+        m_caches_num = std::thread::hardware_concurrency();
+        m_caches_num = m_caches_num ? m_caches_num : 1;
+        m_caches = new (std::nothrow) buf_stack[m_caches_num];
+    }
+    log_trace("CTR buffer_pool: adapter %p buf_sz %zd stride %zd slab_bufs %u max_slabs %u "
+              "caches %u\n",
+              m_adapter, m_attr.buf_sz, m_stride_sz, m_attr.slab_bufs_num, m_attr.max_slabs_num,
+              m_caches_num);
+}
+
+buffer_pool::~buffer_pool()
+{
+    uint32_t slabs_num = m_slabs_num.load();
+    for (uint32_t i = 0; i < slabs_num; i++) {
+        delete m_slabs[i].m_mkey;
+        ::aligned_free(m_slabs[i].m_mem);
+        delete[] m_slabs[i].m_bufs;
+    }
+    delete[] m_caches;
+    delete m_global;
+}
+
+pool_buf* buffer_pool::get_buf(uint32_t idx) const
+{
+    return &m_slabs[idx / m_attr.slab_bufs_num].m_bufs[idx % m_attr.slab_bufs_num];
+}
+
+pool_buf* buffer_pool::pop(buf_stack& stack)
+{
+    uint64_t head = stack.m_head.load(std::memory_order_acquire);
+    while (head & 0xFFFFFFFF) {
+        pool_buf* buf = get_buf((uint32_t)head - 1);
+        uint64_t next = ((head >> 32) + 1) << 32 | buf->next.load(std::memory_order_relaxed);
+        if (stack.m_head.compare_exchange_weak(head, next, std::memory_order_acquire,
+                                               std::memory_order_acquire)) {
+            stack.m_count.fetch_sub(1, std::memory_order_relaxed);
+            return buf;
+        }
+    }
+    return nullptr;
+}
+
+void buffer_pool::push(buf_stack& stack, pool_buf* buf)
+{
+    uint64_t head = stack.m_head.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        buf->next.store((uint32_t)head, std::memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | (buf->idx + 1);
+    } while (!stack.m_head.compare_exchange_weak(head, next, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+    stack.m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+status buffer_pool::add_slab()
+{
+    uint32_t slab_idx = m_slabs_num.load(std::memory_order_relaxed);
+    if (slab_idx >= m_attr.max_slabs_num) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+
+    size_t page_sz = get_page_size();
+    size_t slab_sz = m_stride_sz * m_attr.slab_bufs_num;
+    slab_sz = (slab_sz + page_sz - 1) & ~(page_sz - 1);
+    slab& sl = m_slabs[slab_idx];
+    sl.m_mem = ::aligned_alloc(page_sz, slab_sz);
+    sl.m_bufs = new (std::nothrow) pool_buf[m_attr.slab_bufs_num];
+    if (nullptr == sl.m_mem || nullptr == sl.m_bufs) {
+        log_error("buffer_pool slab %u allocation failed\n", slab_idx);
+        ::aligned_free(sl.m_mem);
+        delete[] sl.m_bufs;
+        sl = slab {nullptr, nullptr, nullptr};
+        return DPCP_ERR_NO_MEMORY;
+    }
+
+    // One registration covers all slab buffers.
+    mkey_flags flags = (mkey_flags)m_attr.slab_mkey_flags;
+    status ret = m_adapter->create_direct_mkey(sl.m_mem, slab_sz, flags, sl.m_mkey);
+    uint32_t lkey = 0;
+    if (DPCP_OK == ret) {
+        ret = sl.m_mkey->get_id(lkey);
+    }
+    if (DPCP_OK != ret) {
+        log_error("buffer_pool slab %u registration failed ret %d\n", slab_idx, ret);
+        delete sl.m_mkey;
+        ::aligned_free(sl.m_mem);
+        delete[] sl.m_bufs;
+        sl = slab {nullptr, nullptr, nullptr};
+        return ret;
+    }
+
+    uint8_t* mem = (uint8_t*)sl.m_mem;
+    uint32_t first_idx = slab_idx * m_attr.slab_bufs_num;
+    for (uint32_t i = 0; i < m_attr.slab_bufs_num; i++) {
+        pool_buf& buf = sl.m_bufs[i];
+        buf.addr = mem + i * m_stride_sz + m_attr.headroom;
+        buf.len = (uint32_t)m_attr.buf_sz;
+        buf.lkey = lkey;
+        buf.refcnt.store(0, std::memory_order_relaxed);
+        buf.idx = first_idx + i;
+        buf.next.store(0, std::memory_order_relaxed);
+    }
+    m_slabs_num.store(slab_idx + 1, std::memory_order_release);
+    // Published by release in push(), buffers lookup above is visible to poppers.
+    for (uint32_t i = 0; i < m_attr.slab_bufs_num; i++) {
+        push(*m_global, &sl.m_bufs[i]);
+    }
+
+    log_trace("buffer_pool slab %u added: mem %p size %zd lkey 0x%x\n", slab_idx, sl.m_mem,
+              slab_sz, lkey);
+    return DPCP_OK;
+}
+
+status buffer_pool::alloc(pool_buf*& buf)
+{
+    buf = nullptr;
+    if (m_caches) {
+        buf = pop(m_caches[get_cpu_id() % m_caches_num]);
+    }
+    while (nullptr == buf) {
+        buf = pop(*m_global);
+        if (buf) {
+            break;
+        }
+        std::lock_guard<std::mutex> lock(m_grow_lock);
+        // Other thread might have grown the pool meanwhile.
+        if (m_global->m_count.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        status ret = add_slab();
+        if (DPCP_OK != ret) {
+            // Pool can't grow, steal from caches of other cores.
+            for (uint32_t i = 0; i < m_caches_num && nullptr == buf; i++) {
+                buf = pop(m_caches[i]);
+            }
+            if (nullptr == buf) {
+                return ret;
+            }
+        }
+    }
+    buf->refcnt.store(1, std::memory_order_relaxed);
+    return DPCP_OK;
+}
+
+void buffer_pool::release(pool_buf* buf)
+{
+    if (1 != buf->refcnt.fetch_sub(1, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (m_caches) {
+        buf_stack& cache = m_caches[get_cpu_id() % m_caches_num];
+        if (cache.m_count.load(std::memory_order_relaxed) < m_attr.cache_sz) {
+            push(cache, buf);
+            return;
+        }
+    }
+    push(*m_global, buf);
+}
+
+status buffer_pool::refill(basic_rq& rq, uint32_t& wqe_head, uint32_t& wqe_cnt, pool_buf** ring)
+{
+    void* wq_buf = nullptr;
+    uint32_t* db_rec = nullptr;
+    uint32_t wqe_num = 0;
+    uint32_t wq_stride_sz = 0;
+    uint32_t to_post = wqe_cnt;
+
+    wqe_cnt = 0;
+    if (nullptr == ring || DPCP_OK != rq.get_wq_buf(wq_buf) || DPCP_OK != rq.get_dbrec(db_rec) ||
+        DPCP_OK != rq.get_wqe_num(wqe_num) || DPCP_OK != rq.get_wq_stride_sz(wq_stride_sz)) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    // Striding RQ WQE starts with next segment followed by single data segment
+    // pointing to the buffer of all WQE strides.
+    size_t dseg_off = 0;
+    if (dynamic_cast<striding_rq*>(&rq)) {
+        size_t stride_sz = 0;
+        size_t stride_num = 0;
+        rq.get_hw_buff_stride_sz(stride_sz);
+        rq.get_hw_buff_stride_num(stride_num);
+        if (m_attr.buf_sz < stride_sz * stride_num) {
+            log_error("buffer_pool buf_sz %zd is less than striding RQ WQE %zd\n", m_attr.buf_sz,
+                      stride_sz * stride_num);
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        dseg_off = sizeof(mlx5_wqe_srq_next_seg);
+    }
+    size_t dsegs_num = (wq_stride_sz - dseg_off) / sizeof(mlx5_wqe_data_seg);
+
+    for (; wqe_cnt < to_post; wqe_cnt++) {
+        pool_buf* buf = nullptr;
+        if (DPCP_OK != alloc(buf)) {
+            break;
+        }
+        uint32_t idx = wqe_head & (wqe_num - 1);
+        uint8_t* wqe = (uint8_t*)wq_buf + (size_t)idx * wq_stride_sz;
+        mlx5_wqe_data_seg* dseg = (mlx5_wqe_data_seg*)(wqe + dseg_off);
+        dseg->byte_count = htobe32(buf->len);
+        dseg->lkey = htobe32(buf->lkey);
+        dseg->addr = htobe64((uint64_t)buf->addr);
+        // Terminate scatter list of regular RQ WQE.
+        if (dsegs_num > 1) {
+            dseg[1].byte_count = 0;
+            dseg[1].lkey = htobe32(MLX5_INVALID_LKEY);
+            dseg[1].addr = 0;
+        }
+        ring[idx] = buf;
+        wqe_head++;
+    }
+    if (0 == wqe_cnt) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+
+    // WQEs must be visible to device before DoorBell record update.
+    dma_wmb();
+    db_rec[0] = htobe32(wqe_head & 0xFFFF);
+    log_trace("buffer_pool refill: rq %p posted %u wqe_head %u\n", &rq, wqe_cnt, wqe_head);
+    return DPCP_OK;
+}
+
+status buffer_pool::get_slabs_num(uint32_t& slabs_num)
+{
+    slabs_num = m_slabs_num.load();
+    return DPCP_OK;
+}
+
+status buffer_pool::get_stride_sz(size_t& stride_sz)
+{
+    stride_sz = m_stride_sz;
+    return DPCP_OK;
+}
+
+} // namespace dpcp
@@ -0,0 +1,280 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <system_error>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+cmd_queue::~cmd_queue()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_cmd_cv.notify_all();
+    for (auto& t : m_workers) {
+        t.join();
+    }
+}
+
+status cmd_queue::add_workers(uint32_t num)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    // Each worker keeps one blocking command in flight.
+    try {
+        while (m_workers.size() < num) {
+            m_workers.emplace_back(&cmd_queue::worker, this);
+        }
+    } catch (const std::system_error& e) {
+        log_error("cmd_queue can't start worker %zd: %s\n", m_workers.size(), e.what());
+        return DPCP_ERR_CREATE;
+    }
+    return DPCP_OK;
+}
+
+void cmd_queue::worker()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true) {
+        m_cmd_cv.wait(lock, [this] { return m_stop || !m_cmds.empty(); });
+        if (m_cmds.empty()) {
+            return;
+        }
+        cmd c = std::move(m_cmds.front());
+        m_cmds.pop_front();
+        c.owner->m_queued--;
+        c.owner->m_running++;
+        lock.unlock();
+        m_done_cv.notify_all();
+
+        status ret = c.fn();
+        if (c.cb) {
+            c.cb(ret);
+        }
+        c.fn = nullptr;
+        c.cb = nullptr;
+
+        lock.lock();
+        // The batch may be destroyed as soon as it sees no running commands.
+        c.owner->m_running--;
+        m_done_cv.notify_all();
+    }
+}
+
+cmd_batch::cmd_batch(adapter* ad, cmd_queue* queue, uint32_t depth)
+    : m_adapter(ad)
+    , m_depth(depth)
+    , m_queue(queue)
+    , m_queued(0)
+    , m_running(0)
+    , m_comp(nullptr)
+    , m_query_lock()
+    , m_slots(depth)
+    , m_free_slots()
+    , m_resp()
+{
+    m_free_slots.reserve(depth);
+    for (uint32_t i = depth; i > 0; i--) {
+        m_free_slots.push_back(i - 1);
+    }
+}
+
+status cmd_batch::init()
+{
+    status ret = m_queue->add_workers(m_depth);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+
+    // Old kernels have no asynchronous commands, queries go to workers then.
+    m_comp = m_adapter->get_ctx()->create_cmd_comp();
+    log_trace("cmd_batch %p depth %u async query %d\n", this, m_depth, nullptr != m_comp);
+    return DPCP_OK;
+}
+
+cmd_batch::~cmd_batch()
+{
+    wait_all();
+    delete m_comp;
+}
+
+status cmd_batch::submit(cmd_fn fn, cmd_cb cb)
+{
+    if (!fn) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    {
+        std::unique_lock<std::mutex> lock(m_queue->m_lock);
+        // Commands taken by workers are still in flight until they complete
+        m_queue->m_done_cv.wait(lock, [this] { return m_queued + m_running < m_depth; });
+        m_queue->m_cmds.push_back(cmd_queue::cmd {this, std::move(fn), std::move(cb)});
+        m_queued++;
+    }
+    m_queue->m_cmd_cv.notify_one();
+    return DPCP_OK;
+}
+
+status cmd_batch::submit(cmd_fn fn, std::future<status>& result)
+{
+    std::shared_ptr<std::promise<status>> promise = std::make_shared<std::promise<status>>();
+    result = promise->get_future();
+    return submit(std::move(fn), [promise](status ret) { promise->set_value(ret); });
+}
+
+status cmd_batch::reap_query(cmd_cb& cb, status& cb_ret)
+{
+    uint64_t wr_id = 0;
+    int err = m_comp->get_comp(wr_id, m_resp.data(), m_resp.size());
+    if (DCMD_EOK != err || wr_id >= m_slots.size()) {
+        log_error("cmd_batch can't get query completion err %d wr_id %llu\n", err,
+                  (unsigned long long)wr_id);
+        return DPCP_ERR_QUERY;
+    }
+
+    query_slot& slot = m_slots[wr_id];
+    memcpy(slot.m_out, m_resp.data(), slot.m_out_sz);
+    cb_ret = DPCP_OK;
+    if (DEVX_GET(status_out, slot.m_out, status)) {
+        log_trace("cmd_batch query %llu status: %u syndrome: %x\n", (unsigned long long)wr_id,
+                  DEVX_GET(status_out, slot.m_out, status),
+                  DEVX_GET(status_out, slot.m_out, syndrome));
+        cb_ret = DPCP_ERR_QUERY;
+    }
+    // Callback is called by the caller after m_query_lock is released,
+    // so it may issue new queries.
+    cb = std::move(slot.m_cb);
+    slot = query_slot {nullptr, 0, nullptr};
+    m_free_slots.push_back((uint32_t)wr_id);
+    return DPCP_OK;
+}
+
+void cmd_batch::fail_queries(std::unique_lock<std::mutex>& lock)
+{
+    std::vector<cmd_cb> cbs;
+    for (uint32_t i = 0; i < m_slots.size(); i++) {
+        if (m_slots[i].m_out) {
+            cbs.push_back(std::move(m_slots[i].m_cb));
+            m_slots[i] = query_slot {nullptr, 0, nullptr};
+            m_free_slots.push_back(i);
+        }
+    }
+    // Late completions must not reach reused slots, next queries go to workers.
+    delete m_comp;
+    m_comp = nullptr;
+    log_error("cmd_batch %p failed %zd outstanding queries\n", this, cbs.size());
+
+    lock.unlock();
+    for (auto& cb : cbs) {
+        if (cb) {
+            cb(DPCP_ERR_QUERY);
+        }
+    }
+    lock.lock();
+}
+
+status cmd_batch::query(obj& o, void* in, size_t in_sz, void* out, size_t out_sz, cmd_cb cb)
+{
+    if (nullptr == in || nullptr == out) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    std::unique_lock<std::mutex> lock(m_query_lock);
+    if (nullptr == m_comp) {
+        lock.unlock();
+        return submit(
+            [&o, in, in_sz, out, out_sz]() {
+                size_t sz = out_sz;
+                return o.query(in, in_sz, out, sz);
+            },
+            std::move(cb));
+    }
+    // Completion buffer fits the largest output in flight
+    if (m_resp.size() < out_sz) {
+        m_resp.resize(out_sz);
+    }
+    while (m_free_slots.empty()) {
+        cmd_cb done_cb;
+        status done_ret = DPCP_OK;
+        status ret = reap_query(done_cb, done_ret);
+        if (DPCP_OK != ret) {
+            fail_queries(lock);
+            return ret;
+        }
+        if (done_cb) {
+            lock.unlock();
+            done_cb(done_ret);
+            lock.lock();
+        }
+    }
+    uint32_t slot_idx = m_free_slots.back();
+    status ret = o.query_async(in, in_sz, out_sz, slot_idx, m_comp);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    m_free_slots.pop_back();
+    m_slots[slot_idx] = query_slot {out, out_sz, std::move(cb)};
+    return DPCP_OK;
+}
+
+status cmd_batch::wait_all()
+{
+    status ret = DPCP_OK;
+    {
+        std::unique_lock<std::mutex> lock(m_query_lock);
+        while (m_comp && m_free_slots.size() < m_depth) {
+            cmd_cb done_cb;
+            status done_ret = DPCP_OK;
+            status reap_ret = reap_query(done_cb, done_ret);
+            if (DPCP_OK != reap_ret) {
+                fail_queries(lock);
+                ret = reap_ret;
+                break;
+            }
+            if (done_cb) {
+                lock.unlock();
+                done_cb(done_ret);
+                lock.lock();
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(m_queue->m_lock);
+    m_queue->m_done_cv.wait(lock, [this] { return !m_queued && !m_running; });
+    return ret;
+}
+
+} // namespace dpcp
@@ -102,6 +102,8 @@ status obj::create(void* in, size_t inlen, void* out, size_t& outlen)
     log_trace("create in: %p inlen: %zu out: %p outlen: %zu\n", obj_desc.in, obj_desc.inlen,
               obj_desc.out, obj_desc.outlen);
 
+    // Release handle left by previous destroy() when object is recreated
+    delete m_obj_handle;
     m_obj_handle = m_ctx->create_obj(&obj_desc);
 
     m_last_status = DEVX_GET(status_out, out, status);
@@ -173,4 +175,26 @@ status obj::query(void* in, size_t inlen, void* out, size_t& outlen)
     }
     return DPCP_OK;
 }
+
+status obj::query_async(void* in, size_t inlen, size_t outlen, uint64_t wr_id,
+                        dcmd::cmd_comp* comp)
+{
+    if (!m_ctx)
+        return DPCP_ERR_NO_CONTEXT;
+
+    if ((nullptr == in) || (nullptr == comp) || (inlen < 16) || (outlen < 16))
+        return DPCP_ERR_INVALID_PARAM;
+
+    if (nullptr == m_obj_handle)
+        return DPCP_ERR_INVALID_ID;
+
+    struct dcmd::obj_desc obj_desc = {in, inlen, nullptr, outlen};
+
+    int ret = m_obj_handle->query_async(&obj_desc, wr_id, comp);
+    if (DCMD_EOK != ret) {
+        log_error("query_async returns: %d\n", ret);
+        return DPCP_ERR_QUERY;
+    }
+    return DPCP_OK;
+}
 } // namespace dpcp
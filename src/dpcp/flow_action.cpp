@@ -34,6 +34,9 @@
 
 namespace dpcp {
 
+// Shared action caches drop released actions on insert above this size
+static const size_t ACTION_CACHE_SWEEP_SIZE = 1024;
+
 ////////////////////////////////////////////////////////////////////////
 // flow_action_modify implementation.                                 //
 ////////////////////////////////////////////////////////////////////////
@@ -75,6 +78,7 @@ flow_action_modify::flow_action_modify(dcmd::ctx* ctx, flow_action_modify_attr&
     , m_attr(attr)
     , m_is_valid(false)
     , m_modify_id(0)
+    , m_create_lock()
 {
 }
 
@@ -144,6 +148,8 @@ status flow_action_modify::apply(void* in)
 {
     status ret = DPCP_OK;
 
+    // HW object is created by the first rule.
+    std::unique_lock<std::mutex> lock(m_create_lock);
     if (!m_is_valid) {
         ret = create_prm_modify();
         if (ret != DPCP_OK) {
@@ -151,6 +157,7 @@ status flow_action_modify::apply(void* in)
             return ret;
         }
     }
+    lock.unlock();
 
     void* in_flow_context = DEVX_ADDR_OF(set_fte_in, in, flow_context);
     uint32_t action_enabled = DEVX_GET(flow_context, in_flow_context, action);
@@ -228,6 +235,7 @@ status flow_action_modify::apply(dcmd::flow_desc& flow_desc)
 {
     status ret = DPCP_OK;
 
+    std::unique_lock<std::mutex> lock(m_create_lock);
     if (!m_actions_root) {
         ret = prepare_prm_modify_buff();
         if (ret != DPCP_OK) {
@@ -240,6 +248,7 @@ status flow_action_modify::apply(dcmd::flow_desc& flow_desc)
             return ret;
         }
     }
+    lock.unlock();
 
     flow_desc.modify_actions = reinterpret_cast<dcmd::modify_action*>(m_actions_root.get());
     flow_desc.num_of_actions = m_attr.actions.size();
@@ -489,6 +498,7 @@ status flow_action_fwd::apply(dcmd::flow_desc& flow_desc)
 {
     status ret = DPCP_OK;
 
+    std::unique_lock<std::mutex> lock(m_create_lock);
     if (!m_root_action_fwd) {
         ret = create_root_action_fwd();
         if (ret != DPCP_OK) {
@@ -496,6 +506,7 @@ status flow_action_fwd::apply(dcmd::flow_desc& flow_desc)
             return ret;
         }
     }
+    lock.unlock();
 
     int dcmd_ret = m_root_action_fwd->apply(flow_desc);
     if (dcmd_ret != DCMD_EOK) {
@@ -519,6 +530,7 @@ const std::vector<forwardable_obj*>& flow_action_fwd::get_dest_objs()
 flow_action_fwd::flow_action_fwd(dcmd::ctx* ctx, std::vector<forwardable_obj*> dests)
     : flow_action(ctx)
     , m_dests(std::move(dests))
+    , m_create_lock()
     , m_root_action_fwd()
 {
 }
@@ -552,6 +564,79 @@ status flow_action_reparse::apply(dcmd::flow_desc& flow_desc)
     return DPCP_ERR_NO_SUPPORT;
 }
 
+////////////////////////////////////////////////////////////////////////
+// flow_action_allow implemitation.                                   //
+////////////////////////////////////////////////////////////////////////
+
+flow_action_allow::flow_action_allow(dcmd::ctx* ctx)
+    : flow_action(ctx)
+{
+}
+
+status flow_action_allow::apply(void* in)
+{
+    void* in_flow_context = DEVX_ADDR_OF(set_fte_in, in, flow_context);
+
+    // Enable allow action:
+    uint32_t action_enabled = DEVX_GET(flow_context, in_flow_context, action);
+    action_enabled |= MLX5_FLOW_CONTEXT_ACTION_ALLOW;
+    DEVX_SET(flow_context, in_flow_context, action, action_enabled);
+
+    log_trace("Flow Action allow was applied\n");
+    return DPCP_OK;
+}
+
+status flow_action_allow::apply(dcmd::flow_desc& flow_desc)
+{
+    NOT_IN_USE(flow_desc);
+    log_error("Flow Action allow is not supported on root table\n");
+    return DPCP_ERR_NO_SUPPORT;
+}
+
+////////////////////////////////////////////////////////////////////////
+// flow_action_counter implementation.                                //
+////////////////////////////////////////////////////////////////////////
+
+flow_action_counter::flow_action_counter(dcmd::ctx* ctx, uint32_t counter_id)
+    : flow_action(ctx)
+    , m_counter_id(counter_id)
+{
+}
+
+status flow_action_counter::apply(void* in)
+{
+    void* in_flow_context = DEVX_ADDR_OF(set_fte_in, in, flow_context);
+    uint32_t dests_num = DEVX_GET(flow_context, in_flow_context, destination_list_size);
+    uint32_t counters_num = DEVX_GET(flow_context, in_flow_context, flow_counter_list_size);
+
+    // Counters list follows the destinations list.
+    uint8_t* curr_counter = (uint8_t*)DEVX_ADDR_OF(flow_context, in_flow_context, destination) +
+        (dests_num + counters_num) * DEVX_ST_SZ_BYTES(dest_format_struct);
+    DEVX_SET(flow_counter_list, curr_counter, flow_counter_id, m_counter_id);
+    DEVX_SET(flow_context, in_flow_context, flow_counter_list_size, counters_num + 1);
+
+    // Enable count action.
+    uint32_t action_enabled = DEVX_GET(flow_context, in_flow_context, action);
+    action_enabled |= MLX5_FLOW_CONTEXT_ACTION_COUNT;
+    DEVX_SET(flow_context, in_flow_context, action, action_enabled);
+
+    log_trace("Flow Action counter 0x%x was applied\n", m_counter_id);
+    return DPCP_OK;
+}
+
+status flow_action_counter::apply(dcmd::flow_desc& flow_desc)
+{
+    NOT_IN_USE(flow_desc);
+    log_error("Flow Action counter is not supported on root table\n");
+    return DPCP_ERR_NO_SUPPORT;
+}
+
+status flow_action_counter::get_id(uint32_t& id)
+{
+    id = m_counter_id;
+    return DPCP_OK;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // flow_action_generator implemitation.                               //
 ////////////////////////////////////////////////////////////////////////
@@ -559,6 +644,11 @@ status flow_action_reparse::apply(dcmd::flow_desc& flow_desc)
 flow_action_generator::flow_action_generator(dcmd::ctx* ctx, const adapter_hca_capabilities* caps)
     : m_ctx(ctx)
     , m_caps(caps)
+    , m_cache_lock()
+    , m_modify_cache()
+    , m_reformat_cache()
+    , m_cache_hits(0)
+    , m_cache_misses(0)
 {
 }
 
@@ -593,4 +683,126 @@ std::shared_ptr<flow_action> flow_action_generator::create_reparse()
     return std::shared_ptr<flow_action>(new (std::nothrow) flow_action_reparse(m_ctx));
 }
 
+std::shared_ptr<flow_action> flow_action_generator::create_counter(flow_counter_bulk& bulk,
+                                                                   uint32_t offset)
+{
+    uint32_t counter_id = 0;
+    if (bulk.get_counter_id(offset, counter_id) != DPCP_OK) {
+        return nullptr;
+    }
+    return std::shared_ptr<flow_action>(new (std::nothrow)
+                                            flow_action_counter(m_ctx, counter_id));
+}
+
+std::shared_ptr<flow_action> flow_action_generator::create_allow()
+{
+    return std::shared_ptr<flow_action>(new (std::nothrow) flow_action_allow(m_ctx));
+}
+
+std::shared_ptr<flow_action> flow_action_generator::get_shared(
+    action_cache_t& cache, const std::string& key, const std::function<flow_action*()>& create)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_cache_lock);
+        auto iter = cache.find(key);
+        if (iter != cache.end()) {
+            std::shared_ptr<flow_action> action = iter->second.lock();
+            if (action) {
+                m_cache_hits++;
+                return action;
+            }
+        }
+    }
+
+    // Creation may issue a FW command, other actions are not blocked by it.
+    std::shared_ptr<flow_action> action(create());
+    if (!action) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> guard(m_cache_lock);
+    std::weak_ptr<flow_action>& entry = cache[key];
+    std::shared_ptr<flow_action> cached = entry.lock();
+    if (cached) {
+        // Same action was inserted meanwhile, ours is released.
+        m_cache_hits++;
+        return cached;
+    }
+    m_cache_misses++;
+    entry = action;
+
+    if (cache.size() > ACTION_CACHE_SWEEP_SIZE) {
+        for (auto it = cache.begin(); it != cache.end();) {
+            it = it->second.expired() ? cache.erase(it) : std::next(it);
+        }
+    }
+    return action;
+}
+
+std::shared_ptr<flow_action> flow_action_generator::get_shared_modify(flow_action_modify_attr& attr)
+{
+    // PRM command of the action is its canonical form, HW object is created on first use.
+    std::unique_ptr<flow_action_modify> action(new (std::nothrow) flow_action_modify(m_ctx, attr));
+    if (!action || action->prepare_prm_modify_buff() != DPCP_OK) {
+        return nullptr;
+    }
+    std::string key(reinterpret_cast<const char*>(action->m_in.get()), action->m_inlen);
+
+    return get_shared(m_modify_cache, key, [&action]() { return action.release(); });
+}
+
+std::shared_ptr<flow_action>
+flow_action_generator::get_shared_reformat(flow_action_reformat_attr& attr)
+{
+    std::unique_ptr<uint8_t[]> in_mem_guard;
+    size_t in_len = 0;
+    if (attr.type != flow_action_reformat_type::INSERT_HDR ||
+        flow_action_reformat::alloc_reformat_insert_action(in_mem_guard, in_len, attr) !=
+            DPCP_OK) {
+        log_error("Flow action reformat type 0x%x can't be shared\n", attr.type);
+        return nullptr;
+    }
+    std::string key(reinterpret_cast<const char*>(in_mem_guard.get()), in_len);
+
+    return get_shared(m_reformat_cache, key, [this, &attr]() -> flow_action* {
+        flow_action_reformat* action = new (std::nothrow) flow_action_reformat(m_ctx, attr);
+        if (action && !action->m_is_valid) {
+            delete action;
+            action = nullptr;
+        }
+        return action;
+    });
+}
+
+status flow_action_generator::get_cache_stats(flow_action_cache_stats& stats)
+{
+    std::lock_guard<std::mutex> guard(m_cache_lock);
+
+    memset(&stats, 0, sizeof(stats));
+    stats.hits = m_cache_hits;
+    stats.misses = m_cache_misses;
+    for (const auto& entry : m_modify_cache) {
+        std::shared_ptr<flow_action> action = entry.second.lock();
+        flow_table_type type =
+            action ? static_cast<flow_action_modify*>(action.get())->m_attr.table_type : FT_END;
+        if (type < FT_END) {
+            stats.modify_entries[type]++;
+        }
+    }
+    for (const auto& entry : m_reformat_cache) {
+        stats.reformat_entries += !entry.second.expired();
+    }
+    if (m_caps) {
+        for (int type = FT_RX; type < FT_END; type++) {
+            const flow_table_type_capabilities* ft_caps =
+                get_flow_table_type_caps(m_caps, (flow_table_type)type);
+            stats.modify_capacity[type] = 1U << ft_caps->modify_flow_action_caps.max_obj_log_num;
+        }
+        stats.reformat_capacity = 1U
+            << m_caps->flow_table_caps.reformat_flow_action_caps.max_log_num_of_packet_reformat;
+    }
+
+    return DPCP_OK;
+}
+
 } // namespace dpcp
@@ -0,0 +1,341 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <system_error>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+flow_aging::flow_aging(const flow_aging_attr& attr, flow_aging_cb cb)
+    : m_attr(attr)
+    , m_cb(std::move(cb))
+    , m_lock()
+    , m_query_cv()
+    , m_bulks()
+    , m_tracked(0)
+    , m_aged()
+    , m_sweep_lock()
+    , m_remove()
+    , m_worker(nullptr)
+{
+}
+
+flow_aging::~flow_aging()
+{
+    stop();
+}
+
+status flow_aging::start()
+{
+    if (0 == m_attr.sweep_interval_ms) {
+        log_error("flow_aging can't start, sweep interval is 0\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    if (m_worker) {
+        return DPCP_OK;
+    }
+    m_worker = new (std::nothrow) aging_worker();
+    if (nullptr == m_worker) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    try {
+        m_worker->m_thread = std::thread(&flow_aging::worker, this);
+    } catch (const std::system_error& e) {
+        log_error("flow_aging can't start worker: %s\n", e.what());
+        delete m_worker;
+        m_worker = nullptr;
+        return DPCP_ERR_CREATE;
+    }
+    log_trace("flow_aging %p started, interval %u ms\n", this, m_attr.sweep_interval_ms);
+    return DPCP_OK;
+}
+
+void flow_aging::stop()
+{
+    if (nullptr == m_worker) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(m_worker->m_lock);
+        m_worker->m_stop = true;
+    }
+    m_worker->m_cv.notify_all();
+    m_worker->m_thread.join();
+    delete m_worker;
+    m_worker = nullptr;
+}
+
+void flow_aging::worker()
+{
+    std::unique_lock<std::mutex> lock(m_worker->m_lock);
+    while (!m_worker->m_cv.wait_for(lock, std::chrono::milliseconds(m_attr.sweep_interval_ms),
+                                    [this] { return m_worker->m_stop; })) {
+        lock.unlock();
+        uint32_t aged = 0;
+        sweep(aged);
+        lock.lock();
+    }
+}
+
+status flow_aging::track(flow_counter_bulk& bulk, uint32_t offset, const slot& s)
+{
+    if (offset >= bulk.get_size()) {
+        log_error("flow_aging counter offset %u is out of bulk size %u\n", offset,
+                  bulk.get_size());
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+    if (s.group.expired()) {
+        log_error("flow_aging flow group is not valid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    bulk_slots& entry = m_bulks[&bulk];
+    std::vector<slot>& slots = entry.slots;
+    if (slots.empty()) {
+        slots.resize(bulk.get_size());
+    }
+    if (SLOT_FREE == slots[offset].state) {
+        entry.used++;
+        m_tracked++;
+    }
+    slots[offset] = s;
+    slots[offset].state = SLOT_NEW;
+    slots[offset].last_change_ms = get_time_ms();
+    return DPCP_OK;
+}
+
+status flow_aging::track(flow_counter_bulk& bulk, uint32_t offset, std::weak_ptr<flow_group> group,
+                         std::weak_ptr<flow_rule_ex> rule, uint64_t cookie)
+{
+    if (rule.expired()) {
+        log_error("flow_aging flow rule is not valid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    slot s = {};
+    s.group = group;
+    s.rule = rule;
+    s.cookie = cookie;
+    return track(bulk, offset, s);
+}
+
+status flow_aging::track_compact(flow_counter_bulk& bulk, uint32_t offset,
+                                 std::weak_ptr<flow_group> group, flow_rule_handle handle,
+                                 uint64_t cookie)
+{
+    slot s = {};
+    s.group = group;
+    s.handle = handle;
+    s.compact = true;
+    s.cookie = cookie;
+    return track(bulk, offset, s);
+}
+
+void flow_aging::release_bulk(std::unique_lock<std::mutex>& lock, flow_counter_bulk* bulk)
+{
+    // A sweep queries bulks without m_lock, the bulk may be deleted once it is done.
+    m_query_cv.wait(lock, [this, bulk] {
+        auto it = m_bulks.find(bulk);
+        return it == m_bulks.end() || !it->second.querying;
+    });
+    auto it = m_bulks.find(bulk);
+    if (it != m_bulks.end() && 0 == it->second.used) {
+        m_bulks.erase(it);
+    }
+}
+
+status flow_aging::untrack(flow_counter_bulk& bulk, uint32_t offset)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    auto it = m_bulks.find(&bulk);
+    if (it == m_bulks.end() || offset >= it->second.slots.size() ||
+        SLOT_FREE == it->second.slots[offset].state) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    it->second.slots[offset] = slot();
+    it->second.used--;
+    m_tracked--;
+    if (0 == it->second.used) {
+        release_bulk(lock, &bulk);
+    }
+    return DPCP_OK;
+}
+
+status flow_aging::untrack_bulk(flow_counter_bulk& bulk)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    auto it = m_bulks.find(&bulk);
+    if (it == m_bulks.end() || 0 == it->second.used) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    m_tracked -= it->second.used;
+    it->second.used = 0;
+    std::fill(it->second.slots.begin(), it->second.slots.end(), slot());
+    release_bulk(lock, &bulk);
+    return DPCP_OK;
+}
+
+status flow_aging::sweep(uint32_t& aged)
+{
+    std::lock_guard<std::mutex> sweep_guard(m_sweep_lock);
+    status ret = DPCP_OK;
+    aged = 0;
+
+    std::vector<flow_counter_bulk*> bulks;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        bulks.reserve(m_bulks.size());
+        for (auto& it : m_bulks) {
+            it.second.querying = true;
+            bulks.push_back(it.first);
+        }
+    }
+
+    // Single query per bulk, commands are not issued under m_lock.
+    std::vector<std::shared_ptr<const flow_counter_snapshot>> snapshots(bulks.size());
+    for (size_t i = 0; i < bulks.size(); i++) {
+        status rc = bulks[i]->refresh_snapshot();
+        if (DPCP_OK != rc) {
+            log_error("flow_aging can't query flow counter bulk %p, ret %d\n", bulks[i], rc);
+            ret = rc;
+            continue;
+        }
+        snapshots[i] = bulks[i]->get_snapshot();
+    }
+
+    std::vector<flow_aging_entry> found;
+    uint64_t now = get_time_ms();
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        for (size_t i = 0; i < bulks.size(); i++) {
+            // Entry is kept while querying is set.
+            auto it = m_bulks.find(bulks[i]);
+            it->second.querying = false;
+            std::vector<slot>& slots = it->second.slots;
+            for (uint32_t offset = 0; snapshots[i] && offset < slots.size(); offset++) {
+                const flow_counter_stats& stats = snapshots[i]->stats[offset];
+                slot& s = slots[offset];
+                if (SLOT_FREE == s.state) {
+                    continue;
+                }
+                // First sweep takes the base values.
+                if (SLOT_NEW == s.state || stats.packets != s.packets ||
+                    stats.bytes != s.bytes) {
+                    s.packets = stats.packets;
+                    s.bytes = stats.bytes;
+                    s.last_change_ms = now;
+                    s.state = SLOT_TRACKED;
+                    continue;
+                }
+                if (now - s.last_change_ms < m_attr.timeout_ms) {
+                    continue;
+                }
+
+                flow_aging_entry entry;
+                entry.group = s.group;
+                entry.rule = s.rule;
+                entry.handle = s.handle;
+                entry.is_compact = s.compact;
+                entry.bulk = bulks[i];
+                entry.offset = offset;
+                entry.cookie = s.cookie;
+                entry.idle_ms = now - s.last_change_ms;
+                entry.removed = false;
+                found.push_back(entry);
+
+                s = slot();
+                it->second.used--;
+                m_tracked--;
+            }
+            if (0 == it->second.used) {
+                m_bulks.erase(it);
+            }
+        }
+    }
+    m_query_cv.notify_all();
+
+    if (m_attr.remove_batch) {
+        m_remove.insert(m_remove.end(), found.begin(), found.end());
+        size_t num = std::min<size_t>(m_remove.size(), m_attr.remove_batch);
+        found.assign(m_remove.begin(), m_remove.begin() + num);
+        m_remove.erase(m_remove.begin(), m_remove.begin() + num);
+
+        for (flow_aging_entry& entry : found) {
+            std::shared_ptr<flow_group> group = entry.group.lock();
+            if (!group) {
+                continue;
+            }
+            status rc = entry.is_compact ? group->remove_flow_rule_compact(entry.handle)
+                                         : group->remove_flow_rule(entry.rule);
+            if (DPCP_OK != rc) {
+                log_warn("flow_aging can't remove aged flow rule, ret %d\n", rc);
+                continue;
+            }
+            entry.removed = true;
+        }
+    }
+
+    aged = (uint32_t)found.size();
+    log_trace("flow_aging %p sweep: bulks %zu aged %u pending removal %zu\n", this, bulks.size(),
+              aged, m_remove.size());
+    if (found.empty()) {
+        return ret;
+    }
+    if (m_cb) {
+        m_cb(found);
+    } else {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_aged.insert(m_aged.end(), found.begin(), found.end());
+    }
+    return ret;
+}
+
+void flow_aging::get_aged(std::vector<flow_aging_entry>& entries)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    entries.clear();
+    entries.swap(m_aged);
+}
+
+size_t flow_aging::get_tracked()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_tracked;
+}
+
+} // namespace dpcp
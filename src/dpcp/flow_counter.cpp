@@ -0,0 +1,275 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <memory>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+// Bulk of counters is allocated in units of 128, queried ranges are aligned to 4.
+static const uint32_t FLOW_COUNTER_BULK_UNIT = 128;
+static const uint32_t FLOW_COUNTER_QUERY_ALIGN = 4;
+
+flow_counter_bulk::flow_counter_bulk(dcmd::ctx* ctx, uint32_t size)
+    : obj(ctx)
+    , m_size(size)
+    , m_refresh_lock()
+    , m_snapshot()
+{
+}
+
+status flow_counter_bulk::create()
+{
+    uint32_t in[DEVX_ST_SZ_DW(alloc_flow_counter_in)] = {0};
+    uint32_t out[DEVX_ST_SZ_DW(alloc_flow_counter_out)] = {0};
+    size_t outlen = sizeof(out);
+
+    DEVX_SET(alloc_flow_counter_in, in, opcode, MLX5_CMD_OP_ALLOC_FLOW_COUNTER);
+    if (m_size > 1) {
+        DEVX_SET(alloc_flow_counter_in, in, flow_counter_bulk, m_size / FLOW_COUNTER_BULK_UNIT);
+    }
+
+    status ret = obj::create(in, sizeof(in), out, outlen);
+    if (DPCP_OK == ret) {
+        uint32_t id = 0;
+        obj::get_id(id);
+        log_trace("Flow counter bulk created: id=0x%x size=%u\n", id, m_size);
+    }
+
+    return ret;
+}
+
+status flow_counter_bulk::get_counter_id(uint32_t offset, uint32_t& id)
+{
+    if (offset >= m_size) {
+        log_error("Flow counter offset %u is out of bulk size %u\n", offset, m_size);
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+
+    status ret = obj::get_id(id);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    id += offset;
+
+    return DPCP_OK;
+}
+
+status flow_counter_bulk::prepare_query(void* in, uint32_t offset, uint32_t num, bool clear)
+{
+    if (!num || offset >= m_size || num > m_size - offset) {
+        log_error("Flow counter range %u:%u is out of bulk size %u\n", offset, num, m_size);
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+
+    uint32_t counter_id = 0;
+    status ret = get_counter_id(offset, counter_id);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+
+    DEVX_SET(query_flow_counter_in, in, opcode, MLX5_CMD_OP_QUERY_FLOW_COUNTER);
+    DEVX_SET(query_flow_counter_in, in, flow_counter_id, counter_id);
+    DEVX_SET(query_flow_counter_in, in, clear, clear);
+    // Zero queries a single counter, it is the only form valid for a counter out of bulk
+    // or out of the bulk query alignment.
+    if (num > 1) {
+        DEVX_SET(query_flow_counter_in, in, num_of_counters, num);
+    }
+
+    return DPCP_OK;
+}
+
+status flow_counter_bulk::query(uint32_t offset, uint32_t num,
+                                std::vector<flow_counter_stats>& stats, bool clear)
+{
+    if (!num || offset >= m_size || num > m_size - offset) {
+        log_error("Flow counter range %u:%u is out of bulk size %u\n", offset, num, m_size);
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+
+    // Range of a bulk query must be aligned, extra counters are dropped.
+    uint32_t first = offset;
+    uint32_t last = offset + num;
+    if (m_size > 1) {
+        first = offset & ~(FLOW_COUNTER_QUERY_ALIGN - 1);
+        last = std::min(align(offset + num, FLOW_COUNTER_QUERY_ALIGN), m_size);
+    }
+    stats.resize(num);
+    if (!clear || (first == offset && last == offset + num)) {
+        return query_range(first, last - first, offset, num, stats.data(), clear);
+    }
+
+    // Clearing the extra counters would reset neighbours of the range.
+    for (uint32_t i = 0; i < num; i++) {
+        status ret = query_range(offset + i, 1, offset + i, 1, &stats[i], true);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+    }
+
+    return DPCP_OK;
+}
+
+status flow_counter_bulk::query_range(uint32_t first, uint32_t count, uint32_t offset,
+                                      uint32_t num, flow_counter_stats* stats, bool clear)
+{
+    uint32_t in[DEVX_ST_SZ_DW(query_flow_counter_in)] = {0};
+
+    status ret = prepare_query(in, first, count, clear);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+
+    size_t outlen = DEVX_ST_SZ_BYTES(query_flow_counter_out) +
+        DEVX_ST_SZ_BYTES(traffic_counter) * (size_t)count;
+    std::unique_ptr<uint8_t[]> out(new (std::nothrow) uint8_t[outlen]);
+    if (!out) {
+        log_error("Flow counter out buf memory allocation failed\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+    memset(out.get(), 0, outlen);
+
+    ret = obj::query(in, sizeof(in), out.get(), outlen);
+    if (DPCP_OK != ret) {
+        log_error("Flow counter query of %u counters failed, ret=%d\n", num, ret);
+        return ret;
+    }
+
+    uint8_t* records = (uint8_t*)DEVX_ADDR_OF(query_flow_counter_out, out.get(), flow_statistics);
+    parse(records + (offset - first) * DEVX_ST_SZ_BYTES(traffic_counter), num, stats);
+
+    return DPCP_OK;
+}
+
+status flow_counter_bulk::query_to_memory(uint32_t offset, uint32_t num, uint32_t lkey, void* addr,
+                                          bool clear)
+{
+    uint32_t in[DEVX_ST_SZ_DW(query_flow_counter_in)] = {0};
+    uint32_t out[DEVX_ST_SZ_DW(query_flow_counter_out)] = {0};
+    size_t outlen = sizeof(out);
+
+    if (!addr || (m_size > 1 && (offset | num) % FLOW_COUNTER_QUERY_ALIGN)) {
+        log_error("Flow counter range %u:%u must be aligned to %u\n", offset, num,
+                  FLOW_COUNTER_QUERY_ALIGN);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    status ret = prepare_query(in, offset, num, clear);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    DEVX_SET(query_flow_counter_in, in, dump_to_memory, 1);
+    DEVX_SET(query_flow_counter_in, in, mkey, lkey);
+    DEVX_SET64(query_flow_counter_in, in, address, (uint64_t)addr);
+
+    return obj::query(in, sizeof(in), out, outlen);
+}
+
+status flow_counter_bulk::query_to_memory(cmd_batch& batch, uint32_t offset, uint32_t num,
+                                          uint32_t lkey, void* addr,
+                                          std::function<void(status)> cb)
+{
+    const size_t inlen = DEVX_ST_SZ_BYTES(query_flow_counter_in);
+    const size_t outlen = DEVX_ST_SZ_BYTES(query_flow_counter_out);
+
+    if (!addr || (m_size > 1 && (offset | num) % FLOW_COUNTER_QUERY_ALIGN)) {
+        log_error("Flow counter range %u:%u must be aligned to %u\n", offset, num,
+                  FLOW_COUNTER_QUERY_ALIGN);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    // Command buffers live until the completion callback.
+    std::shared_ptr<std::vector<uint8_t>> buf(new (std::nothrow) std::vector<uint8_t>());
+    if (!buf) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    buf->resize(inlen + outlen, 0);
+    void* in = buf->data();
+    void* out = buf->data() + inlen;
+
+    status ret = prepare_query(in, offset, num, false);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    DEVX_SET(query_flow_counter_in, in, dump_to_memory, 1);
+    DEVX_SET(query_flow_counter_in, in, mkey, lkey);
+    DEVX_SET64(query_flow_counter_in, in, address, (uint64_t)addr);
+
+    return batch.query(*this, in, inlen, out, outlen, [buf, cb](status query_ret) {
+        if (cb) {
+            cb(query_ret);
+        }
+    });
+}
+
+void flow_counter_bulk::parse(const void* records, uint32_t num, flow_counter_stats* stats)
+{
+    const uint8_t* record = (const uint8_t*)records;
+
+    for (uint32_t i = 0; i < num; i++) {
+        stats[i].packets = DEVX_GET64(traffic_counter, record, packets);
+        stats[i].bytes = DEVX_GET64(traffic_counter, record, octets);
+        record += DEVX_ST_SZ_BYTES(traffic_counter);
+    }
+}
+
+status flow_counter_bulk::refresh_snapshot()
+{
+    std::lock_guard<std::mutex> guard(m_refresh_lock);
+
+    std::shared_ptr<flow_counter_snapshot> snapshot(new (std::nothrow) flow_counter_snapshot);
+    if (!snapshot) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    status ret = query(0, m_size, snapshot->stats);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    snapshot->timestamp_ms = get_time_ms();
+    std::shared_ptr<const flow_counter_snapshot> prev = std::atomic_load(&m_snapshot);
+    snapshot->generation = prev ? prev->generation + 1 : 1;
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const flow_counter_snapshot>(snapshot));
+    return DPCP_OK;
+}
+
+std::shared_ptr<const flow_counter_snapshot> flow_counter_bulk::get_snapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+} // namespace dpcp
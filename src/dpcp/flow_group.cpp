@@ -29,13 +29,32 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <type_traits>
+#include <unordered_set>
 
 #include "dpcp/internal.h"
 #include "utils/os.h"
 
 namespace dpcp {
 
+// Compact rule handle is the slab slot in low bits and the slot generation in high bits.
+static const uint32_t COMPACT_SLOT_BITS = 24;
+static const uint32_t COMPACT_SLOT_MASK = (1U << COMPACT_SLOT_BITS) - 1;
+// Flow index shards are not split below that many indexes.
+static const uint32_t FLOW_INDEX_MIN_SHARD = 64;
+static const uint32_t FLOW_INDEX_MAX_SHARDS = 64;
+
+// Threads are spread over the index shards round robin by order of their first allocation.
+static uint32_t get_thread_shard_seed()
+{
+    static std::atomic<uint32_t> s_next_seed(0);
+    static thread_local uint32_t s_seed = s_next_seed.fetch_add(1);
+    return s_seed;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // flow_group implementation.                                         //
 ////////////////////////////////////////////////////////////////////////
@@ -90,14 +109,152 @@ status flow_group::remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule)
         return DPCP_ERR_NOT_APPLIED;
     }
 
-    if (m_rules.erase(rule.lock()) != 1) {
-        log_error("Flow rule %p do not exist in this group\n", rule.lock().get());
+    // Last reference is dropped after the lock, HW object is destroyed without it.
+    std::shared_ptr<flow_rule_ex> fr = rule.lock();
+    std::lock_guard<std::mutex> guard(m_rules_lock);
+    if (m_rules.erase(fr) != 1) {
+        log_error("Flow rule %p do not exist in this group\n", fr.get());
         return DPCP_ERR_INVALID_PARAM;
     }
 
     return DPCP_OK;
 }
 
+status flow_group::get_flow_index_stats(flow_index_stats& stats) const
+{
+    NOT_IN_USE(stats);
+    return DPCP_ERR_NO_SUPPORT;
+}
+
+status flow_group::add_flow_rule_compact(const flow_rule_attr_ex& attr, flow_rule_handle& handle)
+{
+    NOT_IN_USE(attr);
+    NOT_IN_USE(handle);
+    return DPCP_ERR_NO_SUPPORT;
+}
+
+status flow_group::remove_flow_rule_compact(flow_rule_handle handle)
+{
+    NOT_IN_USE(handle);
+    return DPCP_ERR_NO_SUPPORT;
+}
+
+status flow_group::get_flow_rule_compact(flow_rule_handle handle, uint32_t& flow_index,
+                                         std::vector<uint8_t>& match) const
+{
+    NOT_IN_USE(handle);
+    NOT_IN_USE(flow_index);
+    NOT_IN_USE(match);
+    return DPCP_ERR_NO_SUPPORT;
+}
+
+bool flow_group::verify_flow_actions(const std::vector<std::shared_ptr<flow_action>>& actions)
+{
+    flow_rule_ex::action_map_t action_map;
+    return flow_rule_ex::verify_flow_actions(actions, action_map);
+}
+
+status flow_group::add_flow_rules(cmd_batch& batch, const flow_rule_attr_ex* attrs, size_t num,
+                                  std::vector<std::weak_ptr<flow_rule_ex>>& rules,
+                                  std::vector<status>& results)
+{
+    rules.assign(num, std::weak_ptr<flow_rule_ex>());
+    results.assign(num, DPCP_OK);
+
+    if (!m_is_initialized) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+    if (!attrs && num) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    // Validate the whole batch before any HW command is issued.
+    status ret = validate_flow_rules(attrs, num, results);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+
+    std::vector<std::shared_ptr<flow_rule_ex>> new_rules(num);
+    for (size_t i = 0; i < num && ret == DPCP_OK; i++) {
+        ret = add_flow_rule(attrs[i], rules[i]);
+        if (ret == DPCP_OK) {
+            new_rules[i] = rules[i].lock();
+            if (!new_rules[i]->m_is_valid_actions) {
+                log_error("Flow rule %zd has not valid actions\n", i);
+                ret = DPCP_ERR_INVALID_PARAM;
+            }
+        }
+        results[i] = ret;
+    }
+    if (ret != DPCP_OK) {
+        for (size_t i = 0; i < num; i++) {
+            if (new_rules[i]) {
+                remove_flow_rule(rules[i]);
+            }
+            rules[i].reset();
+        }
+        return ret;
+    }
+
+    create_flow_rules(batch, new_rules, results);
+
+    // Report partial failure, failed rules are not kept in the group.
+    size_t failed = 0;
+    for (size_t i = 0; i < num; i++) {
+        if (results[i] != DPCP_OK) {
+            if (ret == DPCP_OK) {
+                ret = results[i];
+            }
+            remove_flow_rule(rules[i]);
+            rules[i].reset();
+            failed++;
+        }
+    }
+    log_trace("Flow group added %zd flow rules, %zd failed\n", num - failed, failed);
+
+    return ret;
+}
+
+status flow_group::validate_flow_rules(const flow_rule_attr_ex* attrs, size_t num,
+                                       std::vector<status>& results) const
+{
+    status ret = DPCP_OK;
+
+    for (size_t i = 0; i < num; i++) {
+        for (const auto& action : attrs[i].actions) {
+            if (!action) {
+                log_error("Flow rule %zd has empty flow action\n", i);
+                results[i] = ret = DPCP_ERR_INVALID_PARAM;
+            }
+        }
+    }
+
+    return ret;
+}
+
+void flow_group::create_flow_rules(cmd_batch& batch,
+                                   const std::vector<std::shared_ptr<flow_rule_ex>>& rules,
+                                   std::vector<status>& results)
+{
+    run_flow_rules(
+        batch, rules.size(), [&rules](size_t i) { return rules[i]->create(); }, results);
+}
+
+void flow_group::run_flow_rules(cmd_batch& batch, size_t num,
+                                const std::function<status(size_t)>& fn,
+                                std::vector<status>& results)
+{
+    // Batch keeps up to its depth of rule commands in flight.
+    for (size_t i = 0; i < num; i++) {
+        status ret = batch.submit([&fn, i]() { return fn(i); },
+                                  [&results, i](status st) { results[i] = st; });
+        if (ret != DPCP_OK) {
+            results[i] = ret;
+        }
+    }
+    batch.wait_all();
+}
+
 template <class FR>
 status flow_group::create_flow_rule_ex(const flow_rule_attr_ex& attr,
                                        std::weak_ptr<flow_rule_ex>& rule)
@@ -116,6 +273,7 @@ status flow_group::create_flow_rule_ex(const flow_rule_attr_ex& attr,
         return DPCP_ERR_NO_MEMORY;
     }
 
+    std::lock_guard<std::mutex> guard(m_rules_lock);
     auto ret = m_rules.insert(fr);
     if (!ret.second) {
         log_error("Flow rule placement failed\n");
@@ -134,7 +292,51 @@ flow_group_prm::flow_group_prm(dcmd::ctx* ctx, const flow_group_attr& attr,
                                std::weak_ptr<const flow_table> table)
     : flow_group(ctx, attr, std::move(table))
     , m_group_id()
+    , m_template_lock()
+    , m_fte_templates()
+    , m_template_table()
+    , m_template_refs()
+    , m_free_template_ids()
+    , m_index_shards()
+    , m_shard_size(0)
+    , m_capacity(0)
+    , m_num_used(0)
+    , m_num_auto(0)
+    , m_compact_lock()
+    , m_compact_rules()
+    , m_free_compact_slots()
+    , m_match_bytes()
+    , m_compact_match()
 {
+    if (attr.end_flow_index < attr.start_flow_index) {
+        return;
+    }
+
+    m_capacity = attr.end_flow_index - attr.start_flow_index + 1;
+    uint32_t num_shards = std::max(std::thread::hardware_concurrency(), 1U);
+    num_shards = std::min(num_shards, FLOW_INDEX_MAX_SHARDS);
+    num_shards = std::max(std::min(num_shards, m_capacity / FLOW_INDEX_MIN_SHARD), 1U);
+    m_shard_size = m_capacity / num_shards;
+    for (uint32_t i = 0; i < num_shards; i++) {
+        std::unique_ptr<flow_index_shard> shard(new (std::nothrow) flow_index_shard);
+        if (!shard) {
+            log_error("Flow group index shard allocation failed\n");
+            m_capacity = i * m_shard_size;
+            break;
+        }
+        shard->start = i * m_shard_size;
+        shard->used.resize(i + 1 < num_shards ? m_shard_size : m_capacity - shard->start);
+        shard->next = 0;
+        m_index_shards.push_back(std::move(shard));
+    }
+}
+
+flow_group_prm::~flow_group_prm()
+{
+    // Flow table entries must be destroyed before the group.
+    for (auto& rule : m_compact_rules) {
+        delete rule.fte;
+    }
 }
 
 status flow_group_prm::create()
@@ -156,18 +358,37 @@ status flow_group_prm::create()
         log_error("Flow table is not valid\n");
         return DPCP_ERR_INVALID_PARAM;
     }
+    const adapter_hca_capabilities* caps = prm_table->get_caps();
+    flow_table_type ft_type = flow_table_type::FT_END;
+    if (caps && prm_table->get_table_type(ft_type) == DPCP_OK) {
+        ret = m_matcher->verify_caps(get_flow_table_type_caps(caps, ft_type)->ft_field_support);
+        if (ret != DPCP_OK) {
+            log_error("Flow group match criteria is not supported by the device\n");
+            return ret;
+        }
+    }
 
     // Configure flow group.
     DEVX_SET(create_flow_group_in, in, opcode, MLX5_CMD_OP_CREATE_FLOW_GROUP);
     DEVX_SET(create_flow_group_in, in, table_id, flow_table_id);
     DEVX_SET(create_flow_group_in, in, start_flow_index, m_attr.start_flow_index);
     DEVX_SET(create_flow_group_in, in, end_flow_index, m_attr.end_flow_index);
-    DEVX_SET(create_flow_group_in, in, match_criteria_enable, m_attr.match_criteria_enable);
+    DEVX_SET(create_flow_group_in, in, match_criteria_enable,
+             m_matcher->get_prm_match_criteria_enable());
 
     // Set match criteria to flow group.
     void* match_params = DEVX_ADDR_OF(create_flow_group_in, in, match_criteria);
     m_matcher->apply(match_params, m_attr.match_criteria);
 
+    // Compact rules keep only match value bytes covered by the criteria.
+    const uint8_t* criteria = (const uint8_t*)match_params;
+    m_match_bytes.clear();
+    for (uint16_t i = 0; i < DEVX_ST_SZ_BYTES(fte_match_param); i++) {
+        if (criteria[i]) {
+            m_match_bytes.push_back(i);
+        }
+    }
+
     // Create flow group HW object.
     ret = obj::create(in, sizeof(in), out, outlen);
     if (ret != DPCP_OK) {
@@ -216,7 +437,490 @@ status flow_group_prm::get_table_id(uint32_t& table_id) const
 status flow_group_prm::add_flow_rule(const flow_rule_attr_ex& attr,
                                      std::weak_ptr<flow_rule_ex>& rule)
 {
-    return create_flow_rule_ex<flow_rule_ex_prm>(attr, rule);
+    if (!m_is_initialized) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+
+    uint32_t index = attr.flow_index;
+    bool is_auto = (index == flow_rule_attr_ex::FLOW_INDEX_AUTO);
+    status ret = is_auto ? alloc_flow_index(index) : reserve_flow_index(index);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+
+    ret = create_flow_rule_ex<flow_rule_ex_prm>(attr, rule);
+    if (ret != DPCP_OK) {
+        free_flow_index(index);
+        return ret;
+    }
+    m_num_auto += is_auto;
+
+    // Rule without template is configured field by field on create.
+    std::shared_ptr<flow_rule_ex_prm> prm_rule =
+        std::static_pointer_cast<flow_rule_ex_prm>(rule.lock());
+    prm_rule->m_flow_index = index;
+    prm_rule->m_is_auto_index = is_auto;
+    if (prm_rule->m_is_valid_actions) {
+        prm_rule->m_fte_template = get_fte_template(attr.actions);
+    }
+
+    return DPCP_OK;
+}
+
+status flow_group_prm::remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule)
+{
+    std::shared_ptr<flow_rule_ex_prm> prm_rule =
+        std::static_pointer_cast<flow_rule_ex_prm>(rule.lock());
+
+    status ret = flow_group::remove_flow_rule(rule);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+
+    m_num_auto -= prm_rule->m_is_auto_index;
+    uint32_t flow_index = prm_rule->m_flow_index;
+    // Index is reused only after the entry is destroyed.
+    prm_rule.reset();
+    free_flow_index(flow_index);
+    return DPCP_OK;
+}
+
+status flow_group_prm::get_flow_index_stats(flow_index_stats& stats) const
+{
+    stats.capacity = m_capacity;
+    stats.used = m_num_used;
+    stats.auto_allocated = m_num_auto;
+    return DPCP_OK;
+}
+
+flow_index_shard& flow_group_prm::get_index_shard(uint32_t index) const
+{
+    uint32_t i = (index - m_attr.start_flow_index) / m_shard_size;
+    return *m_index_shards[std::min<size_t>(i, m_index_shards.size() - 1)];
+}
+
+bool flow_group_prm::is_flow_index_used(uint32_t index) const
+{
+    flow_index_shard& shard = get_index_shard(index);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    return shard.used[index - m_attr.start_flow_index - shard.start];
+}
+
+status flow_group_prm::alloc_flow_index(uint32_t& index)
+{
+    // Own shard of the thread first, other shards only when it is full.
+    size_t num_shards = m_index_shards.size();
+    size_t home = num_shards ? get_thread_shard_seed() % num_shards : 0;
+    for (size_t n = 0; n < num_shards; n++) {
+        flow_index_shard& shard = *m_index_shards[(home + n) % num_shards];
+        std::lock_guard<std::mutex> guard(shard.lock);
+
+        // Recycled indexes first, explicit reservations could make some of them stale.
+        uint32_t i = (uint32_t)shard.used.size();
+        while (!shard.free.empty() && i == shard.used.size()) {
+            if (!shard.used[shard.free.back()]) {
+                i = shard.free.back();
+            }
+            shard.free.pop_back();
+        }
+        for (; i == shard.used.size() && shard.next < shard.used.size(); shard.next++) {
+            if (!shard.used[shard.next]) {
+                i = shard.next;
+            }
+        }
+        if (i < shard.used.size()) {
+            shard.used[i] = true;
+            m_num_used++;
+            index = m_attr.start_flow_index + shard.start + i;
+            return DPCP_OK;
+        }
+    }
+
+    log_error("Flow group 0x%x has no free flow index, %u are used\n", m_group_id,
+              m_num_used.load());
+    return DPCP_ERR_OUT_OF_RANGE;
+}
+
+status flow_group_prm::reserve_flow_index(uint32_t index)
+{
+    if (index < m_attr.start_flow_index ||
+        index - m_attr.start_flow_index >= m_capacity) {
+        log_error("Flow index 0x%x is out of group range [0x%x, 0x%x]\n", index,
+                  m_attr.start_flow_index, m_attr.end_flow_index);
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+
+    flow_index_shard& shard = get_index_shard(index);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    uint32_t i = index - m_attr.start_flow_index - shard.start;
+    if (shard.used[i]) {
+        log_error("Flow index 0x%x is used by another rule\n", index);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    shard.used[i] = true;
+    m_num_used++;
+
+    return DPCP_OK;
+}
+
+void flow_group_prm::free_flow_index(uint32_t index)
+{
+    if (index < m_attr.start_flow_index ||
+        index - m_attr.start_flow_index >= m_capacity) {
+        return;
+    }
+
+    flow_index_shard& shard = get_index_shard(index);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    uint32_t i = index - m_attr.start_flow_index - shard.start;
+    if (shard.used[i]) {
+        shard.used[i] = false;
+        m_num_used--;
+        // Never allocated indexes are reached by shard.next.
+        if (i < shard.next) {
+            shard.free.push_back(i);
+        }
+    }
+}
+
+status flow_group_prm::add_flow_rule_compact(const flow_rule_attr_ex& attr,
+                                             flow_rule_handle& handle)
+{
+    if (!m_is_initialized) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+
+    if (!verify_flow_actions(attr.actions)) {
+        log_error("Flow Actions are not valid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    std::shared_ptr<const fte_template> tmpl = get_fte_template(attr.actions);
+    if (!tmpl) {
+        log_error("Flow group 0x%x failed to compile flow actions\n", m_group_id);
+        return DPCP_ERR_NO_MEMORY;
+    }
+
+    uint32_t index = attr.flow_index;
+    bool is_auto = (index == flow_rule_attr_ex::FLOW_INDEX_AUTO);
+    status ret = is_auto ? alloc_flow_index(index) : reserve_flow_index(index);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+
+    // Command buffer is reused by the thread, only flow index and match value differ from
+    // the template.
+    static thread_local std::vector<uint8_t> s_in;
+    s_in.assign(tmpl->in.get(), tmpl->in.get() + tmpl->in_len);
+    for (const auto& action : attr.actions) {
+        if (std::dynamic_pointer_cast<flow_action_counter>(action)) {
+            s_in.resize(s_in.size() + DEVX_ST_SZ_BYTES(dest_format_struct), 0);
+            action->apply(s_in.data());
+        }
+    }
+    void* in = s_in.data();
+    DEVX_SET(set_fte_in, in, flow_index, index);
+    uint8_t* match_value = (uint8_t*)DEVX_ADDR_OF(set_fte_in, in, flow_context.match_value);
+    ret = m_matcher->apply(match_value, attr.match_value);
+    if (ret != DPCP_OK) {
+        log_error("Flow Rule failed to apply match parameters\n");
+        free_flow_index(index);
+        return ret;
+    }
+
+    uint32_t out[DEVX_ST_SZ_DW(set_fte_out)] {0};
+    dcmd::obj_desc desc = {in, s_in.size(), out, sizeof(out)};
+    dcmd::obj* fte = get_ctx()->create_obj(&desc);
+    uint32_t fw_status = DEVX_GET(status_out, out, status);
+    if (!fte || fw_status) {
+        log_error("Flow rule failed to create HW object, status 0x%x syndrome 0x%x\n", fw_status,
+                  DEVX_GET(status_out, out, syndrome));
+        delete fte;
+        free_flow_index(index);
+        return DPCP_ERR_CREATE;
+    }
+
+    // Take a slab slot, the slab only grows.
+    std::unique_lock<std::mutex> lock(m_compact_lock);
+    uint32_t slot = 0;
+    if (!m_free_compact_slots.empty()) {
+        slot = m_free_compact_slots.back();
+        m_free_compact_slots.pop_back();
+    } else if (m_compact_rules.size() <= COMPACT_SLOT_MASK) {
+        slot = (uint32_t)m_compact_rules.size();
+        m_compact_rules.push_back(compact_flow_rule {nullptr, 0, 0, 0, false});
+        m_compact_match.resize(m_compact_match.size() + m_match_bytes.size());
+    } else {
+        lock.unlock();
+        log_error("Flow group 0x%x has no free compact rule slot\n", m_group_id);
+        delete fte;
+        free_flow_index(index);
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+
+    compact_flow_rule& rule = m_compact_rules[slot];
+    rule.fte = fte;
+    rule.flow_index = index;
+    rule.template_id = tmpl->id;
+    rule.is_auto_index = is_auto;
+    uint8_t* packed = m_compact_match.data() + (size_t)slot * m_match_bytes.size();
+    for (size_t i = 0; i < m_match_bytes.size(); i++) {
+        packed[i] = match_value[m_match_bytes[i]];
+    }
+    m_num_auto += is_auto;
+
+    handle = ((uint32_t)rule.generation << COMPACT_SLOT_BITS) | slot;
+    lock.unlock();
+    // Actions of the entry are kept alive by the template.
+    hold_fte_template(tmpl);
+    return DPCP_OK;
+}
+
+status flow_group_prm::remove_flow_rule_compact(flow_rule_handle handle)
+{
+    dcmd::obj* fte = nullptr;
+    uint32_t flow_index = 0;
+    uint16_t template_id = 0;
+    {
+        std::lock_guard<std::mutex> guard(m_compact_lock);
+        uint32_t slot = 0;
+        if (!find_compact_rule(handle, slot)) {
+            log_error("Flow rule handle 0x%x is not valid\n", handle);
+            return DPCP_ERR_INVALID_PARAM;
+        }
+
+        compact_flow_rule& rule = m_compact_rules[slot];
+        fte = rule.fte;
+        flow_index = rule.flow_index;
+        template_id = rule.template_id;
+        m_num_auto -= rule.is_auto_index;
+        rule.fte = nullptr;
+        // Stale copies of the handle are rejected from now on.
+        rule.generation++;
+        m_free_compact_slots.push_back(slot);
+    }
+
+    // Index and actions are released only after the entry is destroyed.
+    delete fte;
+    free_flow_index(flow_index);
+    release_fte_template(template_id);
+
+    return DPCP_OK;
+}
+
+status flow_group_prm::get_flow_rule_compact(flow_rule_handle handle, uint32_t& flow_index,
+                                             std::vector<uint8_t>& match) const
+{
+    std::lock_guard<std::mutex> guard(m_compact_lock);
+    uint32_t slot = 0;
+    if (!find_compact_rule(handle, slot)) {
+        log_error("Flow rule handle 0x%x is not valid\n", handle);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    flow_index = m_compact_rules[slot].flow_index;
+    const uint8_t* packed = m_compact_match.data() + (size_t)slot * m_match_bytes.size();
+    match.assign(packed, packed + m_match_bytes.size());
+
+    return DPCP_OK;
+}
+
+bool flow_group_prm::find_compact_rule(flow_rule_handle handle, uint32_t& slot) const
+{
+    slot = handle & COMPACT_SLOT_MASK;
+    return slot < m_compact_rules.size() && m_compact_rules[slot].fte &&
+        m_compact_rules[slot].generation == (handle >> COMPACT_SLOT_BITS);
+}
+
+std::shared_ptr<const fte_template>
+flow_group_prm::get_fte_template(const std::vector<std::shared_ptr<flow_action>>& actions)
+{
+    // Counter is unique per rule and is applied on top of the template.
+    std::vector<const flow_action*> key;
+    key.reserve(actions.size());
+    for (const auto& action : actions) {
+        if (!std::dynamic_pointer_cast<flow_action_counter>(action)) {
+            key.push_back(action.get());
+        }
+    }
+    std::sort(key.begin(), key.end());
+
+    std::lock_guard<std::mutex> guard(m_template_lock);
+    auto iter = m_fte_templates.find(key);
+    if (iter != m_fte_templates.end()) {
+        std::shared_ptr<const fte_template> tmpl = iter->second.lock();
+        if (tmpl) {
+            return tmpl;
+        }
+    }
+    if (m_free_template_ids.empty() && m_template_table.size() > UINT16_MAX) {
+        return nullptr;
+    }
+
+    std::shared_ptr<const flow_table_prm> prm_table =
+        std::dynamic_pointer_cast<const flow_table_prm>(m_table.lock());
+    flow_table_type ft_type = flow_table_type::FT_END;
+    uint32_t ft_id = 0;
+    if (!prm_table || prm_table->get_table_type(ft_type) != DPCP_OK ||
+        prm_table->get_table_id(ft_id) != DPCP_OK) {
+        log_error("Flow table is not valid\n");
+        return nullptr;
+    }
+
+    // Compile the command once for this set of actions.
+    std::unique_ptr<fte_template> tmpl(new (std::nothrow) fte_template);
+    if (!tmpl) {
+        return nullptr;
+    }
+    size_t dest_list_size = 0;
+    for (const auto& action : actions) {
+        std::shared_ptr<flow_action_fwd> action_fwd =
+            std::dynamic_pointer_cast<flow_action_fwd>(action);
+        if (action_fwd) {
+            dest_list_size = action_fwd->get_dest_num();
+        }
+    }
+    tmpl->in_len =
+        DEVX_ST_SZ_BYTES(set_fte_in) + DEVX_ST_SZ_BYTES(dest_format_struct) * dest_list_size;
+    tmpl->in.reset(new (std::nothrow) uint8_t[tmpl->in_len]);
+    if (!tmpl->in) {
+        log_error("Flow rule in buf memory allocation failed\n");
+        return nullptr;
+    }
+    void* in = tmpl->in.get();
+    memset(in, 0, tmpl->in_len);
+    DEVX_SET(set_fte_in, in, opcode, MLX5_CMD_OP_SET_FLOW_TABLE_ENTRY);
+    DEVX_SET(set_fte_in, in, table_type, ft_type);
+    DEVX_SET(set_fte_in, in, table_id, ft_id);
+    DEVX_SET(set_fte_in, in, flow_context.group_id, m_group_id);
+    for (const auto& action : actions) {
+        if (std::dynamic_pointer_cast<flow_action_counter>(action)) {
+            continue;
+        }
+        if (action->apply(in) != DPCP_OK) {
+            return nullptr;
+        }
+        tmpl->actions.push_back(action);
+    }
+    if (!m_free_template_ids.empty()) {
+        tmpl->id = m_free_template_ids.back();
+        m_free_template_ids.pop_back();
+    } else {
+        tmpl->id = (uint16_t)m_template_table.size();
+        m_template_table.emplace_back();
+        m_template_refs.push_back(0);
+    }
+    tmpl->key = key;
+    log_trace("Flow group 0x%x compiled set_fte template %u for %zd actions\n", m_group_id,
+              tmpl->id, tmpl->actions.size());
+
+    // The last user of the template evicts it from the group.
+    std::weak_ptr<flow_group> weak_group = shared_from_this();
+    std::shared_ptr<const fte_template> shared_tmpl(
+        tmpl.release(), [weak_group](const fte_template* t) {
+            std::shared_ptr<flow_group> group = weak_group.lock();
+            if (group) {
+                std::static_pointer_cast<flow_group_prm>(group)->evict_fte_template(t);
+            }
+            delete t;
+        });
+    m_fte_templates[std::move(key)] = shared_tmpl;
+
+    return shared_tmpl;
+}
+
+void flow_group_prm::evict_fte_template(const fte_template* tmpl)
+{
+    std::lock_guard<std::mutex> guard(m_template_lock);
+    auto iter = m_fte_templates.find(tmpl->key);
+    // The key may already belong to a newer template of the same actions.
+    if (iter != m_fte_templates.end() && iter->second.expired()) {
+        m_fte_templates.erase(iter);
+    }
+    m_free_template_ids.push_back(tmpl->id);
+    log_trace("Flow group 0x%x evicted set_fte template %u\n", m_group_id, tmpl->id);
+}
+
+void flow_group_prm::hold_fte_template(const std::shared_ptr<const fte_template>& tmpl)
+{
+    std::lock_guard<std::mutex> guard(m_template_lock);
+    if (m_template_refs[tmpl->id]++ == 0) {
+        m_template_table[tmpl->id] = tmpl;
+    }
+}
+
+void flow_group_prm::release_fte_template(uint16_t id)
+{
+    std::shared_ptr<const fte_template> last;
+    {
+        std::lock_guard<std::mutex> guard(m_template_lock);
+        if (--m_template_refs[id] == 0) {
+            last.swap(m_template_table[id]);
+        }
+    }
+    // Evicted by the template deleter, m_template_lock is not held here.
+}
+
+status flow_group_prm::validate_flow_rules(const flow_rule_attr_ex* attrs, size_t num,
+                                           std::vector<status>& results) const
+{
+    status ret = flow_group::validate_flow_rules(attrs, num, results);
+
+    // Flow index must be in the group range, free and unique in the batch.
+    std::unordered_set<uint32_t> indexes(num);
+    size_t num_auto = 0;
+    for (size_t i = 0; i < num; i++) {
+        uint32_t index = attrs[i].flow_index;
+        if (index == flow_rule_attr_ex::FLOW_INDEX_AUTO) {
+            num_auto++;
+        } else if (index < m_attr.start_flow_index ||
+                   index - m_attr.start_flow_index >= m_capacity) {
+            log_error("Flow rule %zd index 0x%x is out of group range [0x%x, 0x%x]\n", i, index,
+                      m_attr.start_flow_index, m_attr.end_flow_index);
+            results[i] = ret = DPCP_ERR_OUT_OF_RANGE;
+        } else if (is_flow_index_used(index)) {
+            log_error("Flow rule %zd index 0x%x is used by another rule\n", i, index);
+            results[i] = ret = DPCP_ERR_INVALID_PARAM;
+        } else if (!indexes.insert(index).second) {
+            log_error("Flow rule %zd index 0x%x is used twice in the batch\n", i, index);
+            results[i] = ret = DPCP_ERR_INVALID_PARAM;
+        }
+    }
+    if (num_auto + indexes.size() + m_num_used > m_capacity) {
+        log_error("Flow group has no room for %zd flow rules\n", num);
+        ret = DPCP_ERR_OUT_OF_RANGE;
+    }
+
+    return ret;
+}
+
+void flow_group_prm::create_flow_rules(cmd_batch& batch,
+                                       const std::vector<std::shared_ptr<flow_rule_ex>>& rules,
+                                       std::vector<status>& results)
+{
+    size_t num = rules.size();
+    std::vector<flow_rule_ex_prm*> prm_rules(num);
+    std::vector<size_t> offsets(num + 1, 0);
+
+    // Place command buffers of all rules in one allocation.
+    for (size_t i = 0; i < num; i++) {
+        prm_rules[i] = static_cast<flow_rule_ex_prm*>(rules[i].get());
+        offsets[i + 1] = offsets[i] + prm_rules[i]->get_in_len();
+    }
+    std::unique_ptr<uint8_t[]> in_mem_guard(new (std::nothrow) uint8_t[offsets[num]]);
+    if (!in_mem_guard) {
+        log_error("Flow rules batch in buf memory allocation failed\n");
+        results.assign(num, DPCP_ERR_NO_MEMORY);
+        return;
+    }
+    uint8_t* in = in_mem_guard.get();
+    memset(in, 0, offsets[num]);
+
+    run_flow_rules(
+        batch, num,
+        [&](size_t i) {
+            return prm_rules[i]->create(in + offsets[i], offsets[i + 1] - offsets[i]);
+        },
+        results);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -244,7 +948,53 @@ status flow_group_kernel::create()
 status flow_group_kernel::add_flow_rule(const flow_rule_attr_ex& attr,
                                         std::weak_ptr<flow_rule_ex>& rule)
 {
-    return create_flow_rule_ex<flow_rule_ex_kernel>(attr, rule);
+    status ret = create_flow_rule_ex<flow_rule_ex_kernel>(attr, rule);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+
+    // Rule without shared matcher creates its own one.
+    std::shared_ptr<flow_rule_ex_kernel> kernel_rule =
+        std::static_pointer_cast<flow_rule_ex_kernel>(rule.lock());
+    kernel_rule->m_match_criteria_enable = m_matcher->get_prm_match_criteria_enable();
+    kernel_rule->m_dcmd_matcher = get_dcmd_matcher(attr.priority);
+
+    return DPCP_OK;
+}
+
+std::shared_ptr<dcmd::flow_matcher> flow_group_kernel::get_dcmd_matcher(uint16_t priority)
+{
+    std::lock_guard<std::mutex> guard(m_matchers_lock);
+    std::weak_ptr<dcmd::flow_matcher>& cached = m_dcmd_matchers[priority];
+    std::shared_ptr<dcmd::flow_matcher> matcher = cached.lock();
+    if (matcher) {
+        return matcher;
+    }
+
+    prm_match_params criteria;
+    memset(&criteria, 0, sizeof(criteria));
+    criteria.buf_sz = sizeof(criteria.buf);
+    if (m_matcher->apply(criteria.buf, m_attr.match_criteria) != DPCP_OK) {
+        return nullptr;
+    }
+
+    flow_table_type table_type = flow_table_type::FT_RX;
+    std::shared_ptr<const flow_table> table = m_table.lock();
+    if (!table || table->get_table_type(table_type) != DPCP_OK) {
+        return nullptr;
+    }
+
+    dcmd::flow_desc dcmd_flow;
+    dcmd_flow.priority = priority;
+    dcmd_flow.table_type = (uint8_t)table_type;
+    dcmd_flow.match_criteria_enable = m_matcher->get_prm_match_criteria_enable();
+    dcmd_flow.match_criteria = (dcmd::flow_match_parameters*)&criteria;
+    matcher.reset(get_ctx()->create_flow_matcher(&dcmd_flow));
+    cached = matcher;
+    log_trace("Flow group matcher %p created: priority=%u match_criteria_enable=0x%x\n",
+              matcher.get(), priority, m_attr.match_criteria_enable);
+
+    return matcher;
 }
 
 } // namespace dpcp
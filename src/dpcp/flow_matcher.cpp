@@ -46,81 +46,114 @@ flow_matcher::flow_matcher(const flow_matcher_attr& attr)
 {
 }
 
-status flow_matcher::set_outer_header_lyr_2_fields(void* outer,
-                                                   const match_params_ex& match_value) const
+status flow_matcher::set_header_lyr_2_fields(void* header,
+                                             const match_params_lyr_2& match_crateria_lyr2,
+                                             const match_params_lyr_2& match_value_lyr2) const
 {
-    const match_params_lyr_2& match_crateria_lyr2(m_attr.match_criteria.match_lyr2);
-    const match_params_lyr_2& match_value_lyr2(match_value.match_lyr2);
     uint8_t zero_mac[sizeof(match_crateria_lyr2.dst_mac)] = {0};
 
     if (memcmp(match_crateria_lyr2.dst_mac, zero_mac, sizeof(zero_mac))) {
-        copy_ether_mac((uint8_t*)DEVX_ADDR_OF(fte_match_set_lyr_2_4, outer, dmac_47_16),
+        copy_ether_mac((uint8_t*)DEVX_ADDR_OF(fte_match_set_lyr_2_4, header, dmac_47_16),
                        match_value_lyr2.dst_mac);
     }
     if (memcmp(match_crateria_lyr2.src_mac, zero_mac, sizeof(zero_mac))) {
-        copy_ether_mac((uint8_t*)DEVX_ADDR_OF(fte_match_set_lyr_2_4, outer, smac_47_16),
+        copy_ether_mac((uint8_t*)DEVX_ADDR_OF(fte_match_set_lyr_2_4, header, smac_47_16),
                        match_value_lyr2.src_mac);
     }
     if (match_crateria_lyr2.ethertype) {
-        DEVX_SET(fte_match_set_lyr_2_4, outer, ethertype, match_value_lyr2.ethertype);
+        DEVX_SET(fte_match_set_lyr_2_4, header, ethertype, match_value_lyr2.ethertype);
     }
     if (match_crateria_lyr2.first_vlan_id) {
-        DEVX_SET(fte_match_set_lyr_2_4, outer, first_vid, match_value_lyr2.first_vlan_id);
-        DEVX_SET(fte_match_set_lyr_2_4, outer, cvlan_tag, 0x1);
+        DEVX_SET(fte_match_set_lyr_2_4, header, first_vid, match_value_lyr2.first_vlan_id);
+        DEVX_SET(fte_match_set_lyr_2_4, header, cvlan_tag, 0x1);
     }
 
     return DPCP_OK;
 }
 
-status flow_matcher::set_outer_header_lyr_3_fields(void* outer,
-                                                   const match_params_ex& match_value) const
+status flow_matcher::set_header_lyr_3_fields(void* header,
+                                             const match_params_lyr_3& match_crateria_lyr3,
+                                             const match_params_lyr_3& match_value_lyr3) const
 {
-    const match_params_lyr_3& match_crateria_lyr3(m_attr.match_criteria.match_lyr3);
-    const match_params_lyr_3& match_value_lyr3(match_value.match_lyr3);
+    uint8_t zero_ipv6[sizeof(match_crateria_lyr3.dst_ipv6)] = {0};
+    bool is_dst_ipv6 = memcmp(match_crateria_lyr3.dst_ipv6, zero_ipv6, sizeof(zero_ipv6));
+    bool is_src_ipv6 = memcmp(match_crateria_lyr3.src_ipv6, zero_ipv6, sizeof(zero_ipv6));
+
+    // IPv4 and IPv6 addresses share the same place.
+    if ((is_dst_ipv6 && match_crateria_lyr3.dst_ip) ||
+        (is_src_ipv6 && match_crateria_lyr3.src_ip)) {
+        log_error("Flow matcher can not match IPv4 and IPv6 address together\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
 
     if (match_crateria_lyr3.dst_ip) {
-        DEVX_SET(fte_match_set_lyr_2_4, outer, dst_ipv4_dst_ipv6.ipv4_layout.ipv4,
+        DEVX_SET(fte_match_set_lyr_2_4, header, dst_ipv4_dst_ipv6.ipv4_layout.ipv4,
                  match_value_lyr3.dst_ip);
     }
     if (match_crateria_lyr3.src_ip) {
-        DEVX_SET(fte_match_set_lyr_2_4, outer, src_ipv4_src_ipv6.ipv4_layout.ipv4,
+        DEVX_SET(fte_match_set_lyr_2_4, header, src_ipv4_src_ipv6.ipv4_layout.ipv4,
                  match_value_lyr3.src_ip);
     }
+    if (is_dst_ipv6) {
+        memcpy(DEVX_ADDR_OF(fte_match_set_lyr_2_4, header, dst_ipv4_dst_ipv6.ipv6_layout.ipv6),
+               match_value_lyr3.dst_ipv6, sizeof(match_value_lyr3.dst_ipv6));
+    }
+    if (is_src_ipv6) {
+        memcpy(DEVX_ADDR_OF(fte_match_set_lyr_2_4, header, src_ipv4_src_ipv6.ipv6_layout.ipv6),
+               match_value_lyr3.src_ipv6, sizeof(match_value_lyr3.src_ipv6));
+    }
+    if (match_crateria_lyr3.traffic_class >> 2) {
+        DEVX_SET(fte_match_set_lyr_2_4, header, ip_dscp, match_value_lyr3.traffic_class >> 2);
+    }
+    if (match_crateria_lyr3.traffic_class & 0x3) {
+        DEVX_SET(fte_match_set_lyr_2_4, header, ip_ecn, match_value_lyr3.traffic_class & 0x3);
+    }
     if (match_crateria_lyr3.ip_protocol) {
-        DEVX_SET(fte_match_set_lyr_2_4, outer, ip_protocol, match_value_lyr3.ip_protocol);
+        DEVX_SET(fte_match_set_lyr_2_4, header, ip_protocol, match_value_lyr3.ip_protocol);
     }
     if (match_crateria_lyr3.ip_version) {
-        DEVX_SET(fte_match_set_lyr_2_4, outer, ip_version, match_value_lyr3.ip_version);
+        DEVX_SET(fte_match_set_lyr_2_4, header, ip_version, match_value_lyr3.ip_version);
+    }
+    if (match_crateria_lyr3.ttl) {
+        DEVX_SET(fte_match_set_lyr_2_4, header, ttl_hoplimit, match_value_lyr3.ttl);
+    }
+    if (match_crateria_lyr3.frag) {
+        DEVX_SET(fte_match_set_lyr_2_4, header, frag, match_value_lyr3.frag);
     }
 
     return DPCP_OK;
 }
 
-status flow_matcher::set_outer_header_lyr_4_fields(void* outer,
-                                                   const match_params_ex& match_value) const
+status flow_matcher::set_header_lyr_4_fields(void* header,
+                                             const match_params_lyr_4& match_crateria_lyr4,
+                                             const match_params_lyr_4& match_value_lyr4) const
 {
-    const match_params_lyr_4& match_crateria_lyr4(m_attr.match_criteria.match_lyr4);
-    const match_params_lyr_4& match_value_lyr4(match_value.match_lyr4);
-
     switch (match_crateria_lyr4.type) {
     case match_params_lyr_4_type::NONE:
         break;
     case match_params_lyr_4_type::UDP:
         if (match_crateria_lyr4.dst_port) {
-            DEVX_SET(fte_match_set_lyr_2_4, outer, udp_dport, match_value_lyr4.dst_port);
+            DEVX_SET(fte_match_set_lyr_2_4, header, udp_dport, match_value_lyr4.dst_port);
         }
         if (match_crateria_lyr4.src_port) {
-            DEVX_SET(fte_match_set_lyr_2_4, outer, udp_sport, match_value_lyr4.src_port);
+            DEVX_SET(fte_match_set_lyr_2_4, header, udp_sport, match_value_lyr4.src_port);
         }
         break;
     case match_params_lyr_4_type::TCP:
         if (match_crateria_lyr4.dst_port) {
-            DEVX_SET(fte_match_set_lyr_2_4, outer, tcp_dport, match_value_lyr4.dst_port);
+            DEVX_SET(fte_match_set_lyr_2_4, header, tcp_dport, match_value_lyr4.dst_port);
         }
         if (match_crateria_lyr4.src_port) {
-            DEVX_SET(fte_match_set_lyr_2_4, outer, tcp_sport, match_value_lyr4.src_port);
+            DEVX_SET(fte_match_set_lyr_2_4, header, tcp_sport, match_value_lyr4.src_port);
+        }
+        if (match_crateria_lyr4.tcp_flags) {
+            DEVX_SET(fte_match_set_lyr_2_4, header, tcp_flags, match_value_lyr4.tcp_flags);
         }
         break;
+    case match_params_lyr_4_type::ICMP:
+    case match_params_lyr_4_type::ICMPV6:
+        // ICMP type and code are part of misc parameters 3.
+        break;
     default:
         log_error("Flow matcher layer 4 match params of type %d is not supported\n",
                   match_crateria_lyr4.type);
@@ -130,30 +163,26 @@ status flow_matcher::set_outer_header_lyr_4_fields(void* outer,
     return DPCP_OK;
 }
 
-status flow_matcher::set_outer_header_fields(void* match_params,
-                                             const match_params_ex& match_value) const
+status flow_matcher::set_header_fields(void* header, const match_params_lyr_2& criteria_lyr2,
+                                       const match_params_lyr_3& criteria_lyr3,
+                                       const match_params_lyr_4& criteria_lyr4,
+                                       const match_params_lyr_2& value_lyr2,
+                                       const match_params_lyr_3& value_lyr3,
+                                       const match_params_lyr_4& value_lyr4) const
 {
-    status ret = DPCP_OK;
-    void* outer = DEVX_ADDR_OF(fte_match_param, match_params, outer_headers);
-
-    // Check if match criteria outer header was set.
-    if (!(m_attr.match_criteria_enabled & flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR)) {
-        return DPCP_OK;
-    }
-
-    ret = set_outer_header_lyr_2_fields(outer, match_value);
+    status ret = set_header_lyr_2_fields(header, criteria_lyr2, value_lyr2);
     if (ret != DPCP_OK) {
         log_error("Flow matcher failed to set layer 2 fields, ret %d\n", ret);
         return ret;
     }
 
-    ret = set_outer_header_lyr_3_fields(outer, match_value);
+    ret = set_header_lyr_3_fields(header, criteria_lyr3, value_lyr3);
     if (ret != DPCP_OK) {
         log_error("Flow matcher failed to set layer 3 fields, ret %d\n", ret);
         return ret;
     }
 
-    ret = set_outer_header_lyr_4_fields(outer, match_value);
+    ret = set_header_lyr_4_fields(header, criteria_lyr4, value_lyr4);
     if (ret != DPCP_OK) {
         log_error("Flow matcher failed to set layer 4 fields, ret %d\n", ret);
         return ret;
@@ -162,6 +191,44 @@ status flow_matcher::set_outer_header_fields(void* match_params,
     return DPCP_OK;
 }
 
+status flow_matcher::set_outer_header_fields(void* match_params,
+                                             const match_params_ex& match_value) const
+{
+    const match_params_ex& match_criteria(m_attr.match_criteria);
+    void* outer = DEVX_ADDR_OF(fte_match_param, match_params, outer_headers);
+
+    // Check if match criteria outer header was set.
+    if (!(m_attr.match_criteria_enabled & flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR)) {
+        return DPCP_OK;
+    }
+
+    return set_header_fields(outer, match_criteria.match_lyr2, match_criteria.match_lyr3,
+                             match_criteria.match_lyr4, match_value.match_lyr2,
+                             match_value.match_lyr3, match_value.match_lyr4);
+}
+
+status flow_matcher::set_inner_header_fields(void* match_params,
+                                             const match_params_ex& match_value) const
+{
+    const match_params_ex& match_criteria(m_attr.match_criteria);
+    void* inner = DEVX_ADDR_OF(fte_match_param, match_params, inner_headers);
+
+    // Check if match criteria inner header was set.
+    if (!(m_attr.match_criteria_enabled & flow_group_match_criteria_enable::FG_MATCH_INNER_HDR)) {
+        return DPCP_OK;
+    }
+    if (match_criteria.match_inner_lyr4.type == match_params_lyr_4_type::ICMP ||
+        match_criteria.match_inner_lyr4.type == match_params_lyr_4_type::ICMPV6) {
+        log_error("Flow matcher ICMP match is supported only on outer header\n");
+        return DPCP_ERR_NO_SUPPORT;
+    }
+
+    return set_header_fields(inner, match_criteria.match_inner_lyr2,
+                             match_criteria.match_inner_lyr3, match_criteria.match_inner_lyr4,
+                             match_value.match_inner_lyr2, match_value.match_inner_lyr3,
+                             match_value.match_inner_lyr4);
+}
+
 status flow_matcher::set_prog_sample_fileds(void* match_params,
                                             const match_params_ex& match_value) const
 {
@@ -230,12 +297,182 @@ status flow_matcher::set_prog_sample_fileds(void* match_params,
     return DPCP_OK;
 }
 
+status flow_matcher::set_misc_fields(void* match_params, const match_params_ex& match_value) const
+{
+    const match_params_ex& match_criteria(m_attr.match_criteria);
+    const match_params_tunnel& criteria_tunnel(match_criteria.match_tunnel);
+    const match_params_tunnel& value_tunnel(match_value.match_tunnel);
+    void* misc = DEVX_ADDR_OF(fte_match_param, match_params, misc_parameters);
+
+    // Check if match criteria misc fields was set.
+    if (!(m_attr.match_criteria_enabled & flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS)) {
+        return DPCP_OK;
+    }
+
+    if (match_criteria.match_lyr3.flow_label) {
+        DEVX_SET(fte_match_set_misc, misc, outer_ipv6_flow_label,
+                 match_value.match_lyr3.flow_label);
+    }
+    if (match_criteria.match_lyr2.second_vlan_id) {
+        DEVX_SET(fte_match_set_misc, misc, outer_second_vid,
+                 match_value.match_lyr2.second_vlan_id);
+        DEVX_SET(fte_match_set_misc, misc, outer_second_cvlan_tag, 0x1);
+    }
+    if (match_criteria.match_inner_lyr2.second_vlan_id) {
+        DEVX_SET(fte_match_set_misc, misc, inner_second_vid,
+                 match_value.match_inner_lyr2.second_vlan_id);
+        DEVX_SET(fte_match_set_misc, misc, inner_second_cvlan_tag, 0x1);
+    }
+    if (match_criteria.match_inner_lyr3.flow_label) {
+        DEVX_SET(fte_match_set_misc, misc, inner_ipv6_flow_label,
+                 match_value.match_inner_lyr3.flow_label);
+    }
+    if (criteria_tunnel.vxlan_vni && criteria_tunnel.geneve_vni) {
+        log_error("Flow matcher can not match VXLAN and GENEVE VNI together\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    if (criteria_tunnel.vxlan_vni) {
+        DEVX_SET(fte_match_set_misc, misc, vxlan_vni, value_tunnel.vxlan_vni);
+    }
+    if (criteria_tunnel.geneve_vni) {
+        DEVX_SET(fte_match_set_misc, misc, geneve_vni, value_tunnel.geneve_vni);
+    }
+    if (criteria_tunnel.geneve_oam) {
+        DEVX_SET(fte_match_set_misc, misc, geneve_oam, value_tunnel.geneve_oam);
+    }
+    if (criteria_tunnel.geneve_opt_len) {
+        DEVX_SET(fte_match_set_misc, misc, geneve_opt_len, value_tunnel.geneve_opt_len);
+    }
+    if (criteria_tunnel.geneve_protocol_type) {
+        DEVX_SET(fte_match_set_misc, misc, geneve_protocol_type,
+                 value_tunnel.geneve_protocol_type);
+    }
+
+    return DPCP_OK;
+}
+
+status flow_matcher::set_misc_3_fields(void* match_params,
+                                       const match_params_ex& match_value) const
+{
+    const match_params_lyr_4& criteria_lyr4(m_attr.match_criteria.match_lyr4);
+    const match_params_lyr_4& value_lyr4(match_value.match_lyr4);
+    void* misc3 = DEVX_ADDR_OF(fte_match_param, match_params, misc_parameters_3);
+
+    // Check if match criteria misc 3 fields was set.
+    if (!(m_attr.match_criteria_enabled &
+          flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS_3)) {
+        return DPCP_OK;
+    }
+
+    if (m_attr.match_criteria.match_tunnel.geneve_tlv_option_0_data) {
+        DEVX_SET(fte_match_set_misc3, misc3, geneve_tlv_option_0_data,
+                 match_value.match_tunnel.geneve_tlv_option_0_data);
+    }
+    if (criteria_lyr4.type == match_params_lyr_4_type::ICMP) {
+        if (criteria_lyr4.icmp_type) {
+            DEVX_SET(fte_match_set_misc3, misc3, icmp_type, value_lyr4.icmp_type);
+        }
+        if (criteria_lyr4.icmp_code) {
+            DEVX_SET(fte_match_set_misc3, misc3, icmp_code, value_lyr4.icmp_code);
+        }
+    } else if (criteria_lyr4.type == match_params_lyr_4_type::ICMPV6) {
+        if (criteria_lyr4.icmp_type) {
+            DEVX_SET(fte_match_set_misc3, misc3, icmpv6_type, value_lyr4.icmp_type);
+        }
+        if (criteria_lyr4.icmp_code) {
+            DEVX_SET(fte_match_set_misc3, misc3, icmpv6_code, value_lyr4.icmp_code);
+        }
+    }
+
+    return DPCP_OK;
+}
+
+status flow_matcher::verify_caps(const flow_table_fields_capabilities& caps) const
+{
+    const match_params_ex& criteria(m_attr.match_criteria);
+    uint8_t enabled = m_attr.match_criteria_enabled;
+    bool is_outer = enabled & flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    bool is_inner = enabled & flow_group_match_criteria_enable::FG_MATCH_INNER_HDR;
+    bool is_misc = enabled & flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS;
+    bool is_regs = enabled & flow_group_match_criteria_enable::FG_MATCH_METADATA_REGS;
+    bool is_reg_c_0 =
+        is_regs || (enabled & flow_group_match_criteria_enable::FG_MATCH_METADATA_REG_C_0);
+    bool is_outer_tcp = is_outer && criteria.match_lyr4.type == match_params_lyr_4_type::TCP;
+    bool is_inner_tcp = is_inner && criteria.match_inner_lyr4.type == match_params_lyr_4_type::TCP;
+    const struct {
+        bool is_used;
+        bool is_supported;
+        const char* name;
+    } fields[] = {
+        {is_outer && criteria.match_lyr3.ttl, caps.outer_ipv4_ttl, "outer_ipv4_ttl"},
+        {is_outer && criteria.match_lyr3.frag, caps.outer_frag, "outer_frag"},
+        {is_outer && (criteria.match_lyr3.traffic_class >> 2), caps.outer_ip_dscp, "outer_ip_dscp"},
+        {is_outer && (criteria.match_lyr3.traffic_class & 0x3), caps.outer_ip_ecn, "outer_ip_ecn"},
+        {is_outer_tcp && criteria.match_lyr4.tcp_flags, caps.outer_tcp_flags, "outer_tcp_flags"},
+        {is_misc && criteria.match_lyr2.second_vlan_id, caps.outer_second_vid, "outer_second_vid"},
+        {is_inner && criteria.match_inner_lyr3.ttl, caps.inner_ipv4_ttl, "inner_ipv4_ttl"},
+        {is_inner && criteria.match_inner_lyr3.frag, caps.inner_frag, "inner_frag"},
+        {is_inner && (criteria.match_inner_lyr3.traffic_class >> 2), caps.inner_ip_dscp,
+         "inner_ip_dscp"},
+        {is_inner && (criteria.match_inner_lyr3.traffic_class & 0x3), caps.inner_ip_ecn,
+         "inner_ip_ecn"},
+        {is_inner_tcp && criteria.match_inner_lyr4.tcp_flags, caps.inner_tcp_flags,
+         "inner_tcp_flags"},
+        {is_misc && criteria.match_inner_lyr2.second_vlan_id, caps.inner_second_vid,
+         "inner_second_vid"},
+        {is_reg_c_0 && criteria.match_metadata_reg_c_0, caps.metadata_reg_c_0,
+         "metadata_reg_c_0"},
+        {is_regs && criteria.match_metadata_reg_c_1, caps.metadata_reg_c_1, "metadata_reg_c_1"},
+        {is_regs && criteria.match_metadata_reg_c_2, caps.metadata_reg_c_2, "metadata_reg_c_2"},
+        {is_regs && criteria.match_metadata_reg_c_3, caps.metadata_reg_c_3, "metadata_reg_c_3"},
+        {is_regs && criteria.match_metadata_reg_c_4, caps.metadata_reg_c_4, "metadata_reg_c_4"},
+        {is_regs && criteria.match_metadata_reg_c_5, caps.metadata_reg_c_5, "metadata_reg_c_5"},
+        {is_regs && criteria.match_metadata_reg_c_6, caps.metadata_reg_c_6, "metadata_reg_c_6"},
+        {is_regs && criteria.match_metadata_reg_c_7, caps.metadata_reg_c_7, "metadata_reg_c_7"},
+        {is_regs && criteria.match_metadata_reg_a, caps.metadata_reg_a, "metadata_reg_a"},
+    };
+
+    for (const auto& field : fields) {
+        if (field.is_used && !field.is_supported) {
+            log_error("Flow matcher field %s is not supported\n", field.name);
+            return DPCP_ERR_NO_SUPPORT;
+        }
+    }
+
+    return DPCP_OK;
+}
+
+uint8_t flow_matcher::get_prm_match_criteria_enable() const
+{
+    uint8_t enabled = m_attr.match_criteria_enabled;
+
+    // All metadata registers are in misc parameters 2 enabled by the reg_c_0 bit.
+    if (enabled & flow_group_match_criteria_enable::FG_MATCH_METADATA_REGS) {
+        enabled &= ~flow_group_match_criteria_enable::FG_MATCH_METADATA_REGS;
+        enabled |= flow_group_match_criteria_enable::FG_MATCH_METADATA_REG_C_0;
+    }
+
+    return enabled;
+}
+
 status flow_matcher::apply(void* match_params, const match_params_ex& match_value) const
 {
     status ret = set_outer_header_fields(match_params, match_value);
     if (ret != DPCP_OK) {
         return ret;
     }
+    ret = set_inner_header_fields(match_params, match_value);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+    ret = set_misc_fields(match_params, match_value);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+    ret = set_misc_3_fields(match_params, match_value);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
     ret = set_prog_sample_fileds(match_params, match_value);
     if (ret != DPCP_OK) {
         return ret;
@@ -257,6 +494,10 @@ status flow_matcher::set_metadata_registers_fields(void* match_params,
     if (ret != DPCP_OK) {
         return ret;
     }
+    ret = set_metadata_register_c_fields(metadata_registers, match_value);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
 
     return ret;
 }
@@ -266,7 +507,8 @@ status flow_matcher::set_metadata_register_0_field(void* metadata_registers,
 {
     // Check if match criteria metadata register fields was set.
     if (!(m_attr.match_criteria_enabled &
-          flow_group_match_criteria_enable::FG_MATCH_METADATA_REG_C_0)) {
+          (flow_group_match_criteria_enable::FG_MATCH_METADATA_REG_C_0 |
+           flow_group_match_criteria_enable::FG_MATCH_METADATA_REGS))) {
         return DPCP_OK;
     }
 
@@ -278,4 +520,51 @@ status flow_matcher::set_metadata_register_0_field(void* metadata_registers,
     return DPCP_OK;
 }
 
+status flow_matcher::set_metadata_register_c_fields(void* metadata_registers,
+                                                    const match_params_ex& match_value) const
+{
+    const match_params_ex& match_criteria(m_attr.match_criteria);
+
+    // Check if match criteria metadata register fields was set.
+    if (!(m_attr.match_criteria_enabled &
+          flow_group_match_criteria_enable::FG_MATCH_METADATA_REGS)) {
+        return DPCP_OK;
+    }
+
+    if (match_criteria.match_metadata_reg_c_1) {
+        DEVX_SET(fte_match_set_misc2, metadata_registers, metadata_reg_c_1,
+                 match_value.match_metadata_reg_c_1);
+    }
+    if (match_criteria.match_metadata_reg_c_2) {
+        DEVX_SET(fte_match_set_misc2, metadata_registers, metadata_reg_c_2,
+                 match_value.match_metadata_reg_c_2);
+    }
+    if (match_criteria.match_metadata_reg_c_3) {
+        DEVX_SET(fte_match_set_misc2, metadata_registers, metadata_reg_c_3,
+                 match_value.match_metadata_reg_c_3);
+    }
+    if (match_criteria.match_metadata_reg_c_4) {
+        DEVX_SET(fte_match_set_misc2, metadata_registers, metadata_reg_c_4,
+                 match_value.match_metadata_reg_c_4);
+    }
+    if (match_criteria.match_metadata_reg_c_5) {
+        DEVX_SET(fte_match_set_misc2, metadata_registers, metadata_reg_c_5,
+                 match_value.match_metadata_reg_c_5);
+    }
+    if (match_criteria.match_metadata_reg_c_6) {
+        DEVX_SET(fte_match_set_misc2, metadata_registers, metadata_reg_c_6,
+                 match_value.match_metadata_reg_c_6);
+    }
+    if (match_criteria.match_metadata_reg_c_7) {
+        DEVX_SET(fte_match_set_misc2, metadata_registers, metadata_reg_c_7,
+                 match_value.match_metadata_reg_c_7);
+    }
+    if (match_criteria.match_metadata_reg_a) {
+        DEVX_SET(fte_match_set_misc2, metadata_registers, metadata_reg_a,
+                 match_value.match_metadata_reg_a);
+    }
+
+    return DPCP_OK;
+}
+
 } // namespace dpcp
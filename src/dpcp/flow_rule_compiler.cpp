@@ -0,0 +1,243 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <map>
+#include <string>
+
+#include "dpcp/internal.h"
+#include "utils/os.h"
+
+namespace dpcp {
+
+// Levels of chained tables must fit flow_table_attr::level.
+static const size_t FLOW_PLAN_MAX_LEVEL = UINT8_MAX;
+// Rule commands of the plan kept in flight.
+static const uint32_t FLOW_PLAN_CMD_DEPTH = 8;
+
+/*
+ * Rules with equal keys have the same PRM match criteria and can share a flow group.
+ */
+static status get_mask_key(const flow_rule_spec& rule, std::string& key)
+{
+    flow_matcher_attr matcher_attr;
+    matcher_attr.match_criteria = rule.match_criteria;
+    matcher_attr.match_criteria_enabled = rule.match_criteria_enable;
+    flow_matcher matcher(matcher_attr);
+
+    uint32_t criteria[DEVX_ST_SZ_DW(fte_match_param)] = {0};
+    status ret = matcher.apply(criteria, rule.match_criteria);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+
+    key.assign(1, (char)rule.match_criteria_enable);
+    key.append((const char*)criteria, sizeof(criteria));
+    return DPCP_OK;
+}
+
+static uint8_t get_log_size(uint32_t size)
+{
+    uint8_t log_size = 0;
+    while ((1ULL << log_size) < size) {
+        log_size++;
+    }
+    return log_size;
+}
+
+status flow_rule_compiler::compile(const std::vector<flow_rule_spec>& rules,
+                                   const flow_table_attr& attr, flow_plan& plan)
+{
+    plan.tables.clear();
+    plan.groups.clear();
+
+    if (rules.empty()) {
+        log_error("Flow rule compiler got no rules\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    if (attr.level == 0) {
+        log_error("Flow rule compiler does not place rules to the root table\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    // One table per priority, in lookup order.
+    std::map<uint16_t, std::vector<size_t>> priorities;
+    for (size_t i = 0; i < rules.size(); i++) {
+        priorities[rules[i].priority].push_back(i);
+    }
+    if (attr.level + priorities.size() - 1 > FLOW_PLAN_MAX_LEVEL) {
+        log_error("Flow rule compiler needs %zd levels from level %u\n", priorities.size(),
+                  attr.level);
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+
+    for (const auto& priority : priorities) {
+        size_t table = plan.tables.size();
+        size_t first_group = plan.groups.size();
+
+        // Rules with the same mask share a group, groups keep the order of the rules.
+        std::map<std::string, size_t> masks;
+        for (size_t i : priority.second) {
+            std::string key;
+            status ret = get_mask_key(rules[i], key);
+            if (ret != DPCP_OK) {
+                log_error("Flow rule %zd has invalid match criteria\n", i);
+                plan.tables.clear();
+                plan.groups.clear();
+                return ret;
+            }
+            auto mask = masks.emplace(key, plan.groups.size());
+            if (mask.second) {
+                flow_plan_group group;
+                group.table = table;
+                group.attr.match_criteria_enable = rules[i].match_criteria_enable;
+                group.attr.match_criteria = rules[i].match_criteria;
+                plan.groups.push_back(group);
+            }
+            plan.groups[mask.first->second].rules.push_back(i);
+        }
+
+        // Groups take consecutive index ranges of exactly their size.
+        uint32_t size = 0;
+        for (size_t g = first_group; g < plan.groups.size(); g++) {
+            flow_group_attr& group_attr = plan.groups[g].attr;
+            group_attr.start_flow_index = size;
+            size += (uint32_t)plan.groups[g].rules.size();
+            group_attr.end_flow_index = size - 1;
+        }
+
+        flow_plan_table plan_table;
+        plan_table.attr = attr;
+        plan_table.attr.level = (uint8_t)(attr.level + table);
+        plan_table.attr.log_size = get_log_size(size);
+        plan_table.priority = priority.first;
+        if (table + 1 < priorities.size()) {
+            plan_table.attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_FWD;
+            plan_table.attr.table_miss.reset();
+        }
+        plan.tables.push_back(plan_table);
+    }
+
+    log_trace("Flow rule compiler placed %zd rules to %zd tables and %zd groups\n", rules.size(),
+              plan.tables.size(), plan.groups.size());
+    return DPCP_OK;
+}
+
+status flow_rule_compiler::apply(adapter* ad, const flow_plan& plan,
+                                 const std::vector<flow_rule_spec>& rules, flow_plan_objs& objs)
+{
+    objs = flow_plan_objs();
+
+    if (!ad || plan.tables.empty()) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    for (const auto& group : plan.groups) {
+        if (group.table >= plan.tables.size()) {
+            log_error("Flow plan group refers to table %zd of %zd\n", group.table,
+                      plan.tables.size());
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        for (size_t r : group.rules) {
+            if (r >= rules.size()) {
+                log_error("Flow plan group refers to rule %zd of %zd\n", r, rules.size());
+                return DPCP_ERR_INVALID_PARAM;
+            }
+        }
+    }
+
+    // Chained tables first, a table forwards its miss to an existing one.
+    status ret = DPCP_OK;
+    size_t num_tables = plan.tables.size();
+    objs.tables.resize(num_tables);
+    for (size_t i = num_tables; i-- > 0 && ret == DPCP_OK;) {
+        flow_table_attr attr = plan.tables[i].attr;
+        if (i + 1 < num_tables) {
+            attr.table_miss = objs.tables[i + 1];
+        }
+        ret = ad->create_flow_table(attr, objs.tables[i]);
+        if (ret == DPCP_OK) {
+            ret = objs.tables[i]->create();
+        }
+        if (ret != DPCP_OK) {
+            log_error("Flow plan failed to create table %zd, ret %d\n", i, ret);
+        }
+    }
+
+    cmd_batch* batch = nullptr;
+    if (ret == DPCP_OK) {
+        ret = ad->create_cmd_batch(FLOW_PLAN_CMD_DEPTH, batch);
+    }
+    std::unique_ptr<cmd_batch> batch_guard(batch);
+
+    objs.groups.resize(plan.groups.size());
+    objs.rules.resize(rules.size());
+    for (size_t g = 0; g < plan.groups.size() && ret == DPCP_OK; g++) {
+        const flow_plan_group& group = plan.groups[g];
+        ret = objs.tables[group.table]->add_flow_group(group.attr, objs.groups[g]);
+        if (ret == DPCP_OK) {
+            ret = objs.groups[g].lock()->create();
+        }
+        if (ret != DPCP_OK) {
+            log_error("Flow plan failed to create group %zd, ret %d\n", g, ret);
+            break;
+        }
+
+        std::vector<flow_rule_attr_ex> attrs(group.rules.size());
+        for (size_t k = 0; k < group.rules.size(); k++) {
+            const flow_rule_spec& rule = rules[group.rules[k]];
+            attrs[k].priority = rule.priority;
+            attrs[k].match_value = rule.match_value;
+            attrs[k].flow_index = group.attr.start_flow_index + (uint32_t)k;
+            attrs[k].actions = rule.actions;
+        }
+        std::vector<std::weak_ptr<flow_rule_ex>> group_rules;
+        ret = objs.groups[g].lock()->add_flow_rules(*batch, attrs, group_rules);
+        if (ret != DPCP_OK) {
+            log_error("Flow plan failed to add rules of group %zd, ret %d\n", g, ret);
+            break;
+        }
+        for (size_t k = 0; k < group.rules.size(); k++) {
+            objs.rules[group.rules[k]] = group_rules[k];
+        }
+    }
+
+    // Tables own their groups and rules, nothing is left on failure.
+    if (ret != DPCP_OK) {
+        objs = flow_plan_objs();
+        return ret;
+    }
+
+    log_trace("Flow plan applied: %zd tables, %zd groups, %zd rules\n", num_tables,
+              plan.groups.size(), rules.size());
+    return DPCP_OK;
+}
+
+} // namespace dpcp
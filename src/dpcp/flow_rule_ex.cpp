@@ -34,11 +34,14 @@
 
 namespace dpcp {
 
+const uint32_t flow_rule_attr_ex::FLOW_INDEX_AUTO;
+
 ////////////////////////////////////////////////////////////////////////
 // flow_rule_ex                                                       //
 ////////////////////////////////////////////////////////////////////////
 
-bool flow_rule_ex::verify_flow_actions(const std::vector<std::shared_ptr<flow_action>>& actions)
+bool flow_rule_ex::verify_flow_actions(const std::vector<std::shared_ptr<flow_action>>& actions,
+                                       action_map_t& action_map)
 {
     if (actions.empty()) {
         log_error("No Flow Actions were added to Flow Rule\n");
@@ -53,19 +56,20 @@ bool flow_rule_ex::verify_flow_actions(const std::vector<std::shared_ptr<flow_ac
         // It do not support typeid() as key, so the type_index make wrapper that the hash function
         // can use.
         auto& action_ref = *action.get();
-        m_actions.insert({std::type_index(typeid(action_ref)), action});
+        action_map.insert({std::type_index(typeid(action_ref)), action});
     }
 
-    if (m_actions.size() != actions.size()) {
+    if (action_map.size() != actions.size()) {
         log_error("Flow Action placement failure, could be caused by multiple actions from the "
                   "same type\n");
         return false;
     }
 
-    // Flow rule must have flow action forward.
-    auto action_iter = m_actions.find(std::type_index(typeid(flow_action_fwd)));
-    if (action_iter == m_actions.end()) {
-        log_error("Flow Rule must have Flow Action forward to destination\n");
+    // Flow rule must have flow action forward, or allow on transmit tables.
+    bool has_fwd = action_map.count(std::type_index(typeid(flow_action_fwd)));
+    bool has_allow = action_map.count(std::type_index(typeid(flow_action_allow)));
+    if (has_fwd == has_allow) {
+        log_error("Flow Rule must have either Flow Action forward to destination or allow\n");
         return false;
     }
 
@@ -84,7 +88,7 @@ flow_rule_ex::flow_rule_ex(dcmd::ctx* ctx, const flow_rule_attr_ex& attr,
     , m_is_valid_actions(false)
     , m_matcher(std::move(matcher))
 {
-    m_is_valid_actions = verify_flow_actions(attr.actions);
+    m_is_valid_actions = verify_flow_actions(attr.actions, m_actions);
 }
 
 status flow_rule_ex::get_match_value(match_params_ex& match_val)
@@ -93,6 +97,12 @@ status flow_rule_ex::get_match_value(match_params_ex& match_val)
     return DPCP_OK;
 }
 
+status flow_rule_ex::get_flow_index(uint32_t& index) const
+{
+    NOT_IN_USE(index);
+    return DPCP_ERR_NO_SUPPORT;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // flow_rule_ex_prm                                                   //
 ////////////////////////////////////////////////////////////////////////
@@ -103,10 +113,18 @@ flow_rule_ex_prm::flow_rule_ex_prm(dcmd::ctx* ctx, const flow_rule_attr_ex& attr
                                    std::shared_ptr<const flow_matcher> matcher)
     : flow_rule_ex(ctx, attr, std::move(table), std::move(group), std::move(matcher))
     , m_flow_index(attr.flow_index)
+    , m_is_auto_index(false)
+    , m_fte_template()
+{
+}
+
+status flow_rule_ex_prm::get_flow_index(uint32_t& index) const
 {
+    index = m_flow_index;
+    return DPCP_OK;
 }
 
-status flow_rule_ex_prm::alloc_in_buff(size_t& in_len, std::unique_ptr<uint8_t[]>& in_mem_guard)
+size_t flow_rule_ex_prm::get_in_len() const
 {
     // Get destination list size.
     size_t dest_list_size = 0;
@@ -115,9 +133,19 @@ status flow_rule_ex_prm::alloc_in_buff(size_t& in_len, std::unique_ptr<uint8_t[]
         dest_list_size =
             std::dynamic_pointer_cast<flow_action_fwd>(action_fwd->second)->get_dest_num();
     }
+    // Flow counter entry follows the destinations.
+    if (m_actions.count(std::type_index(typeid(flow_action_counter)))) {
+        dest_list_size++;
+    }
 
+    return DEVX_ST_SZ_BYTES(set_fte_in) + DEVX_ST_SZ_BYTES(dest_format_struct) * dest_list_size;
+}
+
+status flow_rule_ex_prm::alloc_in_buff(size_t& in_len,
+                                       std::unique_ptr<uint8_t[]>& in_mem_guard) const
+{
     // Allocate in buffer.
-    in_len = DEVX_ST_SZ_BYTES(set_fte_in) + DEVX_ST_SZ_BYTES(dest_format_struct) * dest_list_size;
+    in_len = get_in_len();
     in_mem_guard.reset(new (std::nothrow) uint8_t[in_len]);
     if (!in_mem_guard) {
         log_error("Flow rule in buf memory allocation failed\n");
@@ -128,7 +156,7 @@ status flow_rule_ex_prm::alloc_in_buff(size_t& in_len, std::unique_ptr<uint8_t[]
     return DPCP_OK;
 }
 
-status flow_rule_ex_prm::config_flow_rule(void* in)
+status flow_rule_ex_prm::config_flow_rule(void* in) const
 {
     flow_table_type ft_type = flow_table_type::FT_END;
     uint32_t ft_id = 0;
@@ -180,8 +208,6 @@ status flow_rule_ex_prm::create()
     }
 
     // Prepare PRM buffers.
-    uint32_t out[DEVX_ST_SZ_DW(set_fte_out)] {0};
-    size_t outlen = sizeof(out);
     size_t in_len = 0;
     std::unique_ptr<uint8_t[]> in_mem_guard;
     ret = alloc_in_buff(in_len, in_mem_guard);
@@ -189,13 +215,55 @@ status flow_rule_ex_prm::create()
         log_error("Flow Rule buffer allocation failed, ret %d\n", ret);
         return ret;
     }
-    void* in = in_mem_guard.get();
 
-    // configure flow rule attributes.
-    ret = config_flow_rule(in);
-    if (ret != DPCP_OK) {
-        log_error("Flow Rule set configuration failed, ret %d\n", ret);
-        return ret;
+    return create(in_mem_guard.get(), in_len);
+}
+
+status flow_rule_ex_prm::build_in_buff(std::vector<uint8_t>& in, bool use_template) const
+{
+    in.assign(get_in_len(), 0);
+    return prepare_in_buff(in.data(), in.size(), use_template);
+}
+
+status flow_rule_ex_prm::prepare_in_buff(void* in, size_t in_len, bool use_template) const
+{
+    status ret = DPCP_OK;
+    auto action_counter = m_actions.find(std::type_index(typeid(flow_action_counter)));
+    bool has_counter = (action_counter != m_actions.end());
+    size_t counter_len = has_counter ? DEVX_ST_SZ_BYTES(dest_format_struct) : 0;
+
+    if (use_template && m_fte_template && m_fte_template->in_len + counter_len == in_len) {
+        // Precompiled by the group, only flow index, counter and match values differ.
+        memcpy(in, m_fte_template->in.get(), m_fte_template->in_len);
+        DEVX_SET(set_fte_in, in, flow_index, m_flow_index);
+    } else {
+        // configure flow rule attributes.
+        ret = config_flow_rule(in);
+        if (ret != DPCP_OK) {
+            log_error("Flow Rule set configuration failed, ret %d\n", ret);
+            return ret;
+        }
+
+        // Apply flow actions.
+        for (const auto& action : m_actions) {
+            if (has_counter && action.second == action_counter->second) {
+                continue;
+            }
+            ret = action.second->apply(in);
+            if (ret != DPCP_OK) {
+                log_error("Flow rule failed to apply actions\n");
+                return ret;
+            }
+        }
+    }
+
+    // Counter goes after the destinations set by the other actions.
+    if (has_counter) {
+        ret = action_counter->second->apply(in);
+        if (ret != DPCP_OK) {
+            log_error("Flow rule failed to apply counter\n");
+            return ret;
+        }
     }
 
     // Set match values
@@ -206,13 +274,17 @@ status flow_rule_ex_prm::create()
         return ret;
     }
 
-    // Apply flow actions.
-    for (const auto& action : m_actions) {
-        ret = action.second->apply(in);
-        if (ret != DPCP_OK) {
-            log_error("Flow rule failed to apply actions\n");
-            return ret;
-        }
+    return DPCP_OK;
+}
+
+status flow_rule_ex_prm::create(void* in, size_t in_len)
+{
+    uint32_t out[DEVX_ST_SZ_DW(set_fte_out)] {0};
+    size_t outlen = sizeof(out);
+
+    status ret = prepare_in_buff(in, in_len, true);
+    if (ret != DPCP_OK) {
+        return ret;
     }
 
     // Create flow rule HW object.
@@ -230,6 +302,53 @@ status flow_rule_ex_prm::create()
     return ret;
 }
 
+status flow_rule_ex_prm::modify(const std::vector<std::shared_ptr<flow_action>>& actions)
+{
+    if (!m_is_initialized) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+
+    action_map_t new_actions;
+    if (!verify_flow_actions(actions, new_actions)) {
+        log_error("Flow Actions are not valid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    // Template of the group was compiled for the old actions.
+    std::swap(m_actions, new_actions);
+    std::shared_ptr<const fte_template> old_template = std::move(m_fte_template);
+    m_fte_template.reset();
+
+    uint32_t out[DEVX_ST_SZ_DW(set_fte_out)] {0};
+    size_t outlen = sizeof(out);
+    size_t in_len = 0;
+    std::unique_ptr<uint8_t[]> in_mem_guard;
+    status ret = alloc_in_buff(in_len, in_mem_guard);
+    if (ret == DPCP_OK) {
+        ret = prepare_in_buff(in_mem_guard.get(), in_len, true);
+    }
+    if (ret == DPCP_OK) {
+        // Firmware replaces actions, tag, destinations and counters of the entry atomically.
+        void* in = in_mem_guard.get();
+        DEVX_SET(set_fte_in, in, op_mod, MLX5_SET_FTE_OP_MOD_MODIFY);
+        DEVX_SET(set_fte_in, in, modify_enable_mask,
+                 (1 << MLX5_SET_FTE_MODIFY_ENABLE_MASK_ACTION) |
+                     (1 << MLX5_SET_FTE_MODIFY_ENABLE_MASK_FLOW_TAG) |
+                     (1 << MLX5_SET_FTE_MODIFY_ENABLE_MASK_DESTINATION_LIST) |
+                     (1 << MLX5_SET_FTE_MODIFY_ENABLE_MASK_FLOW_COUNTERS));
+        ret = obj::modify(in, in_len, out, outlen);
+    }
+    if (ret != DPCP_OK) {
+        log_error("Flow rule failed to modify actions, ret %d\n", ret);
+        std::swap(m_actions, new_actions);
+        m_fte_template = std::move(old_template);
+        return ret;
+    }
+
+    log_trace("Flow rule modified: %zd actions\n", m_actions.size());
+    return DPCP_OK;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // flow_rule_ex_kernel                                                //
 ////////////////////////////////////////////////////////////////////////
@@ -240,7 +359,9 @@ flow_rule_ex_kernel::flow_rule_ex_kernel(dcmd::ctx* ctx, const flow_rule_attr_ex
                                          std::shared_ptr<const flow_matcher> matcher)
     : flow_rule_ex(ctx, attr, std::move(table), std::move(group), std::move(matcher))
     , m_priority(attr.priority)
+    , m_match_criteria_enable(FG_MATCH_OUTER_HDR)
     , m_flow(nullptr)
+    , m_dcmd_matcher()
 {
 }
 
@@ -281,7 +402,7 @@ status flow_rule_ex_kernel::set_match_params(dcmd::flow_desc& flow_desc, prm_mat
     return DPCP_OK;
 }
 
-status flow_rule_ex_kernel::create()
+status flow_rule_ex_kernel::create_flow(dcmd::flow*& flow)
 {
     status ret = DPCP_OK;
     struct dcmd::flow_desc dcmd_flow;
@@ -293,8 +414,18 @@ status flow_rule_ex_kernel::create()
         return DPCP_ERR_INVALID_PARAM;
     }
 
+    flow_table_type table_type = flow_table_type::FT_RX;
+    std::shared_ptr<const flow_table> table = m_table.lock();
+    if (!table || table->get_table_type(table_type) != DPCP_OK) {
+        log_error("Flow Rule table is not valid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
     // Prepare dcmd flow description.
     dcmd_flow.priority = m_priority;
+    dcmd_flow.table_type = (uint8_t)table_type;
+    dcmd_flow.match_criteria_enable = m_match_criteria_enable;
+    dcmd_flow.matcher = m_dcmd_matcher.get();
 
     // Set Flow Rule match params
     ret = set_match_params(dcmd_flow, mask, values);
@@ -313,8 +444,55 @@ status flow_rule_ex_kernel::create()
     }
 
     // Create dcmd flow object.
-    m_flow = get_ctx()->create_flow(&dcmd_flow);
-    return m_flow ? DPCP_OK : DPCP_ERR_CREATE;
+    flow = get_ctx()->create_flow(&dcmd_flow);
+    return flow ? DPCP_OK : DPCP_ERR_CREATE;
+}
+
+status flow_rule_ex_kernel::create()
+{
+    if (m_flow) {
+        log_warn("Flow rule was already created\n");
+        return DPCP_ERR_CREATE;
+    }
+
+    return create_flow(m_flow);
+}
+
+status flow_rule_ex_kernel::modify(const std::vector<std::shared_ptr<flow_action>>& actions)
+{
+    if (!m_flow) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+
+    action_map_t new_actions;
+    if (!verify_flow_actions(actions, new_actions)) {
+        log_error("Flow Actions are not valid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    // Kernel flows can't be modified, the new flow is created before the old one
+    // is destroyed so packets are not missed.
+    std::swap(m_actions, new_actions);
+    dcmd::flow* flow = nullptr;
+    status ret = create_flow(flow);
+    if (ret != DPCP_OK) {
+        // Kernel may refuse second flow with the same match, replace the flow then.
+        delete m_flow;
+        m_flow = nullptr;
+        ret = create_flow(flow);
+    }
+    if (ret != DPCP_OK) {
+        log_error("Flow rule failed to modify actions, ret %d\n", ret);
+        std::swap(m_actions, new_actions);
+        if (!m_flow && create_flow(m_flow) != DPCP_OK) {
+            log_error("Flow rule failed to restore old actions\n");
+        }
+        return DPCP_ERR_MODIFY;
+    }
+    delete m_flow;
+    m_flow = flow;
+
+    return DPCP_OK;
 }
 
 flow_rule_ex_kernel::~flow_rule_ex_kernel()
@@ -126,10 +126,12 @@ int flow_table::get_fwd_type() const
 ////////////////////////////////////////////////////////////////////////
 
 // Constructor should be used only for DEVX flow tables.
-flow_table_prm::flow_table_prm(dcmd::ctx* ctx, const flow_table_attr& attr)
+flow_table_prm::flow_table_prm(dcmd::ctx* ctx, const flow_table_attr& attr,
+                               const adapter_hca_capabilities* caps)
     : flow_table(ctx, attr.type)
     , m_table_id(0)
     , m_attr(attr)
+    , m_caps(caps)
 {
 }
 
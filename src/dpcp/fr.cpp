@@ -178,6 +178,10 @@ status flow_rule::apply_settings()
         // IP version is dynamic too.
         DEVX_SET(fte_match_set_lyr_2_4, prm_mc, ip_version, m_mask.ip_version);
     }
+    DEVX_SET(fte_match_set_lyr_2_4, prm_mc, ip_dscp, m_mask.traffic_class >> 2);
+    DEVX_SET(fte_match_set_lyr_2_4, prm_mc, ip_ecn, m_mask.traffic_class & 0x3);
+    void* prm_misc_mc = DEVX_ADDR_OF(fte_match_param, &mask.buf, misc_parameters);
+    DEVX_SET(fte_match_set_misc, prm_misc_mc, outer_ipv6_flow_label, m_mask.flow_label);
 
 #if !defined(KERNEL_PRM)
     uint64_t dmac = 0;
@@ -232,6 +236,10 @@ status flow_rule::apply_settings()
         // IP version is dynamic too.
         DEVX_SET(fte_match_set_lyr_2_4, prm_mv, ip_version, m_value.ip_version);
     }
+    DEVX_SET(fte_match_set_lyr_2_4, prm_mv, ip_dscp, m_value.traffic_class >> 2);
+    DEVX_SET(fte_match_set_lyr_2_4, prm_mv, ip_ecn, m_value.traffic_class & 0x3);
+    void* prm_misc_mv = DEVX_ADDR_OF(fte_match_param, &values.buf, misc_parameters);
+    DEVX_SET(fte_match_set_misc, prm_misc_mv, outer_ipv6_flow_label, m_value.flow_label);
 
     if (m_value.protocol != 6U) { // If not TCP(6)
         DEVX_SET(fte_match_set_lyr_2_4, prm_mc, udp_dport, m_mask.dst_port);
@@ -289,6 +297,11 @@ status flow_rule::apply_settings()
     dcmd_flow.match_value = (dcmd::flow_match_parameters*)&values;
     dcmd_flow.priority = m_priority;
     dcmd_flow.flow_id = m_flow_id;
+    if (m_mask.flow_label) {
+        // Flow label is the only misc field of the rule.
+        dcmd_flow.match_criteria_enable |=
+            (1 << MLX5_CREATE_FLOW_GROUP_IN_MATCH_CRITERIA_ENABLE_MISC_PARAMETERS);
+    }
     dcmd_flow.num_dst_obj = m_dst_tir.size();
     // we would need tir objects for Linux and tir ids for Windows which fill in
     // mlx5_ifc_dest_format_struct_bits
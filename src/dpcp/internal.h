@@ -38,6 +38,11 @@
 #include <mutex>
 #include <vector>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <unordered_map>
 #include "dcmd/dcmd.h"
 #include "api/dpcp.h"
 
@@ -45,12 +50,56 @@ namespace dpcp {
 
 // Forward declarations
 class rq;
+class flow_rule_ex_prm;
 
 struct prm_match_params {
     size_t buf_sz;
     uint32_t buf[DEVX_ST_SZ_DW(fte_match_param)];
 };
 
+/**
+ * @brief Returns monotonic time in milliseconds.
+ */
+inline uint64_t get_time_ms()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief Returns capabilities of Flow Tables from the given type.
+ */
+inline const flow_table_type_capabilities*
+get_flow_table_type_caps(const adapter_hca_capabilities* caps, flow_table_type type)
+{
+    return type == flow_table_type::FT_TX ? &caps->flow_table_caps.transmit
+                                          : &caps->flow_table_caps.receive;
+}
+
+/**
+ * @brief class mkey_release_tracker - Last deregistered key of each mkey index
+ *
+ * HW may return the index of a just deregistered mkey again, the tracker
+ * lets create_mkey() pick a variant that differs from the deregistered key.
+ */
+class mkey_release_tracker {
+public:
+    void release(uint32_t key);
+    /**
+     * @brief Marks key as registered
+     *
+     * @retval Returns false if key equals the last deregistered key of its
+     *         index, the key is kept as deregistered then.
+     */
+    bool acquire(uint32_t key);
+    size_t size();
+
+private:
+    std::mutex m_lock;
+    std::unordered_map<uint32_t, uint32_t> m_keys; // mkey index -> deregistered key
+};
+
 class pd : public obj {
 protected:
     uint32_t m_pd_id;
@@ -146,6 +195,72 @@ struct uar_t {
     }
 };
 
+/**
+ * @brief Lock-free LIFO of buffer_pool buffers.
+ *
+ * Head keeps (index + 1) of the top buffer in 32 LSB, 0 means empty, and
+ * a modification tag in 32 MSB to protect from ABA.
+ * Padded to cache line, so per-core stacks do not share lines.
+ */
+class buf_stack {
+public:
+    std::atomic<uint64_t> m_head;
+    std::atomic<uint32_t> m_count;
+    uint8_t m_pad[64 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<uint32_t>)];
+
+    buf_stack()
+        : m_head(0)
+        , m_count(0)
+    {
+    }
+};
+
+/**
+ * @brief class cmd_queue - Worker threads of adapter shared by its cmd_batch objects
+ *
+ * The pool grows up to the largest depth of created batches and is stopped
+ * when the adapter is destroyed.
+ */
+class cmd_queue {
+public:
+    struct cmd {
+        cmd_batch* owner;
+        cmd_fn fn;
+        cmd_cb cb;
+    };
+
+    std::mutex m_lock;
+    std::condition_variable m_cmd_cv; // command queued or stop requested
+    std::condition_variable m_done_cv; // command taken or completed
+    std::deque<cmd> m_cmds;
+    std::vector<std::thread> m_workers;
+    bool m_stop;
+
+    cmd_queue()
+        : m_stop(false)
+    {
+    }
+    ~cmd_queue();
+    status add_workers(uint32_t num);
+    void worker();
+};
+
+/**
+ * @brief class aging_worker - Background sweep thread of flow_aging
+ */
+class aging_worker {
+public:
+    std::mutex m_lock;
+    std::condition_variable m_cv; // stop requested
+    std::thread m_thread;
+    bool m_stop;
+
+    aging_worker()
+        : m_stop(false)
+    {
+    }
+};
+
 typedef std::multimap<const void*, dcmd::uar*> excl_uar_map;
 typedef std::vector<const void*> shar_uar_vec;
 
@@ -285,6 +400,8 @@ public:
  *         chosen.
  */
 class flow_action_reformat : public flow_action {
+    friend class flow_action_generator;
+
 private:
     flow_action_reformat_attr m_attr;
     bool m_is_valid;
@@ -299,8 +416,8 @@ public:
 
 private:
     // Help functions
-    status alloc_reformat_insert_action(std::unique_ptr<uint8_t[]>& in_mem_guard, size_t& in_len,
-                                        flow_action_reformat_attr& attr);
+    static status alloc_reformat_insert_action(std::unique_ptr<uint8_t[]>& in_mem_guard,
+                                               size_t& in_len, flow_action_reformat_attr& attr);
 };
 
 /**
@@ -310,10 +427,13 @@ private:
  *         for the @ref flow_action_modify_type chosen.
  */
 class flow_action_modify : public flow_action {
+    friend class flow_action_generator;
+
 private:
     flow_action_modify_attr m_attr;
     bool m_is_valid;
     uint32_t m_modify_id;
+    std::mutex m_create_lock; /*< rules applying the action from several threads */
     std::unique_ptr<dcmd::modify_action, std::default_delete<dcmd::modify_action[]>> m_actions_root;
     uint32_t m_out[DEVX_ST_SZ_DW(alloc_modify_header_context_out)] {0};
     size_t m_outlen = sizeof(m_out);
@@ -359,6 +479,7 @@ public:
 class flow_action_fwd : public flow_action {
 private:
     std::vector<forwardable_obj*> m_dests;
+    std::mutex m_create_lock; /*< rules applying the action from several threads */
     std::unique_ptr<dcmd::action_fwd> m_root_action_fwd;
 
 public:
@@ -385,6 +506,34 @@ public:
     virtual status apply(dcmd::flow_desc& flow_desc) override;
 };
 
+/**
+ * @brief: Flow action allow, packet leaves transmit steering to the NIC vport.
+ */
+class flow_action_allow : public flow_action {
+public:
+    flow_action_allow(dcmd::ctx* ctx);
+    virtual ~flow_action_allow() = default;
+    virtual status apply(void* in) override;
+    virtual status apply(dcmd::flow_desc& flow_desc) override;
+};
+
+/**
+ * @brief: Flow action counter, counts packets and bytes matched by the rule.
+ *         Counter entry follows forward destinations in the destination list, so the
+ *         action is applied after all other actions of the rule.
+ */
+class flow_action_counter : public flow_action {
+private:
+    uint32_t m_counter_id;
+
+public:
+    flow_action_counter(dcmd::ctx* ctx, uint32_t counter_id);
+    virtual ~flow_action_counter() = default;
+    virtual status apply(void* in) override;
+    virtual status apply(dcmd::flow_desc& flow_desc) override;
+    virtual status get_id(uint32_t& id) override;
+};
+
 /**
  * @brief: Flow matcher attributes
  */
@@ -418,18 +567,46 @@ public:
      * @param [out] match_params: PRM match params buffer @ref mlx5_ifc_fte_match_param_bits.
      */
     status apply(void* match_params, const match_params_ex& match_value) const;
+    /**
+     * @brief: Check that fields used by the match criteria are supported by the device.
+     *
+     * @param [in] caps: supported fields of the flow table type.
+     *
+     * @retval Returns DPCP_OK on success, DPCP_ERR_NO_SUPPORT if a field is not supported.
+     */
+    status verify_caps(const flow_table_fields_capabilities& caps) const;
+    /**
+     * @brief: Get match criteria enable flags in the layout expected by the device.
+     *
+     * @retval Returns the enable flags with library only flags translated to PRM bits.
+     */
+    uint8_t get_prm_match_criteria_enable() const;
 
 private:
     // help functions
     status set_prog_sample_fileds(void* match_params, const match_params_ex& match_value) const;
     status set_outer_header_fields(void* match_params, const match_params_ex& match_value) const;
-    status set_outer_header_lyr_4_fields(void* outer, const match_params_ex& match_value) const;
-    status set_outer_header_lyr_3_fields(void* outer, const match_params_ex& match_value) const;
-    status set_outer_header_lyr_2_fields(void* outer, const match_params_ex& match_value) const;
+    status set_inner_header_fields(void* match_params, const match_params_ex& match_value) const;
+    status set_header_fields(void* header, const match_params_lyr_2& criteria_lyr2,
+                             const match_params_lyr_3& criteria_lyr3,
+                             const match_params_lyr_4& criteria_lyr4,
+                             const match_params_lyr_2& value_lyr2,
+                             const match_params_lyr_3& value_lyr3,
+                             const match_params_lyr_4& value_lyr4) const;
+    status set_header_lyr_4_fields(void* header, const match_params_lyr_4& match_crateria_lyr4,
+                                   const match_params_lyr_4& match_value_lyr4) const;
+    status set_header_lyr_3_fields(void* header, const match_params_lyr_3& match_crateria_lyr3,
+                                   const match_params_lyr_3& match_value_lyr3) const;
+    status set_header_lyr_2_fields(void* header, const match_params_lyr_2& match_crateria_lyr2,
+                                   const match_params_lyr_2& match_value_lyr2) const;
+    status set_misc_fields(void* match_params, const match_params_ex& match_value) const;
+    status set_misc_3_fields(void* match_params, const match_params_ex& match_value) const;
     status set_metadata_registers_fields(void* match_params,
                                          const match_params_ex& match_value) const;
     status set_metadata_register_0_field(void* metadata_registers,
                                          const match_params_ex& match_value) const;
+    status set_metadata_register_c_fields(void* metadata_registers,
+                                          const match_params_ex& match_value) const;
 };
 
 /**
@@ -441,11 +618,16 @@ class flow_table_prm : public flow_table {
 private:
     uint32_t m_table_id;
     flow_table_attr m_attr;
+    const adapter_hca_capabilities* m_caps; /*< used to verify flow group match criteria */
 
 public:
     virtual status create() override;
     virtual status query(flow_table_attr& attr) override;
     status get_table_id(uint32_t& table_id) const;
+    const adapter_hca_capabilities* get_caps() const
+    {
+        return m_caps;
+    }
     virtual status get_table_level(uint8_t& table_level) const override;
     virtual status add_flow_group(const flow_group_attr& attr,
                                   std::weak_ptr<flow_group>& group) override;
@@ -456,7 +638,8 @@ private:
      * @brief flow_table_kernel - constructor is private should be called only from
      *        @ref adapter::create_flow_table.
      */
-    flow_table_prm(dcmd::ctx* ctx, const flow_table_attr& attr);
+    flow_table_prm(dcmd::ctx* ctx, const flow_table_attr& attr,
+                   const adapter_hca_capabilities* caps);
     status set_miss_action(void* in);
 };
 
@@ -489,19 +672,85 @@ private:
     flow_table_kernel(dcmd::ctx* ctx, flow_table_type type);
 };
 
+/**
+ * @brief SET_FLOW_TABLE_ENTRY command of a flow group precompiled for one set of
+ *        flow actions, every field except flow index, flow counter and match value is set.
+ */
+struct fte_template {
+    std::vector<std::shared_ptr<flow_action>> actions; /*< keep the key pointers valid */
+    std::vector<const flow_action*> key; /*< key in the group templates map */
+    std::unique_ptr<uint8_t[]> in;
+    size_t in_len;
+    uint16_t id; /*< index in the group templates table */
+};
+
+/**
+ * @brief Flow rule kept by a flow group in compact form, see
+ *        @ref flow_group::add_flow_rule_compact.
+ */
+struct compact_flow_rule {
+    dcmd::obj* fte; /*< nullptr for a free slot */
+    uint32_t flow_index;
+    uint16_t template_id;
+    uint8_t generation; /*< bumped on every release of the slot */
+    bool is_auto_index;
+};
+
+/**
+ * @brief Part of flow group index range with its own lock, threads allocate flow indexes
+ *        from different shards, see @ref flow_group_prm::alloc_flow_index.
+ */
+struct flow_index_shard {
+    std::mutex lock;
+    uint32_t start; /*< first index of the shard, relative to the group range */
+    std::vector<bool> used; /*< index start + i is bit i */
+    std::vector<uint32_t> free; /*< recycled, may hold stale used entries */
+    uint32_t next; /*< all indexes from here are never allocated */
+};
+
 class flow_group_prm : public flow_group {
     friend class flow_table;
 
 private:
+    typedef std::map<std::vector<const flow_action*>, std::weak_ptr<const fte_template>>
+        fte_template_map_t;
+
     uint32_t m_group_id;
+    // Templates are owned by the rules using them and evicted with the last one,
+    // so the group does not keep flow actions alive.
+    std::mutex m_template_lock; /*< protects templates */
+    fte_template_map_t m_fte_templates;
+    std::vector<std::shared_ptr<const fte_template>> m_template_table; /*< used by compact rules */
+    std::vector<uint32_t> m_template_refs; /*< compact rules per template id */
+    std::vector<uint16_t> m_free_template_ids;
+    // Flow index allocator, group range is split to shards of m_shard_size indexes,
+    // the last shard takes the remainder.
+    std::vector<std::unique_ptr<flow_index_shard>> m_index_shards;
+    uint32_t m_shard_size;
+    uint32_t m_capacity;
+    std::atomic<uint32_t> m_num_used;
+    std::atomic<uint32_t> m_num_auto;
+    // Compact rules slab, match values are packed to the bytes set in the group mask.
+    mutable std::mutex m_compact_lock; /*< protects the slab */
+    std::vector<compact_flow_rule> m_compact_rules;
+    std::vector<uint32_t> m_free_compact_slots;
+    std::vector<uint16_t> m_match_bytes; /*< offsets of masked bytes in fte_match_param */
+    std::vector<uint8_t> m_compact_match; /*< m_match_bytes.size() bytes per slot */
 
 public:
     virtual status create() override;
     virtual status add_flow_rule(const flow_rule_attr_ex& attr,
                                  std::weak_ptr<flow_rule_ex>& rule) override;
+    virtual status remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule) override;
+    virtual status get_flow_index_stats(flow_index_stats& stats) const override;
+    virtual status add_flow_rule_compact(const flow_rule_attr_ex& attr,
+                                         flow_rule_handle& handle) override;
+    virtual status remove_flow_rule_compact(flow_rule_handle handle) override;
+    virtual status get_flow_rule_compact(flow_rule_handle handle, uint32_t& flow_index,
+                                         std::vector<uint8_t>& match) const override;
     status get_group_id(uint32_t& group_id) const;
     status get_table_id(uint32_t& table_id) const;
-    virtual ~flow_group_prm() = default;
+    virtual ~flow_group_prm();
 
 private:
     /**
@@ -510,11 +759,36 @@ private:
      */
     flow_group_prm(dcmd::ctx* ctx, const flow_group_attr& attr,
                    std::weak_ptr<const flow_table> table);
+
+    // Help functions
+    std::shared_ptr<const fte_template>
+    get_fte_template(const std::vector<std::shared_ptr<flow_action>>& actions);
+    void evict_fte_template(const fte_template* tmpl);
+    void hold_fte_template(const std::shared_ptr<const fte_template>& tmpl);
+    void release_fte_template(uint16_t id);
+    bool find_compact_rule(flow_rule_handle handle, uint32_t& slot) const;
+    flow_index_shard& get_index_shard(uint32_t index) const;
+    bool is_flow_index_used(uint32_t index) const;
+    status alloc_flow_index(uint32_t& index);
+    status reserve_flow_index(uint32_t index);
+    void free_flow_index(uint32_t index);
+
+protected:
+    virtual status validate_flow_rules(const flow_rule_attr_ex* attrs, size_t num,
+                                       std::vector<status>& results) const override;
+    virtual void create_flow_rules(cmd_batch& batch,
+                                   const std::vector<std::shared_ptr<flow_rule_ex>>& rules,
+                                   std::vector<status>& results) override;
 };
 
 class flow_group_kernel : public flow_group {
     friend class flow_table;
 
+private:
+    // Rules of the group share the mask, one matcher per priority is enough.
+    std::mutex m_matchers_lock;
+    std::map<uint16_t, std::weak_ptr<dcmd::flow_matcher>> m_dcmd_matchers;
+
 public:
     virtual status create() override;
     virtual status add_flow_rule(const flow_rule_attr_ex& attr,
@@ -528,16 +802,34 @@ private:
      */
     flow_group_kernel(dcmd::ctx* ctx, const flow_group_attr& attr,
                       std::weak_ptr<const flow_table> table);
+
+    // Help functions
+    std::shared_ptr<dcmd::flow_matcher> get_dcmd_matcher(uint16_t priority);
 };
 
 class flow_rule_ex_prm : public flow_rule_ex {
     friend class flow_group;
+    friend class flow_group_prm;
 
 private:
     uint32_t m_flow_index;
+    bool m_is_auto_index;
+    std::shared_ptr<const fte_template> m_fte_template;
 
 public:
     virtual status create() override;
+    virtual status modify(const std::vector<std::shared_ptr<flow_action>>& actions) override;
+    virtual status get_flow_index(uint32_t& index) const override;
+    /**
+     * @brief Build SET_FLOW_TABLE_ENTRY command of the rule.
+     *
+     * @param [out] in: command buffer.
+     * @param [in] use_template: copy precompiled fields from the group template when the
+     *             rule has one, otherwise configure them field by field.
+     *
+     * @retval Returns @ref dpcp::status with the status code.
+     */
+    status build_in_buff(std::vector<uint8_t>& in, bool use_template) const;
     virtual ~flow_rule_ex_prm() = default;
 
 private:
@@ -550,19 +842,26 @@ private:
                      std::shared_ptr<const flow_matcher> matcher);
 
     // Help functions.
-    status alloc_in_buff(size_t& in_len, std::unique_ptr<uint8_t[]>& in_mem_guard);
-    status config_flow_rule(void* in);
+    size_t get_in_len() const;
+    status alloc_in_buff(size_t& in_len, std::unique_ptr<uint8_t[]>& in_mem_guard) const;
+    status config_flow_rule(void* in) const;
+    status prepare_in_buff(void* in, size_t in_len, bool use_template) const;
+    status create(void* in, size_t in_len);
 };
 
 class flow_rule_ex_kernel : public flow_rule_ex {
     friend class flow_group;
+    friend class flow_group_kernel;
 
 private:
     uint16_t m_priority;
+    uint8_t m_match_criteria_enable;
     dcmd::flow* m_flow;
+    std::shared_ptr<dcmd::flow_matcher> m_dcmd_matcher; /*< must outlive m_flow */
 
 public:
     virtual status create() override;
+    virtual status modify(const std::vector<std::shared_ptr<flow_action>>& actions) override;
     virtual ~flow_rule_ex_kernel();
 
 private:
@@ -578,6 +877,7 @@ private:
     // Help functions
     status set_match_params(dcmd::flow_desc& flow_desc, prm_match_params& criteria,
                             prm_match_params& values);
+    status create_flow(dcmd::flow*& flow);
 };
 
 } // namespace dpcp
@@ -34,6 +34,8 @@
 #endif
 
 #include <atomic>
+#include <system_error>
+#include <thread>
 
 #include "utils/os.h"
 #include "dpcp/internal.h"
@@ -46,6 +48,62 @@ namespace dpcp {
 
 static std::atomic<int> g_mkey_cnt;
 
+// Number of variants a thread takes from g_mkey_cnt at once
+static const int MKEY_VARIANT_BATCH = 16;
+static mkey_release_tracker g_mkey_released;
+
+/**
+ * @brief Returns next 8 bit mkey variant
+ *
+ * Each thread takes a block of variants by one relaxed fetch_add, so mkey
+ * creation does not contend on the global counter.
+ */
+static uint8_t alloc_mkey_variant()
+{
+    static thread_local uint32_t t_next = 0;
+    static thread_local uint32_t t_left = 0;
+
+    if (0 == t_left) {
+        t_next = (uint32_t)g_mkey_cnt.fetch_add(MKEY_VARIANT_BATCH, std::memory_order_relaxed);
+        t_left = MKEY_VARIANT_BATCH;
+    }
+    t_left--;
+    return (uint8_t)(t_next++ & 0xFF);
+}
+
+void mkey_release_tracker::release(uint32_t key)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_keys[key >> 8] = key;
+}
+
+bool mkey_release_tracker::acquire(uint32_t key)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto it = m_keys.find(key >> 8);
+    if (it != m_keys.end()) {
+        if (it->second == key) {
+            return false;
+        }
+        // Index is registered again, its previous key is of no interest
+        m_keys.erase(it);
+    }
+    return true;
+}
+
+size_t mkey_release_tracker::size()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_keys.size();
+}
+
+static void set_mkc_relaxed_ordering(void* p_mkeyc, uint32_t flags)
+{
+    // Allow HCA to issue PCIe transactions with Relaxed Ordering attribute
+    DEVX_SET(mkc, p_mkeyc, relaxed_ordering_write, !!(flags & MKEY_RELAXED_ORDERING_WRITE));
+    DEVX_SET(mkc, p_mkeyc, relaxed_ordering_read, !!(flags & MKEY_RELAXED_ORDERING_READ));
+}
+
 /*static*/
 void mkey::init_mkeys(void)
 {
@@ -62,6 +120,43 @@ status mkey::get_mkey_num(int& num)
     return DPCP_OK;
 }
 
+status mkey::create_mkey(void* in, size_t in_sz, void* out, size_t& out_sz, uint32_t& key)
+{
+    void* p_mkeyc = DEVX_ADDR_OF(create_mkey_in, in, memory_key_mkey_entry);
+    status ret = DPCP_ERR_CREATE;
+
+    // The second attempt gets a different variant, so it can't repeat the
+    // released key even if HW returns the same mkey index again.
+    for (int i = 0; i < 2; i++) {
+        // SW managed ID that comes to reduce a chance were a wrong key is used
+        // due to mkey index reuse (SW reuses mkey)
+        uint8_t variant = alloc_mkey_variant();
+        DEVX_SET(mkc, p_mkeyc, mkey_7_0, variant);
+        ret = obj::create(in, in_sz, out, out_sz);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        // 3 Bytes of the mkey index. Mkey index equals to 24 MSBs of the 32 bits
+        // mkey. The rest 8 LSB of the mkey are the variant part of the mkey.
+        key = (DEVX_GET(create_mkey_out, out, mkey_index) << 8) | variant;
+        if (g_mkey_released.acquire(key)) {
+            break;
+        }
+        log_trace("mkey 0x%x was just deregistered, recreate with a new variant\n", key);
+        obj::destroy();
+    }
+    m_devx_key = key;
+    return ret;
+}
+
+mkey::~mkey()
+{
+    // Variant of the key is free for reuse only after deregistration
+    if (m_devx_key) {
+        g_mkey_released.release(m_devx_key);
+    }
+}
+
 direct_mkey::direct_mkey(adapter* ad, void* address, size_t length, mkey_flags flags)
     : mkey(ad->get_ctx())
     , m_adapter(ad)
@@ -153,7 +248,11 @@ status direct_mkey::reg_mem(void* verbs_pd)
     if (verbs_pd) {
         uint32_t access = ctx->ibv_get_access_flags();
         struct ibv_mr* ibv_mem = nullptr;
-        if (MKEY_ZERO_BASED == m_flags) {
+        if (m_flags & MKEY_RELAXED_ORDERING) {
+            // Verbs enable both read and write relaxed ordering as supported by HCA
+            access |= ctx->ibv_get_relaxed_ordering_flags();
+        }
+        if (m_flags & MKEY_ZERO_BASED) {
             // MKEY_ZERO_BASE is broken in ibv_reg_mr() so using ibv_reg_mr_iova() instead.
             access |= IBV_ACCESS_ZERO_BASED;
             size_t page_sz = get_page_size();
@@ -209,23 +308,12 @@ status direct_mkey::create()
     DEVX_SET(mkc, p_mkeyc, lw, 0x1);
     // Allow local read access
     DEVX_SET(mkc, p_mkeyc, lr, 0x1);
+    set_mkc_relaxed_ordering(p_mkeyc, m_flags);
     // 2 LSB of the access mode, shall be set to 0x1 (MTT)
     DEVX_SET(mkc, p_mkeyc, access_mode_1_0, 0x1);
     // QPN this mkey is attached to.
     // When no QPN is attached must be set to 0xffffff.
     DEVX_SET(mkc, p_mkeyc, qpn, 0xffffff);
-    // Obtain next Mkey counter from static value
-    int mkey_cnt = g_mkey_cnt.load();
-    while (!g_mkey_cnt.compare_exchange_strong(mkey_cnt, mkey_cnt + 1, std::memory_order_seq_cst) &&
-           (mkey_cnt < g_mkey_cnt))
-        ;
-    // mkey_cnt now include incremented unique value
-    //
-    // SW managed ID that comes to reduce a chance were a wrong key is used due to
-    // mkey
-    // index reuse (SW reuses mkey)
-    DEVX_SET(mkc, p_mkeyc, mkey_7_0, mkey_cnt % 0xFF);
-    log_trace("create mkey_cnt %u\n", mkey_cnt);
     // Protection Domain
     DEVX_SET(mkc, p_mkeyc, pd, id);
     // Memory region address
@@ -242,19 +330,8 @@ status direct_mkey::create()
     DEVX_SET(create_mkey_in, in, mkey_umem_id, umem_id);
 
     DEVX_SET(create_mkey_in, in, opcode, MLX5_CMD_OP_CREATE_MKEY);
-    status ret = obj::create(in, sizeof(in), out, outlen);
-    if (DPCP_OK != ret) {
-        return ret;
-    }
-    // 3 Bytes of the mkey index. Mkey index equals to 24 MSBs of the 32 bits
-    // mkey.
-    // The rest 8 LSB of the mkey are the variant part of the mkey, which is
-    // selected
-    // by the SW and set via Mkey Context.mkey_7_0
-    //
-    m_idx = DEVX_GET(create_mkey_out, out, mkey_index) << 8;
-    m_idx |= (mkey_cnt % 0xFF);
-    log_trace("mkey_cnt: %d mkey_idx: 0x%x\n", mkey_cnt, m_idx);
+    status ret = create_mkey(in, sizeof(in), out, outlen, m_idx);
+    log_trace("mkey_idx: 0x%x ret: %d\n", m_idx, ret);
     return ret;
 }
 
@@ -387,22 +464,12 @@ status pattern_mkey::create()
     DEVX_SET(mkc, p_mkeyc, lw, 0x1);
     // Allow local read access
     DEVX_SET(mkc, p_mkeyc, lr, 0x1);
+    set_mkc_relaxed_ordering(p_mkeyc, m_flags);
     // 2 LSB of the access mode, shall be set to 0x2 (KLM - indirect access)
     DEVX_SET(mkc, p_mkeyc, access_mode_1_0, 0x2);
     // QPN this mkey is attached to.
     // When no QPN is attached must be set to 0xffffff.
     DEVX_SET(mkc, p_mkeyc, qpn, 0xffffff);
-    // Obtain next Mkey counter from static value
-    int mkey_cnt = g_mkey_cnt.load();
-    while (!g_mkey_cnt.compare_exchange_strong(mkey_cnt, mkey_cnt + 1, std::memory_order_seq_cst) &&
-           (mkey_cnt < g_mkey_cnt))
-        ;
-    // mkey_cnt now include incremented unique value
-    //
-    // SW managed ID that comes to reduce a chance were a wrong key is used due to
-    // mkey index reuse (SW reuses mkey)
-    DEVX_SET(mkc, p_mkeyc, mkey_7_0, mkey_cnt % 0xFF);
-    log_trace("create mkey_cnt %u\n", mkey_cnt);
     // Protection Domain
     uint32_t id = m_adapter->get_pd();
     if (0 == id) {
@@ -470,23 +537,265 @@ status pattern_mkey::create()
     }
     // send command
     DEVX_SET(create_mkey_in, in, opcode, MLX5_CMD_OP_CREATE_MKEY);
-    ret = obj::create(in, inlen, out, outlen);
+    ret = create_mkey(in, inlen, out, outlen, m_idx);
+    log_trace("mkey_idx: 0x%x ret: %d\n", m_idx, ret);
+    delete[] in;
+    return ret;
+}
+
+const size_t chunked_mkey::DEFAULT_CHUNK_SZ;
+const size_t chunked_mkey::MAX_CHUNK_SZ;
+
+chunked_mkey::chunked_mkey(adapter* ad, void* address, size_t length, mkey_flags flags,
+                           const chunked_mkey_attr& attr)
+    : indirect_mkey(ad)
+    , m_adapter(ad)
+    , m_address(address)
+    , m_length(length)
+    , m_flags(flags)
+    , m_attr(attr)
+    , m_chunks()
+    , m_idx(0)
+{
+    size_t page_sz = get_page_size();
+    size_t chunk_sz = m_attr.chunk_sz ? m_attr.chunk_sz : DEFAULT_CHUNK_SZ;
+    if (chunk_sz > MAX_CHUNK_SZ) {
+        chunk_sz = MAX_CHUNK_SZ;
+    }
+    m_attr.chunk_sz = ((chunk_sz + page_sz - 1) / page_sz) * page_sz;
+    if (0 == m_attr.workers_num) {
+        m_attr.workers_num = std::thread::hardware_concurrency();
+    }
+    log_trace("CTR chunked mkey: adapter %p addr %p len %zd chunk_sz %zd workers %u\n", m_adapter,
+              m_address, m_length, m_attr.chunk_sz, m_attr.workers_num);
+}
+
+chunked_mkey::~chunked_mkey()
+{
+    // Indirect key has to be released before keys it points to.
+    obj::destroy();
+    for (mkey* chunk : m_chunks) {
+        delete chunk;
+    }
+}
+
+status chunked_mkey::reg_chunks(void* verbs_pd, size_t first, size_t step)
+{
+    uintptr_t start = (uintptr_t)m_address;
+    uintptr_t end = start + m_length;
+
+    for (size_t i = first; i < m_chunks.size(); i += step) {
+        // Chunk boundaries are aligned to chunk size, except region edges.
+        uintptr_t chunk_start = (start / m_attr.chunk_sz + i) * m_attr.chunk_sz;
+        uintptr_t chunk_end = chunk_start + m_attr.chunk_sz;
+        chunk_start = (chunk_start < start) ? start : chunk_start;
+        chunk_end = (chunk_end > end) ? end : chunk_end;
+
+        if (m_attr.flags & CHUNKED_MKEY_PREFAULT) {
+            prefault_mem((void*)chunk_start, chunk_end - chunk_start);
+        }
+
+        direct_mkey* chunk =
+            new (std::nothrow) direct_mkey(m_adapter, (void*)chunk_start, chunk_end - chunk_start,
+                                           (mkey_flags)(m_flags & MKEY_RELAXED_ORDERING));
+        if (nullptr == chunk) {
+            return DPCP_ERR_NO_MEMORY;
+        }
+        status ret = chunk->reg_mem(verbs_pd);
+        if (DPCP_OK == ret) {
+            ret = chunk->create();
+        }
+        if (DPCP_OK != ret) {
+            log_error("chunked_mkey chunk %zd addr 0x%zx registration failed ret %d\n", i,
+                      (size_t)chunk_start, ret);
+            delete chunk;
+            return ret;
+        }
+        m_chunks[i] = chunk;
+    }
+    return DPCP_OK;
+}
+
+status chunked_mkey::reg_mem(void* verbs_pd)
+{
+    if (nullptr == m_address) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    if (0 == m_length) {
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+    if (nullptr == verbs_pd || !m_chunks.empty()) {
+        return DPCP_ERR_UMEM;
+    }
+
+    uintptr_t start = (uintptr_t)m_address;
+    size_t chunks_num = ((start + m_length - 1) / m_attr.chunk_sz) - (start / m_attr.chunk_sz) + 1;
+    m_chunks.assign(chunks_num, nullptr);
+
+    size_t workers_num = m_attr.workers_num;
+    if (workers_num > chunks_num) {
+        workers_num = chunks_num;
+    }
+    // Calling thread takes a share of chunks as well.
+    std::vector<status> rets(workers_num, DPCP_OK);
+    std::vector<std::thread> workers;
+    for (size_t w = 1; w < workers_num; w++) {
+        try {
+            workers.emplace_back([this, verbs_pd, w, workers_num, &rets]() {
+                rets[w] = reg_chunks(verbs_pd, w, workers_num);
+            });
+        } catch (const std::system_error& e) {
+            // Out of threads, leftover shares are registered by calling thread.
+            log_warn("chunked_mkey failed to start worker %zd: %s\n", w, e.what());
+            rets[w] = reg_chunks(verbs_pd, w, workers_num);
+        }
+    }
+    rets[0] = reg_chunks(verbs_pd, 0, workers_num);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    log_trace("chunked_mkey::reg_mem addr %p len %zd chunks %zd workers %zd\n", m_address,
+              m_length, chunks_num, workers_num);
+    for (status ret : rets) {
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+    }
+    return DPCP_OK;
+}
+
+/*
+ * See PRM sec. 9.6.1 and 18.3.1.1
+ */
+status chunked_mkey::create()
+{
+    size_t klm_num = m_chunks.size();
+    if (0 == klm_num) {
+        log_error("chunked_mkey::create memory was not registered\n");
+        return DPCP_ERR_UMEM;
+    }
+    uint32_t id = m_adapter->get_pd();
+    if (0 == id) {
+        log_error("chunked_mkey::create PD num is not avalaible!\n");
+        return DPCP_ERR_CREATE;
+    }
+    // KLM list must be aligned to 4 octwords, the last entries are padded with zeros.
+    uint32_t aligned_sz = align((uint32_t)klm_num, 4);
+    size_t inlen = DEVX_ST_SZ_BYTES(create_mkey_in) + aligned_sz * sizeof(mlx5_wqe_data_seg);
+    std::unique_ptr<uint8_t[]> in_guard(new (std::nothrow) uint8_t[inlen]);
+    void* in = in_guard.get();
+    if (nullptr == in) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    memset(in, 0, inlen);
+    uint32_t out[DEVX_ST_SZ_DW(create_mkey_out)] = {};
+    size_t outlen = sizeof(out);
+
+    DEVX_SET(create_mkey_in, in, translations_octword_actual_size, (uint32_t)klm_num);
+    // Set fields in mkey_entry context
+    void* p_mkeyc = DEVX_ADDR_OF(create_mkey_in, in, memory_key_mkey_entry);
+    DEVX_SET(mkc, p_mkeyc, access_mode_4_2, 0x0);
+    // Allow local write access
+    DEVX_SET(mkc, p_mkeyc, lw, 0x1);
+    // Allow local read access
+    DEVX_SET(mkc, p_mkeyc, lr, 0x1);
+    set_mkc_relaxed_ordering(p_mkeyc, m_flags);
+    // 2 LSB of the access mode, shall be set to 0x2 (KLM - indirect access)
+    DEVX_SET(mkc, p_mkeyc, access_mode_1_0, MLX5_MKC_ACCESS_MODE_KLMS);
+    // When no QPN is attached must be set to 0xffffff.
+    DEVX_SET(mkc, p_mkeyc, qpn, 0xffffff);
+    DEVX_SET(mkc, p_mkeyc, pd, id);
+    // Memory region address
+    uint64_t addr = (uint64_t)m_address;
+    if (m_flags & MKEY_ZERO_BASED) {
+        addr = (uint64_t)m_address % get_page_size();
+    }
+    DEVX_SET64(mkc, p_mkeyc, start_addr, addr);
+    DEVX_SET64(mkc, p_mkeyc, len, (uint64_t)m_length);
+    DEVX_SET(mkc, p_mkeyc, translations_octword_size, aligned_sz);
+
+    // KLM entry has the same layout as data segment: byte_count, mkey, va.
+    mlx5_wqe_data_seg* klms =
+        (mlx5_wqe_data_seg*)DEVX_ADDR_OF(create_mkey_in, in, klm_pas_mtt_bsf);
+    for (size_t i = 0; i < klm_num; i++) {
+        void* chunk_addr = nullptr;
+        size_t chunk_len = 0;
+        uint32_t chunk_id = 0;
+        status ret = m_chunks[i]->get_address(chunk_addr);
+        if (DPCP_OK == ret) {
+            ret = m_chunks[i]->get_length(chunk_len);
+        }
+        if (DPCP_OK == ret) {
+            ret = m_chunks[i]->get_id(chunk_id);
+        }
+        if (DPCP_OK != ret) {
+            log_trace("Can't get attributes of chunk MKey %p ret = %d\n", m_chunks[i], ret);
+            return ret;
+        }
+        klms[i].byte_count = htobe32((uint32_t)chunk_len);
+        klms[i].lkey = htobe32(chunk_id);
+        klms[i].addr = htobe64((uint64_t)chunk_addr);
+    }
+
+    DEVX_SET(create_mkey_in, in, opcode, MLX5_CMD_OP_CREATE_MKEY);
+    status ret = create_mkey(in, inlen, out, outlen, m_idx);
     if (DPCP_OK != ret) {
-        delete[] in;
         return ret;
     }
-    // 3 Bytes of the mkey index. Mkey index equals to 24 MSBs of the 32 bits
-    // mkey.
-    // The rest 8 LSB of the mkey are the variant part of the mkey, which is
-    // selected
-    // by the SW and set via Mkey Context.mkey_7_0
-    //
-    // Send command
-    m_idx = DEVX_GET(create_mkey_out, out, mkey_index) << 8;
-    m_idx |= (mkey_cnt % 0xFF);
-    log_trace("mkey_cnt: %d mkey_idx: 0x%x\n", mkey_cnt, m_idx);
-    delete[] in;
-    return ret;
+    log_trace("chunked mkey_idx: 0x%x chunks: %zd\n", m_idx, klm_num);
+    return DPCP_OK;
+}
+
+status chunked_mkey::get_address(void*& address)
+{
+    address = m_address;
+    if (nullptr == address) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    return DPCP_OK;
+}
+
+status chunked_mkey::get_length(size_t& len)
+{
+    len = m_length;
+    if (0 == len) {
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+    return DPCP_OK;
+}
+
+status chunked_mkey::get_flags(mkey_flags& flags)
+{
+    flags = m_flags;
+    return DPCP_OK;
+}
+
+status chunked_mkey::get_mkeys_num(size_t& mkeys_num)
+{
+    mkeys_num = m_chunks.size();
+    return DPCP_OK;
+}
+
+status chunked_mkey::get_mkeys_lst(mkey*& mkeys_lst)
+{
+    if (m_chunks.empty()) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    mkeys_lst = (mkey*)m_chunks.data();
+    return DPCP_OK;
+}
+
+status chunked_mkey::get_chunk_sz(size_t& chunk_sz)
+{
+    chunk_sz = m_attr.chunk_sz;
+    return DPCP_OK;
+}
+
+status chunked_mkey::get_id(uint32_t& id)
+{
+    id = m_idx;
+    return DPCP_OK;
 }
 
 reserved_mkey::reserved_mkey(adapter* ad, reserved_mkey_type type, void* address, size_t length,
@@ -665,11 +974,12 @@ extern_mkey::extern_mkey(adapter* ad, void* address, size_t length, uint32_t id)
     log_trace("EXTERN KEY CTR ad: %p\n", ad);
 }
 
-crypto_mkey::crypto_mkey(adapter* ad, const uint32_t max_sge)
+crypto_mkey::crypto_mkey(adapter* ad, const uint32_t max_sge, mkey_flags flags)
     : mkey(ad->get_ctx())
     , m_adapter(ad)
     , m_idx()
     , m_max_sge(max_sge)
+    , m_flags(ad->get_supported_mkey_flags((mkey_flags)(flags & MKEY_RELAXED_ORDERING)))
 {
 }
 
@@ -715,9 +1025,7 @@ status crypto_mkey::create()
     DEVX_SET(mkc, p_mkeyc, pd, pd_id);
     DEVX_SET(mkc, p_mkeyc, translations_octword_size, 128);
 
-    // TODO: need to understand if we can enable relax ordering as it improve performance.
-    // DEVX_SET(mkc, p_mkeyc, relaxed_ordering_write, attr->relaxed_ordering_write);
-    // DEVX_SET(mkc, p_mkeyc, relaxed_ordering_read, attr->relaxed_ordering_read);
+    set_mkc_relaxed_ordering(p_mkeyc, m_flags);
 
     // Enable encryption and decryption operations
     DEVX_SET(mkc, p_mkeyc, crypto_en, 1);
@@ -726,32 +1034,9 @@ status crypto_mkey::create()
     // Size (in units of 16B) required for this MKey’s BSF. Must be a multiple of 4.
     DEVX_SET(mkc, p_mkeyc, bsf_octword_size, m_max_sge);
 
-    // Obtain next Mkey counter from static value
-    int mkey_cnt = g_mkey_cnt.load();
-    while (!g_mkey_cnt.compare_exchange_strong(mkey_cnt, mkey_cnt + 1, std::memory_order_seq_cst) &&
-           (mkey_cnt < g_mkey_cnt))
-        ;
-    // mkey_cnt now include incremented unique value
-    //
-    // SW managed ID that comes to reduce a chance were a wrong key is used due to
-    // mkey
-    // index reuse (SW reuses mkey)
-    DEVX_SET(mkc, p_mkeyc, mkey_7_0, mkey_cnt % 0xFF);
-
     DEVX_SET(create_mkey_in, in, opcode, MLX5_CMD_OP_CREATE_MKEY);
-    status ret = obj::create(in, sizeof(in), out, outlen);
-    if (DPCP_OK != ret) {
-        return ret;
-    }
-    // 3 Bytes of the mkey index. Mkey index equals to 24 MSBs of the 32 bits
-    // mkey.
-    // The rest 8 LSB of the mkey are the variant part of the mkey, which is
-    // selected
-    // by the SW and set via Mkey Context.mkey_7_0
-    //
-    m_idx = DEVX_GET(create_mkey_out, out, mkey_index) << 8;
-    m_idx |= (mkey_cnt % 0xFF);
-    log_trace("mkey_cnt: %d mkey_idx: 0x%x\n", mkey_cnt, m_idx);
+    status ret = create_mkey(in, sizeof(in), out, outlen, m_idx);
+    log_trace("mkey_idx: 0x%x ret: %d\n", m_idx, ret);
     return ret;
 }
 
@@ -775,7 +1060,7 @@ status crypto_mkey::get_length(size_t& len_)
 
 status crypto_mkey::get_flags(mkey_flags& flags)
 {
-    flags = MKEY_ZERO_BASED;
+    flags = (mkey_flags)(MKEY_ZERO_BASED | m_flags);
     return DPCP_OK;
 }
 
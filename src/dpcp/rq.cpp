@@ -88,6 +88,7 @@ status rq::modify_state(rq_state new_state)
     DEVX_SET(modify_rq_in, in, rqn, rqn);
     void* p_rqc = DEVX_ADDR_OF(create_rq_in, in, ctx);
     DEVX_SET(rqc, p_rqc, state, new_state);
+    prepare_modify(p_rqc, new_state);
 
     DEVX_SET(modify_rq_in, in, opcode, MLX5_CMD_OP_MODIFY_RQ);
     ret = obj::modify(in, sizeof(in), out, outlen);
@@ -590,4 +591,50 @@ status ibq_rq::get_mkey(uint32_t& mkey)
     mkey = m_mkey;
     return DPCP_OK;
 }
+
+hairpin_rq::hairpin_rq(dcmd::ctx* ctx, const hairpin_attr& attr)
+    : rq(ctx, rq_attr())
+    , m_hp_attr(attr)
+    , m_peer_sqn(0)
+    , m_peer_vhca(0)
+{
+}
+
+status hairpin_rq::create()
+{
+    uint32_t in[DEVX_ST_SZ_DW(create_rq_in)] = {};
+    uint32_t out[DEVX_ST_SZ_DW(create_rq_out)] = {};
+    size_t outlen = sizeof(out);
+    status ret = DPCP_OK;
+    //
+    // Set fields in rqc, buffers are owned by HW, no CQ
+    void* p_rqc = DEVX_ADDR_OF(create_rq_in, in, ctx);
+    DEVX_SET(rqc, p_rqc, hairpin, 1);
+    // RQ in RESET
+    DEVX_SET(rqc, p_rqc, state, m_state);
+    // WQ
+    void* p_wq = DEVX_ADDR_OF(rqc, p_rqc, wq);
+    DEVX_SET(wq, p_wq, log_hairpin_data_sz, m_hp_attr.log_data_sz);
+    DEVX_SET(wq, p_wq, log_hairpin_num_packets, m_hp_attr.log_num_packets);
+
+    // Send mailbox
+    DEVX_SET(create_rq_in, in, opcode, MLX5_CMD_OP_CREATE_RQ);
+    ret = obj::create(in, sizeof(in), out, outlen);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    uint32_t id = 0;
+    ret = obj::get_id(id);
+    log_trace("HAIRPIN_RQ created id=0x%x log_data_sz=%u log_num_packets=%u ret=%d\n", id,
+              m_hp_attr.log_data_sz, m_hp_attr.log_num_packets, ret);
+    return ret;
+}
+
+void hairpin_rq::prepare_modify(void* p_rqc, rq_state new_state)
+{
+    if (RQ_RDY == new_state) {
+        DEVX_SET(rqc, p_rqc, hairpin_peer_sq, m_peer_sqn);
+        DEVX_SET(rqc, p_rqc, hairpin_peer_vhca, m_peer_vhca);
+    }
+}
 } // namespace dpcp
@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <memory>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+rqt::rqt(dcmd::ctx* ctx, uint32_t size_limit)
+    : obj(ctx)
+    , m_rqtn(0)
+    , m_max_size(0)
+    , m_size_limit(size_limit)
+{
+}
+
+rqt::~rqt()
+{
+}
+
+status rqt::set_rq_list(void* rqt_ctx, const std::vector<uint32_t>& rqns)
+{
+    if (rqns.empty() || rqns.size() > m_max_size) {
+        log_error("RQT size %zu is out of range, max size %u\n", rqns.size(), m_max_size);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    if (rqns.size() & (rqns.size() - 1)) {
+        log_error("RQT size %zu is not a power of two\n", rqns.size());
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    uint8_t* rq_list = (uint8_t*)DEVX_ADDR_OF(rqtc, rqt_ctx, rq_num);
+    DEVX_SET(rqtc, rqt_ctx, rqt_actual_size, rqns.size());
+    for (size_t i = 0; i < rqns.size(); i++) {
+        DEVX_SET(rq_num, rq_list + i * DEVX_ST_SZ_BYTES(rq_num), rq_num, rqns[i]);
+    }
+
+    return DPCP_OK;
+}
+
+status rqt::create(const rqt::attr& rqt_attr)
+{
+    status ret = DPCP_OK;
+    uint32_t out[DEVX_ST_SZ_DW(create_rqt_out)] = {0};
+    size_t outlen = sizeof(out);
+    uintptr_t handle;
+
+    if (DPCP_OK == get_handle(handle)) {
+        log_error("RQT already exists\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    m_max_size = std::max<uint32_t>(rqt_attr.max_size, rqt_attr.rqns.size());
+    if (m_size_limit && m_max_size > m_size_limit) {
+        log_error("RQT max size %u exceeds HW limit %u\n", m_max_size, m_size_limit);
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+    size_t inlen =
+        DEVX_ST_SZ_BYTES(create_rqt_in) + DEVX_ST_SZ_BYTES(rq_num) * (size_t)m_max_size;
+    std::unique_ptr<uint8_t[]> in(new (std::nothrow) uint8_t[inlen]);
+    if (!in) {
+        log_error("RQT in buf memory allocation failed\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+    memset(in.get(), 0, inlen);
+
+    DEVX_SET(create_rqt_in, in.get(), opcode, MLX5_CMD_OP_CREATE_RQT);
+    void* rqt_ctx = DEVX_ADDR_OF(create_rqt_in, in.get(), rqt_context);
+    DEVX_SET(rqtc, rqt_ctx, rqt_max_size, m_max_size);
+    ret = set_rq_list(rqt_ctx, rqt_attr.rqns);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+
+    ret = obj::create(in.get(), inlen, out, outlen);
+    if (DPCP_OK == ret) {
+        ret = obj::get_id(m_rqtn);
+        log_trace("RQT rqtn: 0x%x created, size %zu max size %u\n", m_rqtn, rqt_attr.rqns.size(),
+                  m_max_size);
+    }
+
+    return ret;
+}
+
+status rqt::modify(const std::vector<uint32_t>& rqns)
+{
+    status ret = DPCP_OK;
+    uint32_t out[DEVX_ST_SZ_DW(modify_rqt_out)] = {0};
+    size_t outlen = sizeof(out);
+    uintptr_t handle;
+
+    if (DPCP_OK != get_handle(handle)) {
+        log_error("RQT is invalid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    size_t inlen = DEVX_ST_SZ_BYTES(modify_rqt_in) + DEVX_ST_SZ_BYTES(rq_num) * rqns.size();
+    std::unique_ptr<uint8_t[]> in(new (std::nothrow) uint8_t[inlen]);
+    if (!in) {
+        log_error("RQT in buf memory allocation failed\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+    memset(in.get(), 0, inlen);
+
+    DEVX_SET(modify_rqt_in, in.get(), opcode, MLX5_CMD_OP_MODIFY_RQT);
+    DEVX_SET(modify_rqt_in, in.get(), rqtn, m_rqtn);
+    DEVX_SET(modify_rqt_in, in.get(), bitmask.rqn_list, 1);
+    ret = set_rq_list(DEVX_ADDR_OF(modify_rqt_in, in.get(), ctx), rqns);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+
+    ret = obj::modify(in.get(), inlen, out, outlen);
+    if (DPCP_OK == ret) {
+        log_trace("RQT rqtn: 0x%x modified, size %zu\n", m_rqtn, rqns.size());
+    }
+
+    return ret;
+}
+
+status rqt::query(std::vector<uint32_t>& rqns)
+{
+    status ret = DPCP_OK;
+    uint32_t in[DEVX_ST_SZ_DW(query_rqt_in)] = {0};
+    uintptr_t handle;
+
+    if (DPCP_OK != get_handle(handle)) {
+        log_error("RQT is invalid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    size_t outlen =
+        DEVX_ST_SZ_BYTES(query_rqt_out) + DEVX_ST_SZ_BYTES(rq_num) * (size_t)m_max_size;
+    std::unique_ptr<uint8_t[]> out(new (std::nothrow) uint8_t[outlen]);
+    if (!out) {
+        log_error("RQT out buf memory allocation failed\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+    memset(out.get(), 0, outlen);
+
+    DEVX_SET(query_rqt_in, in, opcode, MLX5_CMD_OP_QUERY_RQT);
+    DEVX_SET(query_rqt_in, in, rqtn, m_rqtn);
+
+    ret = obj::query(in, sizeof(in), out.get(), outlen);
+    if (DPCP_OK != ret) {
+        log_error("RQT query() rqtn=0x%x ret=%d\n", m_rqtn, ret);
+        return ret;
+    }
+
+    void* rqt_ctx = DEVX_ADDR_OF(query_rqt_out, out.get(), rqt_context);
+    uint8_t* rq_list = (uint8_t*)DEVX_ADDR_OF(rqtc, rqt_ctx, rq_num);
+    uint32_t size = std::min<uint32_t>(DEVX_GET(rqtc, rqt_ctx, rqt_actual_size), m_max_size);
+    rqns.resize(size);
+    for (uint32_t i = 0; i < size; i++) {
+        rqns[i] = DEVX_GET(rq_num, rq_list + i * DEVX_ST_SZ_BYTES(rq_num), rq_num);
+    }
+
+    return DPCP_OK;
+}
+
+} // namespace dpcp
@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+rqt_rebalancer::rqt_rebalancer(rqt* table, const std::vector<uint32_t>& rqns,
+                               const rqt_rebalancer_attr& attr)
+    : m_rqt(table)
+    , m_rqns(rqns)
+    , m_entries()
+    , m_attr(attr)
+    , m_last_modify_ms(0)
+{
+}
+
+status rqt_rebalancer::init()
+{
+    if (!m_rqt || m_rqns.empty()) {
+        log_error("Rebalancer has no RQT or RQs\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    std::vector<uint32_t> entries;
+    status ret = m_rqt->query(entries);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+
+    for (uint32_t rqn : entries) {
+        if (std::find(m_rqns.begin(), m_rqns.end(), rqn) == m_rqns.end()) {
+            log_error("RQT rqtn: 0x%x points to unknown rqn 0x%x\n", m_rqt->get_rqtn(), rqn);
+            return DPCP_ERR_INVALID_PARAM;
+        }
+    }
+    m_entries.swap(entries);
+
+    return DPCP_OK;
+}
+
+uint32_t rqt_rebalancer::plan(std::vector<uint32_t>& entries, const std::vector<uint32_t>& rqns,
+                              const std::vector<uint64_t>& rq_loads,
+                              const std::vector<uint64_t>& bucket_loads,
+                              const rqt_rebalancer_attr& attr)
+{
+    size_t rqs_num = rqns.size();
+    size_t buckets_num = entries.size();
+    if (!rqs_num || rq_loads.size() != rqs_num) {
+        return 0;
+    }
+    bool has_bucket_loads = (bucket_loads.size() == buckets_num);
+
+    std::unordered_map<uint32_t, size_t> rq_idx;
+    for (size_t q = 0; q < rqs_num; q++) {
+        rq_idx[rqns[q]] = q;
+    }
+
+    std::vector<size_t> owner(buckets_num);
+    std::vector<uint32_t> owned(rqs_num, 0);
+    for (size_t b = 0; b < buckets_num; b++) {
+        auto it = rq_idx.find(entries[b]);
+        if (it == rq_idx.end()) {
+            return 0;
+        }
+        owner[b] = it->second;
+        owned[it->second]++;
+    }
+
+    // Estimated load of every bucket and the resulting load of every RQ.
+    std::vector<double> bucket_load(buckets_num);
+    std::vector<double> load(rqs_num, 0.0);
+    double total = 0.0;
+    for (size_t b = 0; b < buckets_num; b++) {
+        size_t q = owner[b];
+        bucket_load[b] =
+            has_bucket_loads ? (double)bucket_loads[b] : (double)rq_loads[q] / owned[q];
+        load[q] += bucket_load[b];
+        total += bucket_load[b];
+    }
+    if (total <= 0.0) {
+        return 0;
+    }
+
+    double mean = total / rqs_num;
+    double trigger = mean * (100 + attr.imbalance_pct) / 100;
+    double target = mean * (100 + std::min(attr.target_pct, attr.imbalance_pct)) / 100;
+    if (*std::max_element(load.begin(), load.end()) <= trigger) {
+        return 0;
+    }
+
+    uint32_t moved = 0;
+    while (!attr.max_moves || moved < attr.max_moves) {
+        size_t hot = std::max_element(load.begin(), load.end()) - load.begin();
+        size_t cold = std::min_element(load.begin(), load.end()) - load.begin();
+        if (load[hot] <= target) {
+            break;
+        }
+
+        // The best bucket brings the pair closest to even, a bucket not lighter than the gap
+        // would just swap hot and cold.
+        double gap = load[hot] - load[cold];
+        size_t best = buckets_num;
+        double best_dist = 0.0;
+        for (size_t b = 0; b < buckets_num; b++) {
+            if (owner[b] != hot || bucket_load[b] <= 0.0 || bucket_load[b] >= gap) {
+                continue;
+            }
+            double dist = std::abs(2 * bucket_load[b] - gap);
+            if (best == buckets_num || dist < best_dist) {
+                best = b;
+                best_dist = dist;
+            }
+        }
+        if (best == buckets_num) {
+            break;
+        }
+
+        entries[best] = rqns[cold];
+        owner[best] = cold;
+        load[hot] -= bucket_load[best];
+        load[cold] += bucket_load[best];
+        moved++;
+    }
+
+    return moved;
+}
+
+status rqt_rebalancer::rebalance(const std::vector<uint64_t>& rq_loads,
+                                 const std::vector<uint64_t>& bucket_loads, uint32_t& moved)
+{
+    moved = 0;
+    if (m_entries.empty()) {
+        log_error("Rebalancer is not initialized\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    if (rq_loads.size() != m_rqns.size() ||
+        (!bucket_loads.empty() && bucket_loads.size() != m_entries.size())) {
+        log_error("Rebalancer got %zu RQ loads and %zu bucket loads, expected %zu and %zu\n",
+                  rq_loads.size(), bucket_loads.size(), m_rqns.size(), m_entries.size());
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    uint64_t now = get_time_ms();
+    if (m_last_modify_ms && now - m_last_modify_ms < m_attr.min_interval_ms) {
+        return DPCP_OK;
+    }
+
+    std::vector<uint32_t> entries(m_entries);
+    uint32_t moves = plan(entries, m_rqns, rq_loads, bucket_loads, m_attr);
+    if (!moves) {
+        return DPCP_OK;
+    }
+
+    status ret = m_rqt->modify(entries);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    m_entries.swap(entries);
+    m_last_modify_ms = now;
+    moved = moves;
+    log_trace("RQT rqtn: 0x%x rebalanced, %u entries moved\n", m_rqt->get_rqtn(), moved);
+
+    return DPCP_OK;
+}
+
+} // namespace dpcp
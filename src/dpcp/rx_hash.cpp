@@ -0,0 +1,198 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+// Toeplitz result is 32 bits wide, so the key covers at most key size - 4 input bytes.
+static const uint32_t RX_HASH_MAX_INPUT_LEN = TIR_RX_HASH_TOEPLITZ_KEY_SIZE - 4;
+static const uint32_t RX_HASH_BURST_WIDTH = 4;
+
+/*
+ * Returns 32 key bits starting at bit offset, bit 0 is MSB of key[0].
+ */
+static uint32_t get_key_window(const uint8_t* key, uint32_t offset)
+{
+    uint32_t window = 0;
+    for (uint32_t i = 0; i < 32; i++) {
+        uint32_t bit = offset + i;
+        window = (window << 1) | ((key[bit / 8] >> (7 - bit % 8)) & 1);
+    }
+    return window;
+}
+
+rx_hash::rx_hash()
+    : m_table()
+    , m_fields()
+    , m_input_len(0)
+{
+}
+
+status rx_hash::init(const tir::attr& tir_attr, bool inner)
+{
+    if (!(tir_attr.flags & TIR_ATTR_INDIRECT)) {
+        log_error("RX hash requires indirect TIR attributes\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    return init(tir_attr.rss.hash_fn, tir_attr.rss.toeplitz_key, tir_attr.rss.symmetric,
+                inner ? tir_attr.rss.inner : tir_attr.rss.outer);
+}
+
+status rx_hash::init(uint32_t hash_fn, const uint8_t* key, bool symmetric,
+                     const tir_rx_hash_field_select& fields)
+{
+    if (TIR_RX_HASH_FN_TOEPLITZ != hash_fn) {
+        log_error("RX hash function %u is not supported\n", hash_fn);
+        return DPCP_ERR_NO_SUPPORT;
+    }
+    if (symmetric) {
+        log_error("RX hash symmetric mode is not supported\n");
+        return DPCP_ERR_NO_SUPPORT;
+    }
+    if (!key) {
+        log_error("RX hash key is not set\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    uint32_t ip_len = fields.l3_prot_type ? 16 : 4;
+    uint32_t input_len = 0;
+    input_len += (fields.selected_fields & TIR_RX_HASH_SRC_IP) ? ip_len : 0;
+    input_len += (fields.selected_fields & TIR_RX_HASH_DST_IP) ? ip_len : 0;
+    input_len += (fields.selected_fields & TIR_RX_HASH_L4_SPORT) ? 2 : 0;
+    input_len += (fields.selected_fields & TIR_RX_HASH_L4_DPORT) ? 2 : 0;
+    input_len += (fields.selected_fields & TIR_RX_HASH_IPSEC_SPI) ? 4 : 0;
+    if (!input_len || input_len > RX_HASH_MAX_INPUT_LEN) {
+        log_error("RX hash input length %u is out of range\n", input_len);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    // Byte value v at position i contributes XOR of key windows of its set bits.
+    std::vector<uint32_t> table(input_len * 256, 0);
+    for (uint32_t i = 0; i < input_len; i++) {
+        uint32_t windows[8];
+        for (uint32_t j = 0; j < 8; j++) {
+            windows[j] = get_key_window(key, i * 8 + j);
+        }
+        uint32_t* row = &table[i * 256];
+        for (uint32_t v = 1; v < 256; v++) {
+            for (uint32_t j = 0; j < 8; j++) {
+                if (v & (0x80 >> j)) {
+                    row[v] ^= windows[j];
+                }
+            }
+        }
+    }
+
+    m_table.swap(table);
+    m_fields = fields;
+    m_input_len = input_len;
+    log_trace("RX hash input length %u fields 0x%x\n", m_input_len, m_fields.selected_fields);
+
+    return DPCP_OK;
+}
+
+uint32_t rx_hash::get_input(const rx_hash_tuple& tuple, uint8_t* input) const
+{
+    uint32_t ip_len = m_fields.l3_prot_type ? 16 : 4;
+    uint32_t selected = m_fields.selected_fields;
+    uint8_t* pos = input;
+
+    if (selected & TIR_RX_HASH_SRC_IP) {
+        memcpy(pos, tuple.src_ip, ip_len);
+        pos += ip_len;
+    }
+    if (selected & TIR_RX_HASH_DST_IP) {
+        memcpy(pos, tuple.dst_ip, ip_len);
+        pos += ip_len;
+    }
+    if (selected & TIR_RX_HASH_L4_SPORT) {
+        memcpy(pos, &tuple.src_port, sizeof(tuple.src_port));
+        pos += sizeof(tuple.src_port);
+    }
+    if (selected & TIR_RX_HASH_L4_DPORT) {
+        memcpy(pos, &tuple.dst_port, sizeof(tuple.dst_port));
+        pos += sizeof(tuple.dst_port);
+    }
+    if (selected & TIR_RX_HASH_IPSEC_SPI) {
+        memcpy(pos, &tuple.spi, sizeof(tuple.spi));
+        pos += sizeof(tuple.spi);
+    }
+
+    return (uint32_t)(pos - input);
+}
+
+uint32_t rx_hash::hash(const rx_hash_tuple& tuple) const
+{
+    uint8_t input[RX_HASH_MAX_INPUT_LEN];
+    uint32_t len = m_table.empty() ? 0 : get_input(tuple, input);
+    uint32_t result = 0;
+
+    for (uint32_t i = 0; i < len; i++) {
+        result ^= m_table[i * 256 + input[i]];
+    }
+
+    return result;
+}
+
+void rx_hash::hash_burst(const rx_hash_tuple* tuples, uint32_t* hashes, size_t num) const
+{
+    size_t n = 0;
+
+    // Independent lookups of several tuples are interleaved to hide load latency.
+    for (; !m_table.empty() && n + RX_HASH_BURST_WIDTH <= num; n += RX_HASH_BURST_WIDTH) {
+        uint8_t input[RX_HASH_BURST_WIDTH][RX_HASH_MAX_INPUT_LEN];
+        uint32_t result[RX_HASH_BURST_WIDTH] = {0};
+        for (uint32_t k = 0; k < RX_HASH_BURST_WIDTH; k++) {
+            get_input(tuples[n + k], input[k]);
+        }
+        for (uint32_t i = 0; i < m_input_len; i++) {
+            const uint32_t* row = &m_table[i * 256];
+            for (uint32_t k = 0; k < RX_HASH_BURST_WIDTH; k++) {
+                result[k] ^= row[input[k][i]];
+            }
+        }
+        for (uint32_t k = 0; k < RX_HASH_BURST_WIDTH; k++) {
+            hashes[n + k] = result[k];
+        }
+    }
+    for (; n < num; n++) {
+        hashes[n] = hash(tuples[n]);
+    }
+}
+
+} // namespace dpcp
@@ -103,6 +103,7 @@ status sq::modify_state(sq_state new_state)
     DEVX_SET(modify_sq_in, in, sqn, sqn);
     void* p_sqc = DEVX_ADDR_OF(create_sq_in, in, ctx);
     DEVX_SET(sqc, p_sqc, state, new_state);
+    prepare_modify(p_sqc, new_state);
 
     DEVX_SET(modify_sq_in, in, opcode, MLX5_CMD_OP_MODIFY_SQ);
     ret = obj::modify(in, sizeof(in), out, outlen);
@@ -464,4 +465,53 @@ status pp_sq::modify(sq_attr& attr)
     return ret;
 }
 
+hairpin_sq::hairpin_sq(dcmd::ctx* ctx, sq_attr& attr, const hairpin_attr& hp_attr)
+    : sq(ctx, attr)
+    , m_hp_attr(hp_attr)
+    , m_peer_rqn(0)
+    , m_peer_vhca(0)
+{
+}
+
+status hairpin_sq::create()
+{
+    uint32_t in[DEVX_ST_SZ_DW(create_sq_in)] = {};
+    uint32_t out[DEVX_ST_SZ_DW(create_sq_out)] = {};
+    size_t outlen = sizeof(out);
+    status ret = DPCP_OK;
+    //
+    // Set fields in sqc, buffers are owned by HW, no CQ
+    void* p_sqc = DEVX_ADDR_OF(create_sq_in, in, ctx);
+    DEVX_SET(sqc, p_sqc, hairpin, 1);
+    // SQ in RESET
+    DEVX_SET(sqc, p_sqc, state, m_state);
+    // TIS
+    DEVX_SET(sqc, p_sqc, tis_lst_sz, 1);
+    DEVX_SET(sqc, p_sqc, tis_num_0, (m_hp_attr.tis_num & 0xFFFFFF));
+    // WQ
+    void* p_wq = DEVX_ADDR_OF(sqc, p_sqc, wq);
+    DEVX_SET(wq, p_wq, log_hairpin_data_sz, m_hp_attr.log_data_sz);
+    DEVX_SET(wq, p_wq, log_hairpin_num_packets, m_hp_attr.log_num_packets);
+
+    // Send mailbox
+    DEVX_SET(create_sq_in, in, opcode, MLX5_CMD_OP_CREATE_SQ);
+    ret = obj::create(in, sizeof(in), out, outlen);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    uint32_t id = 0;
+    ret = obj::get_id(id);
+    log_trace("HAIRPIN_SQ created id=0x%x log_data_sz=%u log_num_packets=%u ret=%d\n", id,
+              m_hp_attr.log_data_sz, m_hp_attr.log_num_packets, ret);
+    return ret;
+}
+
+void hairpin_sq::prepare_modify(void* p_sqc, sq_state new_state)
+{
+    if (SQ_RDY == new_state) {
+        DEVX_SET(sqc, p_sqc, hairpin_peer_rq, m_peer_rqn);
+        DEVX_SET(sqc, p_sqc, hairpin_peer_vhca, m_peer_vhca);
+    }
+}
+
 } // namespace dpcp
@@ -38,6 +38,41 @@
 
 namespace dpcp {
 
+static status set_rx_hash(void* tir_ctx, const tir::attr& tir_attr)
+{
+    if (tir_attr.flags & TIR_ATTR_INLINE_RQN) {
+        log_error("TIR can not be both direct and indirect\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    DEVX_SET(tirc, tir_ctx, disp_type, MLX5_TIRC_DISP_TYPE_INDIRECT);
+    DEVX_SET(tirc, tir_ctx, indirect_table, tir_attr.rss.indirect_table);
+    DEVX_SET(tirc, tir_ctx, rx_hash_fn, tir_attr.rss.hash_fn);
+    DEVX_SET(tirc, tir_ctx, rx_hash_symmetric, tir_attr.rss.symmetric);
+    if (tir_attr.rss.hash_fn == TIR_RX_HASH_FN_TOEPLITZ) {
+        memcpy(DEVX_ADDR_OF(tirc, tir_ctx, rx_hash_toeplitz_key), tir_attr.rss.toeplitz_key,
+               sizeof(tir_attr.rss.toeplitz_key));
+    }
+    DEVX_SET(tirc, tir_ctx, rx_hash_field_selector_outer.l3_prot_type,
+             tir_attr.rss.outer.l3_prot_type);
+    DEVX_SET(tirc, tir_ctx, rx_hash_field_selector_outer.l4_prot_type,
+             tir_attr.rss.outer.l4_prot_type);
+    DEVX_SET(tirc, tir_ctx, rx_hash_field_selector_outer.selected_fields,
+             tir_attr.rss.outer.selected_fields);
+    if (tir_attr.rss.inner.selected_fields) {
+        // Hash on inner headers requires tunneled offload.
+        DEVX_SET(tirc, tir_ctx, tunneled_offload_en, 1);
+        DEVX_SET(tirc, tir_ctx, rx_hash_field_selector_inner.l3_prot_type,
+                 tir_attr.rss.inner.l3_prot_type);
+        DEVX_SET(tirc, tir_ctx, rx_hash_field_selector_inner.l4_prot_type,
+                 tir_attr.rss.inner.l4_prot_type);
+        DEVX_SET(tirc, tir_ctx, rx_hash_field_selector_inner.selected_fields,
+                 tir_attr.rss.inner.selected_fields);
+    }
+
+    return DPCP_OK;
+}
+
 tir::tir(dcmd::ctx* ctx)
     : forwardable_obj(ctx)
     , m_tirn(0)
@@ -97,6 +132,13 @@ status tir::create(const tir::attr& tir_attr)
         DEVX_SET(tirc, tir_ctx, nvmeotcp_crc_en, tir_attr.nvmeotcp.crc_en);
     }
 
+    if (tir_attr.flags & TIR_ATTR_INDIRECT) {
+        ret = set_rx_hash(tir_ctx, tir_attr);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+    }
+
     ret = obj::create(in, sizeof(in), out, outlen);
     if (DPCP_OK == ret) {
         ret = obj::get_id(m_tirn);
@@ -134,6 +176,14 @@ status tir::modify(const tir::attr& tir_attr)
         DEVX_SET(tirc, tir_ctx, lro_max_ip_payload_size, tir_attr.lro.max_msg_sz);
     }
 
+    if (tir_attr.flags & TIR_ATTR_INDIRECT) {
+        DEVX_SET(modify_tir_in, in, bitmask.hash, 1);
+        ret = set_rx_hash(tir_ctx, tir_attr);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+    }
+
     ret = obj::modify(in, sizeof(in), out, outlen);
     if (DPCP_OK == ret) {
         log_trace("TIR tirn: 0x%x modified\n", m_tirn);
@@ -141,6 +191,9 @@ status tir::modify(const tir::attr& tir_attr)
         if (tir_attr.flags & TIR_ATTR_LRO) {
             memcpy(&m_attr.lro, &tir_attr.lro, sizeof(m_attr.lro));
         }
+        if (tir_attr.flags & TIR_ATTR_INDIRECT) {
+            memcpy(&m_attr.rss, &tir_attr.rss, sizeof(m_attr.rss));
+        }
     }
 
     return ret;
@@ -187,8 +240,6 @@ status tir::query(tir::attr& tir_attr)
     m_attr.lro.max_msg_sz = DEVX_GET(tirc, tir_ctx, lro_max_ip_payload_size);
     m_attr.flags |= TIR_ATTR_TLS;
     m_attr.tls_en = DEVX_GET(tirc, tir_ctx, tls_en);
-    m_attr.flags |= TIR_ATTR_INLINE_RQN;
-    m_attr.inline_rqn = DEVX_GET(tirc, tir_ctx, inline_rqn);
     m_attr.flags |= TIR_ATTR_TRANSPORT_DOMAIN;
     m_attr.transport_domain = DEVX_GET(tirc, tir_ctx, transport_domain);
     m_attr.flags |= TIR_ATTR_NVMEOTCP_ZERO_COPY;
@@ -196,6 +247,29 @@ status tir::query(tir::attr& tir_attr)
     m_attr.nvmeotcp.tag_buffer_table_id = DEVX_GET(tirc, tir_ctx, nvmeotcp_tag_buffer_table_id);
     m_attr.flags |= TIR_ATTR_NVMEOTCP_CRC;
     m_attr.nvmeotcp.crc_en = DEVX_GET(tirc, tir_ctx, nvmeotcp_crc_en);
+    if (DEVX_GET(tirc, tir_ctx, disp_type) != MLX5_TIRC_DISP_TYPE_INDIRECT) {
+        m_attr.flags |= TIR_ATTR_INLINE_RQN;
+        m_attr.inline_rqn = DEVX_GET(tirc, tir_ctx, inline_rqn);
+    } else {
+        m_attr.flags |= TIR_ATTR_INDIRECT;
+        m_attr.rss.indirect_table = DEVX_GET(tirc, tir_ctx, indirect_table);
+        m_attr.rss.hash_fn = DEVX_GET(tirc, tir_ctx, rx_hash_fn);
+        m_attr.rss.symmetric = DEVX_GET(tirc, tir_ctx, rx_hash_symmetric);
+        memcpy(m_attr.rss.toeplitz_key, DEVX_ADDR_OF(tirc, tir_ctx, rx_hash_toeplitz_key),
+               sizeof(m_attr.rss.toeplitz_key));
+        m_attr.rss.outer.l3_prot_type =
+            DEVX_GET(tirc, tir_ctx, rx_hash_field_selector_outer.l3_prot_type);
+        m_attr.rss.outer.l4_prot_type =
+            DEVX_GET(tirc, tir_ctx, rx_hash_field_selector_outer.l4_prot_type);
+        m_attr.rss.outer.selected_fields =
+            DEVX_GET(tirc, tir_ctx, rx_hash_field_selector_outer.selected_fields);
+        m_attr.rss.inner.l3_prot_type =
+            DEVX_GET(tirc, tir_ctx, rx_hash_field_selector_inner.l3_prot_type);
+        m_attr.rss.inner.l4_prot_type =
+            DEVX_GET(tirc, tir_ctx, rx_hash_field_selector_inner.l4_prot_type);
+        m_attr.rss.inner.selected_fields =
+            DEVX_GET(tirc, tir_ctx, rx_hash_field_selector_inner.selected_fields);
+    }
 
 out:
     memcpy(&tir_attr, &m_attr, sizeof(m_attr));
@@ -209,6 +283,8 @@ status tir::query(tir::attr& tir_attr)
     log_trace("          zerocopy_en=0x%x\n", m_attr.nvmeotcp.zerocopy_en);
     log_trace("          tag_buffer_table_id=0x%x\n", m_attr.nvmeotcp.tag_buffer_table_id);
     log_trace("          crc_en=0x%x\n", m_attr.nvmeotcp.crc_en);
+    log_trace("          indirect_table=0x%x\n", m_attr.rss.indirect_table);
+    log_trace("          rx_hash_fn=0x%x\n", m_attr.rss.hash_fn);
 
     return DPCP_OK;
 }
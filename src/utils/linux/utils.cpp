@@ -31,6 +31,7 @@
 
 #include <cstdint>
 #include <fstream>
+#include <sys/mman.h>
 #include "utils.h"
 
 static const int DPCP_DEFAULT_CACHELINE_SIZE = 64;
@@ -47,3 +48,18 @@ size_t get_cacheline_size()
     is >> result;
     return result;
 }
+
+void prefault_mem(void* addr, size_t len)
+{
+    size_t page_sz = get_page_size();
+    uintptr_t start = (uintptr_t)addr & ~(page_sz - 1);
+    size_t sz = (uintptr_t)addr + len - start;
+
+#if defined(MADV_POPULATE_WRITE)
+    // Populates page tables writable in one call, kernel 5.14+.
+    if (0 == madvise((void*)start, sz, MADV_POPULATE_WRITE)) {
+        return;
+    }
+#endif
+    madvise((void*)start, sz, MADV_WILLNEED);
+}
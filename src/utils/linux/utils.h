@@ -33,6 +33,8 @@
 #define SRC_UTILS_LINUX_UTILS_H_
 
 #include <unistd.h>
+#include <sched.h>
+#include <atomic>
 #include <cstdint>
 
 inline size_t get_page_size()
@@ -43,4 +45,31 @@ inline size_t get_page_size()
 
 size_t get_cacheline_size();
 
+inline uint32_t get_cpu_id()
+{
+    int cpu = sched_getcpu();
+    return (cpu > 0 ? (uint32_t)cpu : 0);
+}
+
+/**
+ * @brief Orders CPU writes to host memory before they are seen by device.
+ */
+inline void dma_wmb()
+{
+#if defined(__aarch64__)
+    asm volatile("dmb oshst" ::: "memory");
+#elif defined(__powerpc64__)
+    asm volatile("sync" ::: "memory");
+#else
+    std::atomic_thread_fence(std::memory_order_release);
+#endif
+}
+
+/**
+ * @brief Faults in pages of [addr, addr + len) ahead of pinning them.
+ *
+ * Best effort, failures are ignored and pages are faulted in by registration.
+ */
+void prefault_mem(void* addr, size_t len);
+
 #endif /* SRC_UTILS_LINUX_UTILS_H_ */
@@ -58,3 +58,11 @@ size_t get_cacheline_size()
     free(buffer);
     return result;
 }
+
+void prefault_mem(void* addr, size_t len)
+{
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = addr;
+    range.NumberOfBytes = len;
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
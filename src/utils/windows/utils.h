@@ -79,4 +79,24 @@ inline size_t get_page_size()
 
 size_t get_cacheline_size();
 
+inline uint32_t get_cpu_id()
+{
+    return (uint32_t)GetCurrentProcessorNumber();
+}
+
+/**
+ * @brief Orders CPU writes to host memory before they are seen by device.
+ */
+inline void dma_wmb()
+{
+    MemoryBarrier();
+}
+
+/**
+ * @brief Faults in pages of [addr, addr + len) ahead of pinning them.
+ *
+ * Best effort, failures are ignored and pages are faulted in by registration.
+ */
+void prefault_mem(void* addr, size_t len);
+
 #endif /* SRC_UTILS_WINDOWS_UTILS_H_ */
@@ -0,0 +1,248 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+
+#include "dpcp_base.h"
+
+using namespace dpcp;
+
+class dpcp_buffer_pool : /*public obj,*/ public dpcp_base {
+};
+
+/**
+ * @test dpcp_buffer_pool.ti_01_create
+ * @brief
+ *    Check adapter::create_buffer_pool method
+ * @details
+ *
+ */
+TEST_F(dpcp_buffer_pool, ti_01_create)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    buffer_pool* pool = nullptr;
+    buffer_pool_attr bad_attr = {0, 128, 64, 64, 1, 0, MKEY_NONE};
+    ret = ad->create_buffer_pool(bad_attr, pool);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    buffer_pool_attr attr = {2048, 128, 64, 64, 1, 0, MKEY_NONE};
+    ret = ad->create_buffer_pool(attr, pool);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, pool);
+
+    uint32_t slabs_num = 0;
+    ret = pool->get_slabs_num(slabs_num);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(1U, slabs_num);
+
+    size_t stride_sz = 0;
+    ret = pool->get_stride_sz(stride_sz);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_LE((size_t)(128 + 2048 + 64), stride_sz);
+
+    delete pool;
+    delete ad;
+}
+
+/**
+ * @test dpcp_buffer_pool.ti_02_alloc_release
+ * @brief
+ *    Check buffer_pool::alloc, ref and release methods
+ * @details
+ *    Buffer is reused only after the last reference is released,
+ *    fixed size pool is exhausted after all buffers are taken.
+ */
+TEST_F(dpcp_buffer_pool, ti_02_alloc_release)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    const uint32_t bufs_num = 8;
+    buffer_pool_attr attr = {1024, 64, 0, bufs_num, 1, 4, MKEY_NONE};
+    buffer_pool* pool = nullptr;
+    ret = ad->create_buffer_pool(attr, pool);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    pool_buf* bufs[bufs_num] = {};
+    for (uint32_t i = 0; i < bufs_num; i++) {
+        ret = pool->alloc(bufs[i]);
+        ASSERT_EQ(DPCP_OK, ret);
+        ASSERT_NE(nullptr, bufs[i]);
+        ASSERT_EQ(1U, bufs[i]->refcnt.load());
+        ASSERT_EQ(1024U, bufs[i]->len);
+        ASSERT_NE(0U, bufs[i]->lkey);
+    }
+    pool_buf* extra = nullptr;
+    ret = pool->alloc(extra);
+    ASSERT_EQ(DPCP_ERR_NO_MEMORY, ret);
+
+    // Buffer handed to application stays in use after RX path released it.
+    pool->ref(bufs[0]);
+    pool->release(bufs[0]);
+    ret = pool->alloc(extra);
+    ASSERT_EQ(DPCP_ERR_NO_MEMORY, ret);
+
+    pool->release(bufs[0]);
+    ret = pool->alloc(extra);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(bufs[0], extra);
+
+    for (uint32_t i = 0; i < bufs_num; i++) {
+        pool->release(bufs[i]);
+    }
+
+    delete pool;
+    delete ad;
+}
+
+/**
+ * @test dpcp_buffer_pool.ti_03_grow
+ * @brief
+ *    Check buffer_pool grows by slabs up to max_slabs_num
+ * @details
+ *
+ */
+TEST_F(dpcp_buffer_pool, ti_03_grow)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    const uint32_t bufs_num = 4;
+    buffer_pool_attr attr = {512, 0, 0, bufs_num, 2, 0, MKEY_NONE};
+    buffer_pool* pool = nullptr;
+    ret = ad->create_buffer_pool(attr, pool);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    pool_buf* bufs[2 * bufs_num] = {};
+    for (uint32_t i = 0; i < 2 * bufs_num; i++) {
+        ret = pool->alloc(bufs[i]);
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+    uint32_t slabs_num = 0;
+    ret = pool->get_slabs_num(slabs_num);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(2U, slabs_num);
+    ASSERT_NE(bufs[0]->lkey, bufs[bufs_num]->lkey);
+
+    pool_buf* extra = nullptr;
+    ret = pool->alloc(extra);
+    ASSERT_EQ(DPCP_ERR_NO_MEMORY, ret);
+
+    for (uint32_t i = 0; i < 2 * bufs_num; i++) {
+        pool->release(bufs[i]);
+    }
+
+    delete pool;
+    delete ad;
+}
+
+/**
+ * @test dpcp_buffer_pool.ti_04_refill_regular_rq
+ * @brief
+ *    Check buffer_pool::refill posts buffers to regular RQ
+ * @details
+ *
+ */
+TEST_F(dpcp_buffer_pool, ti_04_refill_regular_rq)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    cq_data cqd = {};
+    ret = (status)create_cq(ad, &cqd);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    const uint32_t wqe_num = 16;
+    rq_attr rqattr = {};
+    rqattr.cqn = cqd.cqn;
+    rqattr.wqe_num = wqe_num;
+    rqattr.wqe_sz = 2;
+    regular_rq* rrq = nullptr;
+    ret = ad->create_regular_rq(rqattr, rrq);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    buffer_pool_attr attr = {2048, 64, 0, wqe_num, 1, 0, MKEY_NONE};
+    buffer_pool* pool = nullptr;
+    ret = ad->create_buffer_pool(attr, pool);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    pool_buf* ring[wqe_num] = {};
+    uint32_t wqe_head = 0;
+    uint32_t wqe_cnt = wqe_num;
+    ret = pool->refill(*rrq, wqe_head, wqe_cnt, ring);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(wqe_num, wqe_cnt);
+    ASSERT_EQ(wqe_num, wqe_head);
+
+    uint32_t* dbrec = nullptr;
+    ret = rrq->get_dbrec(dbrec);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(wqe_num, be32toh(dbrec[0]));
+
+    void* wq_buf = nullptr;
+    ret = rrq->get_wq_buf(wq_buf);
+    ASSERT_EQ(DPCP_OK, ret);
+    mlx5_wqe_data_seg* dseg = (mlx5_wqe_data_seg*)wq_buf;
+    ASSERT_EQ((uint64_t)ring[0]->addr, be64toh(dseg[0].addr));
+    ASSERT_EQ(ring[0]->lkey, be32toh(dseg[0].lkey));
+    ASSERT_EQ((uint32_t)MLX5_INVALID_LKEY, be32toh(dseg[1].lkey));
+
+    // Pool is exhausted, nothing is posted.
+    wqe_cnt = 1;
+    ret = pool->refill(*rrq, wqe_head, wqe_cnt, ring);
+    ASSERT_EQ(DPCP_ERR_NO_MEMORY, ret);
+    ASSERT_EQ(0U, wqe_cnt);
+
+    for (uint32_t i = 0; i < wqe_num; i++) {
+        pool->release(ring[i]);
+    }
+
+    delete pool;
+    delete rrq;
+    delete ad;
+}
@@ -0,0 +1,303 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+
+#include "dpcp_base.h"
+
+using namespace dpcp;
+
+class dpcp_cmd_batch : /*public obj,*/ public dpcp_base {
+};
+
+static tis* create_test_tis(adapter* ad)
+{
+    tis* t = nullptr;
+    struct tis::attr tis_attr;
+    memset(&tis_attr, 0, sizeof(tis_attr));
+    tis_attr.flags = TIS_ATTR_TRANSPORT_DOMAIN;
+    tis_attr.transport_domain = ad->get_td();
+    status ret = ad->create_tis(tis_attr, t);
+    return (DPCP_OK == ret) ? t : nullptr;
+}
+
+/**
+ * @test dpcp_cmd_batch.ti_01_create
+ * @brief
+ *    Check adapter::create_cmd_batch method
+ * @details
+ *
+ */
+TEST_F(dpcp_cmd_batch, ti_01_create)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    cmd_batch* batch = nullptr;
+    ret = ad->create_cmd_batch(0, batch);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    ret = ad->create_cmd_batch(8, batch);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, batch);
+    ASSERT_EQ(8U, batch->get_depth());
+    log_trace("async query: %d\n", batch->is_async_query());
+
+    delete batch;
+    delete ad;
+}
+
+/**
+ * @test dpcp_cmd_batch.ti_02_submit_create
+ * @brief
+ *    Check cmd_batch::submit creates objects concurrently
+ * @details
+ *    More commands than depth are submitted, results are returned
+ *    both by futures and callbacks.
+ */
+TEST_F(dpcp_cmd_batch, ti_02_submit_create)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    cmd_batch* batch = nullptr;
+    ret = ad->create_cmd_batch(4, batch);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    const int num = 64;
+    std::vector<tis*> tises(num, nullptr);
+    std::vector<std::future<status>> results(num / 2);
+    std::atomic<int> cb_ok(0);
+
+    for (int i = 0; i < num; i++) {
+        tis** t = &tises[i];
+        cmd_fn fn = [ad, t]() {
+            *t = create_test_tis(ad);
+            return (nullptr != *t) ? DPCP_OK : DPCP_ERR_CREATE;
+        };
+        if (i % 2) {
+            ret = batch->submit(fn, [&cb_ok](status st) {
+                if (DPCP_OK == st) {
+                    cb_ok++;
+                }
+            });
+        } else {
+            ret = batch->submit(fn, results[i / 2]);
+        }
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+
+    ret = batch->wait_all();
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(num / 2, cb_ok.load());
+    for (auto& res : results) {
+        ASSERT_EQ(DPCP_OK, res.get());
+    }
+
+    std::unordered_set<uint32_t> ids;
+    for (auto t : tises) {
+        ASSERT_NE(nullptr, t);
+        uint32_t tisn = 0;
+        ret = t->get_tisn(tisn);
+        ASSERT_EQ(DPCP_OK, ret);
+        ids.insert(tisn);
+        delete t;
+    }
+    ASSERT_EQ((size_t)num, ids.size());
+
+    delete batch;
+    delete ad;
+}
+
+/**
+ * @test dpcp_cmd_batch.ti_03_query
+ * @brief
+ *    Check cmd_batch::query with more queries than depth
+ * @details
+ *
+ */
+TEST_F(dpcp_cmd_batch, ti_03_query)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    tis* t = create_test_tis(ad);
+    ASSERT_NE(nullptr, t);
+    uint32_t tisn = 0;
+    ret = t->get_tisn(tisn);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    cmd_batch* batch = nullptr;
+    ret = ad->create_cmd_batch(2, batch);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    const int num = 8;
+    uint32_t in[DEVX_ST_SZ_DW(query_tis_in)] = {0};
+    DEVX_SET(query_tis_in, in, opcode, MLX5_CMD_OP_QUERY_TIS);
+    DEVX_SET(query_tis_in, in, tisn, tisn);
+    std::vector<std::vector<uint32_t>> outs(num,
+                                            std::vector<uint32_t>(DEVX_ST_SZ_DW(query_tis_out)));
+    std::atomic<int> done(0);
+
+    for (int i = 0; i < num; i++) {
+        ret = batch->query(*t, in, sizeof(in), outs[i].data(), DEVX_ST_SZ_BYTES(query_tis_out),
+                           [&done](status st) {
+                               if (DPCP_OK == st) {
+                                   done++;
+                               }
+                           });
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+    ret = batch->wait_all();
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(num, done.load());
+
+    for (auto& out : outs) {
+        void* tis_ctx = DEVX_ADDR_OF(query_tis_out, out.data(), tis_context);
+        ASSERT_EQ(ad->get_td(), DEVX_GET(tisc, tis_ctx, transport_domain));
+    }
+
+    delete batch;
+    delete t;
+    delete ad;
+}
+
+/**
+ * @test dpcp_cmd_batch.ti_04_query_from_cb
+ * @brief
+ *    Check cmd_batch::query called from query completion callback
+ * @details
+ *    Every completion issues the next query, batches share adapter workers.
+ */
+TEST_F(dpcp_cmd_batch, ti_04_query_from_cb)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    tis* t = create_test_tis(ad);
+    ASSERT_NE(nullptr, t);
+    uint32_t tisn = 0;
+    ret = t->get_tisn(tisn);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    uint32_t in[DEVX_ST_SZ_DW(query_tis_in)] = {0};
+    DEVX_SET(query_tis_in, in, opcode, MLX5_CMD_OP_QUERY_TIS);
+    DEVX_SET(query_tis_in, in, tisn, tisn);
+    std::vector<uint32_t> out(DEVX_ST_SZ_DW(query_tis_out));
+
+    for (int round = 0; round < 2; round++) {
+        cmd_batch* batch = nullptr;
+        ret = ad->create_cmd_batch(1, batch);
+        ASSERT_EQ(DPCP_OK, ret);
+
+        const int num = 4;
+        std::atomic<int> done(0);
+        std::function<void(status)> cb = [&](status st) {
+            if (DPCP_OK == st && ++done < num) {
+                batch->query(*t, in, sizeof(in), out.data(), DEVX_ST_SZ_BYTES(query_tis_out), cb);
+            }
+        };
+        ret = batch->query(*t, in, sizeof(in), out.data(), DEVX_ST_SZ_BYTES(query_tis_out), cb);
+        ASSERT_EQ(DPCP_OK, ret);
+        ret = batch->wait_all();
+        ASSERT_EQ(DPCP_OK, ret);
+        ASSERT_EQ(num, done.load());
+
+        delete batch;
+    }
+
+    delete t;
+    delete ad;
+}
+
+/**
+ * @test dpcp_cmd_batch.ti_05_submit_depth
+ * @brief
+ *    Check cmd_batch::submit keeps no more than depth commands in flight
+ * @details
+ *    Worker pool is grown by a deeper batch, commands of the shallow batch
+ *    must still run at most depth at a time.
+ */
+TEST_F(dpcp_cmd_batch, ti_05_submit_depth)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    cmd_batch* deep = nullptr;
+    ret = ad->create_cmd_batch(16, deep);
+    ASSERT_EQ(DPCP_OK, ret);
+    cmd_batch* batch = nullptr;
+    ret = ad->create_cmd_batch(2, batch);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    std::atomic<uint32_t> in_flight(0);
+    std::atomic<uint32_t> max_in_flight(0);
+    for (int i = 0; i < 32; i++) {
+        ret = batch->submit(
+            [&in_flight, &max_in_flight]() {
+                uint32_t cur = ++in_flight;
+                uint32_t prev = max_in_flight.load();
+                while (prev < cur && !max_in_flight.compare_exchange_weak(prev, cur)) {
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                in_flight--;
+                return DPCP_OK;
+            },
+            nullptr);
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+
+    ret = batch->wait_all();
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_LE(max_in_flight.load(), batch->get_depth());
+
+    delete batch;
+    delete deep;
+    delete ad;
+}
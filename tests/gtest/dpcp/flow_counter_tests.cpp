@@ -0,0 +1,530 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+
+#include "dpcp_base.h"
+
+using namespace dpcp;
+
+class dpcp_flow_counter : public dpcp_base {};
+
+/**
+ * @test dpcp_flow_counter.ti_01_create
+ * @brief
+ *    Check adapter::create_flow_counter_bulk method
+ * @details
+ *
+ */
+TEST_F(dpcp_flow_counter, ti_01_create)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    adapter_hca_capabilities caps;
+    ASSERT_EQ(DPCP_OK, ad->get_hca_capabilities(caps));
+    if (!caps.flow_table_caps.receive.is_flow_action_counter_supported) {
+        log_trace("Flow counters are not supported\n");
+        delete ad;
+        return;
+    }
+
+    flow_counter_bulk* bulk = nullptr;
+    status ret = ad->create_flow_counter_bulk(0, bulk);
+    ASSERT_EQ(DPCP_ERR_OUT_OF_RANGE, ret);
+
+    ret = ad->create_flow_counter_bulk(200, bulk);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, bulk);
+    ASSERT_EQ(256U, bulk->get_size());
+
+    uint32_t id = 0;
+    ret = bulk->get_counter_id(255, id);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = bulk->get_counter_id(256, id);
+    ASSERT_EQ(DPCP_ERR_OUT_OF_RANGE, ret);
+
+    std::vector<flow_counter_stats> stats;
+    ret = bulk->query(3, 10, stats);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(10U, stats.size());
+    for (auto& s : stats) {
+        ASSERT_EQ(0U, s.packets);
+        ASSERT_EQ(0U, s.bytes);
+    }
+    ret = bulk->query(250, 10, stats);
+    ASSERT_EQ(DPCP_ERR_OUT_OF_RANGE, ret);
+
+    ASSERT_EQ(nullptr, bulk->get_snapshot());
+    ret = bulk->refresh_snapshot();
+    ASSERT_EQ(DPCP_OK, ret);
+    std::shared_ptr<const flow_counter_snapshot> snap = bulk->get_snapshot();
+    ASSERT_NE(nullptr, snap);
+    ASSERT_EQ(256U, snap->stats.size());
+    ASSERT_EQ(1U, snap->generation);
+
+    delete bulk;
+    delete ad;
+}
+
+/**
+ * @test dpcp_flow_counter.ti_02_parse
+ * @brief
+ *    Check flow_counter_bulk::parse method
+ * @details
+ *    Converts big endian records as written by HW.
+ */
+TEST_F(dpcp_flow_counter, ti_02_parse)
+{
+    uint8_t records[3 * flow_counter_bulk::FLOW_COUNTER_RECORD_SIZE] = {0};
+
+    for (uint32_t i = 0; i < 3; i++) {
+        void* rec = records + i * flow_counter_bulk::FLOW_COUNTER_RECORD_SIZE;
+        DEVX_SET64(traffic_counter, rec, packets, 0x100000000ULL + i);
+        DEVX_SET64(traffic_counter, rec, octets, 64 * (i + 1));
+    }
+
+    flow_counter_stats stats[3];
+    flow_counter_bulk::parse(records, 3, stats);
+    for (uint32_t i = 0; i < 3; i++) {
+        ASSERT_EQ(0x100000000ULL + i, stats[i].packets);
+        ASSERT_EQ(64U * (i + 1), stats[i].bytes);
+    }
+}
+
+/**
+ * @test dpcp_flow_counter.ti_03_apply
+ * @brief
+ *    Check flow_action_counter::apply method
+ * @details
+ *    Counter entry follows the destination entries of the FTE.
+ */
+TEST_F(dpcp_flow_counter, ti_03_apply)
+{
+    std::vector<uint8_t> in(DEVX_ST_SZ_BYTES(set_fte_in) + 3 * DEVX_ST_SZ_BYTES(dest_format_struct),
+                            0);
+    void* flow_context = DEVX_ADDR_OF(set_fte_in, in.data(), flow_context);
+    DEVX_SET(flow_context, flow_context, destination_list_size, 2);
+
+    flow_action_counter action(nullptr, 0x1234);
+    status ret = action.apply(in.data());
+    ASSERT_EQ(DPCP_OK, ret);
+
+    uint8_t* entry = (uint8_t*)DEVX_ADDR_OF(flow_context, flow_context, destination) +
+        2 * DEVX_ST_SZ_BYTES(dest_format_struct);
+    ASSERT_EQ(0x1234U, DEVX_GET(flow_counter_list, entry, flow_counter_id));
+    ASSERT_EQ(1U, DEVX_GET(flow_context, flow_context, flow_counter_list_size));
+    ASSERT_EQ(2U, DEVX_GET(flow_context, flow_context, destination_list_size));
+    ASSERT_TRUE(DEVX_GET(flow_context, flow_context, action) & MLX5_FLOW_CONTEXT_ACTION_COUNT);
+
+    uint32_t id = 0;
+    action.get_id(id);
+    ASSERT_EQ(0x1234U, id);
+}
+
+/**
+ * @test dpcp_flow_counter.ti_04_add_flow_rule_counter
+ * @brief
+ *    Check flow rule with forward and counter actions
+ * @details
+ *
+ */
+TEST_F(dpcp_flow_counter, ti_04_add_flow_rule_counter)
+{
+    status ret = DPCP_OK;
+
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    adapter_hca_capabilities caps;
+    ASSERT_EQ(DPCP_OK, ad->get_hca_capabilities(caps));
+    if (!caps.flow_table_caps.receive.is_flow_action_counter_supported) {
+        log_trace("Flow counters are not supported\n");
+        delete ad;
+        return;
+    }
+
+    flow_table_attr ft_attr;
+    ft_attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr.flags = 0;
+    ft_attr.level = 1;
+    ft_attr.log_size = 10;
+    ft_attr.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr.type = flow_table_type::FT_RX;
+
+    std::shared_ptr<flow_table> ft_obj;
+    ad->create_flow_table(ft_attr, ft_obj);
+    ret = ft_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_table_attr ft_attr_fwd = ft_attr;
+    ft_attr_fwd.level = 2;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    ad->create_flow_table(ft_attr_fwd, ft_fwd_obj);
+    ret = ft_fwd_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = 1;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_obj;
+    ret = ft_obj->add_flow_group(fg_attr, fg_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fg_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_counter_bulk* bulk = nullptr;
+    ret = ad->create_flow_counter_bulk(1, bulk);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_action_generator& action_gen = ad->get_flow_action_generator();
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd_obj.get());
+    std::shared_ptr<flow_action> fa_fwd(action_gen.create_fwd(dests));
+    std::shared_ptr<flow_action> fa_counter(action_gen.create_counter(*bulk, 0));
+    ASSERT_NE(nullptr, fa_counter);
+    ASSERT_EQ(nullptr, action_gen.create_counter(*bulk, 1));
+
+    flow_rule_attr_ex fr_attr;
+    fr_attr.priority = 3;
+    fr_attr.flow_index = 0;
+    fr_attr.match_value.match_lyr2.ethertype = 0x800;
+    fr_attr.actions.push_back(fa_fwd);
+    fr_attr.actions.push_back(fa_counter);
+
+    std::weak_ptr<flow_rule_ex> fr_obj;
+    ret = fg_obj.lock()->add_flow_rule(fr_attr, fr_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fr_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    std::vector<flow_counter_stats> stats;
+    ret = bulk->query(0, 1, stats);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    ret = fg_obj.lock()->remove_flow_rule(fr_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    delete bulk;
+    delete ad;
+}
+
+/**
+ * @test dpcp_flow_counter.ti_05_aging
+ * @brief
+ *    Check flow_aging start and sweep without tracked rules
+ * @details
+ *
+ */
+TEST_F(dpcp_flow_counter, ti_05_aging)
+{
+    flow_aging_attr attr = {};
+    attr.timeout_ms = 100;
+
+    flow_aging aging(attr, nullptr);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, aging.start());
+
+    uint32_t aged = 1;
+    ASSERT_EQ(DPCP_OK, aging.sweep(aged));
+    ASSERT_EQ(0U, aged);
+    ASSERT_EQ(0U, aging.get_tracked());
+
+    std::vector<flow_aging_entry> entries;
+    aging.get_aged(entries);
+    ASSERT_TRUE(entries.empty());
+
+    attr.sweep_interval_ms = 1;
+    flow_aging aging_bg(attr, nullptr);
+    ASSERT_EQ(DPCP_OK, aging_bg.start());
+    ASSERT_EQ(DPCP_OK, aging_bg.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    aging_bg.stop();
+    aging_bg.stop();
+}
+
+/**
+ * @test dpcp_flow_counter.ti_06_aging_remove
+ * @brief
+ *    Check flow_aging removes flow rule without traffic
+ * @details
+ *
+ */
+TEST_F(dpcp_flow_counter, ti_06_aging_remove)
+{
+    status ret = DPCP_OK;
+
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    adapter_hca_capabilities caps;
+    ASSERT_EQ(DPCP_OK, ad->get_hca_capabilities(caps));
+    if (!caps.flow_table_caps.receive.is_flow_action_counter_supported) {
+        log_trace("Flow counters are not supported\n");
+        delete ad;
+        return;
+    }
+
+    flow_table_attr ft_attr;
+    ft_attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr.flags = 0;
+    ft_attr.level = 1;
+    ft_attr.log_size = 10;
+    ft_attr.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr.type = flow_table_type::FT_RX;
+
+    std::shared_ptr<flow_table> ft_obj;
+    ad->create_flow_table(ft_attr, ft_obj);
+    ret = ft_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_table_attr ft_attr_fwd = ft_attr;
+    ft_attr_fwd.level = 2;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    ad->create_flow_table(ft_attr_fwd, ft_fwd_obj);
+    ret = ft_fwd_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = 1;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_obj;
+    ret = ft_obj->add_flow_group(fg_attr, fg_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fg_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_counter_bulk* bulk = nullptr;
+    ret = ad->create_flow_counter_bulk(1, bulk);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_action_generator& action_gen = ad->get_flow_action_generator();
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd_obj.get());
+
+    flow_rule_attr_ex fr_attr;
+    fr_attr.priority = 3;
+    fr_attr.flow_index = 0;
+    fr_attr.match_value.match_lyr2.ethertype = 0x800;
+    fr_attr.actions.push_back(action_gen.create_fwd(dests));
+    fr_attr.actions.push_back(action_gen.create_counter(*bulk, 0));
+
+    std::weak_ptr<flow_rule_ex> fr_obj;
+    ret = fg_obj.lock()->add_flow_rule(fr_attr, fr_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fr_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_aging_attr attr = {};
+    attr.timeout_ms = 0;
+    attr.remove_batch = 16;
+    std::vector<flow_aging_entry> reported;
+    flow_aging aging(attr, [&reported](const std::vector<flow_aging_entry>& entries) {
+        reported.insert(reported.end(), entries.begin(), entries.end());
+    });
+
+    ASSERT_EQ(DPCP_ERR_OUT_OF_RANGE, aging.track(*bulk, 1, fg_obj, fr_obj, 7));
+    ASSERT_EQ(DPCP_OK, aging.track(*bulk, 0, fg_obj, fr_obj, 7));
+    ASSERT_EQ(1U, aging.get_tracked());
+
+    // The first sweep takes base values of the counter.
+    uint32_t aged = 0;
+    ASSERT_EQ(DPCP_OK, aging.sweep(aged));
+    ASSERT_EQ(0U, aged);
+
+    ASSERT_EQ(DPCP_OK, aging.sweep(aged));
+    ASSERT_EQ(1U, aged);
+    ASSERT_EQ(1U, reported.size());
+    ASSERT_EQ(7U, reported[0].cookie);
+    ASSERT_EQ(0U, reported[0].offset);
+    ASSERT_TRUE(reported[0].removed);
+    ASSERT_EQ(0U, aging.get_tracked());
+    flow_index_stats fi_stats;
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->get_flow_index_stats(fi_stats));
+    ASSERT_EQ(0U, fi_stats.used);
+
+    delete bulk;
+    delete ad;
+}
+
+/**
+ * @test dpcp_flow_counter.ti_07_query_clear
+ * @brief
+ *    Check flow_counter_bulk::query clears only the requested counters
+ * @details
+ *    Counters are cleared one at a time when the range is not aligned, so
+ *    neighbours read by the same aligned query keep their values.
+ */
+TEST_F(dpcp_flow_counter, ti_07_query_clear)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    adapter_hca_capabilities caps;
+    ASSERT_EQ(DPCP_OK, ad->get_hca_capabilities(caps));
+    if (!caps.flow_table_caps.receive.is_flow_action_counter_supported) {
+        log_trace("Flow counters are not supported\n");
+        delete ad;
+        return;
+    }
+
+    flow_counter_bulk* bulk = nullptr;
+    status ret = ad->create_flow_counter_bulk(128, bulk);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    std::vector<flow_counter_stats> before;
+    ret = bulk->query(0, 4, before);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    std::vector<flow_counter_stats> stats;
+    ret = bulk->query(1, 1, stats, true);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(1U, stats.size());
+    ret = bulk->query(1, 2, stats, true);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(2U, stats.size());
+    ret = bulk->query(126, 4, stats, true);
+    ASSERT_EQ(DPCP_ERR_OUT_OF_RANGE, ret);
+
+    std::vector<flow_counter_stats> after;
+    ret = bulk->query(0, 4, after);
+    ASSERT_EQ(DPCP_OK, ret);
+    // Counters only grow unless cleared.
+    ASSERT_LE(before[0].packets, after[0].packets);
+    ASSERT_LE(before[0].bytes, after[0].bytes);
+    ASSERT_LE(before[3].packets, after[3].packets);
+    ASSERT_LE(before[3].bytes, after[3].bytes);
+
+    delete bulk;
+    delete ad;
+}
+
+/**
+ * @test dpcp_flow_counter.ti_08_aging_delete_bulk
+ * @brief
+ *    Check flow_aging with a bulk deleted between two sweeps
+ * @details
+ *    Background sweep keeps running while bulks are untracked and deleted.
+ */
+TEST_F(dpcp_flow_counter, ti_08_aging_delete_bulk)
+{
+    status ret = DPCP_OK;
+
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    adapter_hca_capabilities caps;
+    ASSERT_EQ(DPCP_OK, ad->get_hca_capabilities(caps));
+    if (!caps.flow_table_caps.receive.is_flow_action_counter_supported) {
+        log_trace("Flow counters are not supported\n");
+        delete ad;
+        return;
+    }
+
+    flow_table_attr ft_attr;
+    ft_attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr.flags = 0;
+    ft_attr.level = 1;
+    ft_attr.log_size = 10;
+    ft_attr.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr.type = flow_table_type::FT_RX;
+
+    std::shared_ptr<flow_table> ft_obj;
+    ad->create_flow_table(ft_attr, ft_obj);
+    ret = ft_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = 1;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_obj;
+    ret = ft_obj->add_flow_group(fg_attr, fg_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fg_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_counter_bulk* bulk1 = nullptr;
+    ret = ad->create_flow_counter_bulk(4, bulk1);
+    ASSERT_EQ(DPCP_OK, ret);
+    flow_counter_bulk* bulk2 = nullptr;
+    ret = ad->create_flow_counter_bulk(4, bulk2);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_aging_attr attr = {};
+    attr.timeout_ms = 60000;
+    attr.sweep_interval_ms = 1;
+    flow_aging aging(attr, nullptr);
+
+    ASSERT_EQ(DPCP_OK, aging.track_compact(*bulk1, 0, fg_obj, 0));
+    ASSERT_EQ(DPCP_OK, aging.track_compact(*bulk1, 1, fg_obj, 1));
+    ASSERT_EQ(DPCP_OK, aging.track_compact(*bulk2, 0, fg_obj, 2));
+    ASSERT_EQ(3U, aging.get_tracked());
+    ASSERT_EQ(DPCP_OK, aging.start());
+
+    uint32_t aged = 0;
+    ASSERT_EQ(DPCP_OK, aging.sweep(aged));
+    ASSERT_EQ(0U, aged);
+
+    ASSERT_EQ(DPCP_OK, aging.untrack_bulk(*bulk1));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, aging.untrack_bulk(*bulk1));
+    ASSERT_EQ(1U, aging.get_tracked());
+    delete bulk1;
+
+    ASSERT_EQ(DPCP_OK, aging.sweep(aged));
+    ASSERT_EQ(0U, aged);
+
+    // Untrack of the last counter releases the bulk as well.
+    ASSERT_EQ(DPCP_OK, aging.untrack(*bulk2, 0));
+    ASSERT_EQ(0U, aging.get_tracked());
+    delete bulk2;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(DPCP_OK, aging.sweep(aged));
+    ASSERT_EQ(0U, aged);
+    aging.stop();
+
+    delete ad;
+}
@@ -429,3 +429,397 @@ TEST_F(dpcp_flow_group, ti_06_create_flow_group_with_meta_register_c_0)
 
     delete adapter_obj;
 }
+
+/**
+ * @test dpcp_flow_group.ti_07_match_ipv6
+ * @brief
+ *    Check IPv6 fields of flow matcher against PRM layout
+ * @details
+ *    Addresses are copied in network order to ipv6_layout, traffic class is
+ *    split to DSCP and ECN and flow label goes to misc parameters.
+ */
+TEST_F(dpcp_flow_group, ti_07_match_ipv6)
+{
+    const uint8_t src[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+    const uint8_t dst[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02};
+
+    flow_matcher_attr matcher_attr;
+    matcher_attr.match_criteria_enabled = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR |
+        flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS;
+    match_params_lyr_3& mask = matcher_attr.match_criteria.match_lyr3;
+    memset(mask.src_ipv6, 0xFF, sizeof(mask.src_ipv6));
+    memset(mask.dst_ipv6, 0xFF, sizeof(mask.dst_ipv6));
+    mask.traffic_class = 0xFF;
+    mask.flow_label = 0xFFFFF;
+    flow_matcher matcher(matcher_attr);
+
+    match_params_ex value;
+    memcpy(value.match_lyr3.src_ipv6, src, sizeof(src));
+    memcpy(value.match_lyr3.dst_ipv6, dst, sizeof(dst));
+    value.match_lyr3.traffic_class = 0xB9; // DSCP 46, ECN 1
+    value.match_lyr3.flow_label = 0x12345;
+
+    uint32_t prm[DEVX_ST_SZ_DW(fte_match_param)] = {0};
+    ASSERT_EQ(DPCP_OK, matcher.apply(prm, value));
+    void* outer = DEVX_ADDR_OF(fte_match_param, prm, outer_headers);
+    void* misc = DEVX_ADDR_OF(fte_match_param, prm, misc_parameters);
+    ASSERT_EQ(0, memcmp(src,
+                        DEVX_ADDR_OF(fte_match_set_lyr_2_4, outer,
+                                     src_ipv4_src_ipv6.ipv6_layout.ipv6),
+                        sizeof(src)));
+    ASSERT_EQ(0, memcmp(dst,
+                        DEVX_ADDR_OF(fte_match_set_lyr_2_4, outer,
+                                     dst_ipv4_dst_ipv6.ipv6_layout.ipv6),
+                        sizeof(dst)));
+    ASSERT_EQ(46U, DEVX_GET(fte_match_set_lyr_2_4, outer, ip_dscp));
+    ASSERT_EQ(1U, DEVX_GET(fte_match_set_lyr_2_4, outer, ip_ecn));
+    ASSERT_EQ(0x12345U, DEVX_GET(fte_match_set_misc, misc, outer_ipv6_flow_label));
+
+    // Flow label is not set without misc parameters.
+    matcher_attr.match_criteria_enabled = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    flow_matcher outer_matcher(matcher_attr);
+    memset(prm, 0, sizeof(prm));
+    ASSERT_EQ(DPCP_OK, outer_matcher.apply(prm, value));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_misc, misc, outer_ipv6_flow_label));
+
+    // IPv4 and IPv6 addresses share the same place.
+    matcher_attr.match_criteria.match_lyr3.src_ip = 0xFFFFFFFF;
+    flow_matcher bad_matcher(matcher_attr);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, bad_matcher.apply(prm, value));
+}
+
+/**
+ * @test dpcp_flow_group.ti_08_create_flow_group_ipv6
+ * @brief
+ *    Check flow group and rule with IPv6 5-tuple and flow label
+ * @details
+ */
+TEST_F(dpcp_flow_group, ti_08_create_flow_group_ipv6)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    flow_table_attr ft_attr;
+    ft_attr.level = 1;
+    ft_attr.log_size = 4;
+    ft_attr.type = flow_table_type::FT_RX;
+    std::shared_ptr<flow_table> ft_obj;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(ft_attr, ft_obj));
+    ASSERT_EQ(DPCP_OK, ft_obj->create());
+    ft_attr.level = 2;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(ft_attr, ft_fwd_obj));
+    ASSERT_EQ(DPCP_OK, ft_fwd_obj->create());
+
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = 15;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR |
+        flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS;
+    match_params_ex& mask = fg_attr.match_criteria;
+    mask.match_lyr2.ethertype = 0xFFFF;
+    memset(mask.match_lyr3.src_ipv6, 0xFF, sizeof(mask.match_lyr3.src_ipv6));
+    memset(mask.match_lyr3.dst_ipv6, 0xFF, sizeof(mask.match_lyr3.dst_ipv6));
+    mask.match_lyr3.ip_protocol = 0xFF;
+    mask.match_lyr3.flow_label = 0xFFFFF;
+    mask.match_lyr4.type = match_params_lyr_4_type::UDP;
+    mask.match_lyr4.dst_port = 0xFFFF;
+    mask.match_lyr4.src_port = 0xFFFF;
+    std::weak_ptr<flow_group> fg_obj;
+    ASSERT_EQ(DPCP_OK, ft_obj->add_flow_group(fg_attr, fg_obj));
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->create());
+
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd_obj.get());
+    flow_rule_attr_ex fr_attr;
+    fr_attr.actions.push_back(adapter_obj->get_flow_action_generator().create_fwd(dests));
+    match_params_ex& value = fr_attr.match_value;
+    value.match_lyr2.ethertype = 0x86DD;
+    memset(value.match_lyr3.src_ipv6, 0x11, sizeof(value.match_lyr3.src_ipv6));
+    memset(value.match_lyr3.dst_ipv6, 0x22, sizeof(value.match_lyr3.dst_ipv6));
+    value.match_lyr3.ip_protocol = 0x11;
+    value.match_lyr3.flow_label = 0x12345;
+    value.match_lyr4.type = match_params_lyr_4_type::UDP;
+    value.match_lyr4.dst_port = 0xc350;
+    value.match_lyr4.src_port = 0x1234;
+    std::weak_ptr<flow_rule_ex> fr_obj;
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->add_flow_rule(fr_attr, fr_obj));
+    ASSERT_EQ(DPCP_OK, fr_obj.lock()->create());
+
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_group.ti_09_match_tunnel
+ * @brief
+ *    Check tunnel fields of flow matcher against PRM layout
+ * @details
+ *    Inner headers go to inner_headers, VNI and GENEVE fields go to misc
+ *    parameters and GENEVE TLV option data goes to misc parameters 3.
+ */
+TEST_F(dpcp_flow_group, ti_09_match_tunnel)
+{
+    flow_matcher_attr matcher_attr;
+    matcher_attr.match_criteria_enabled = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR |
+        flow_group_match_criteria_enable::FG_MATCH_INNER_HDR |
+        flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS |
+        flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS_3;
+    match_params_ex& mask = matcher_attr.match_criteria;
+    mask.match_lyr4.type = match_params_lyr_4_type::UDP;
+    mask.match_lyr4.dst_port = 0xFFFF;
+    mask.match_inner_lyr2.ethertype = 0xFFFF;
+    mask.match_inner_lyr3.dst_ip = 0xFFFFFFFF;
+    mask.match_inner_lyr3.flow_label = 0xFFFFF;
+    mask.match_inner_lyr4.type = match_params_lyr_4_type::TCP;
+    mask.match_inner_lyr4.dst_port = 0xFFFF;
+    mask.match_tunnel.geneve_vni = 0xFFFFFF;
+    mask.match_tunnel.geneve_oam = 0x1;
+    mask.match_tunnel.geneve_opt_len = 0x3F;
+    mask.match_tunnel.geneve_protocol_type = 0xFFFF;
+    mask.match_tunnel.geneve_tlv_option_0_data = 0xFFFFFFFF;
+    flow_matcher matcher(matcher_attr);
+
+    match_params_ex value;
+    value.match_lyr4.type = match_params_lyr_4_type::UDP;
+    value.match_lyr4.dst_port = 6081;
+    value.match_inner_lyr2.ethertype = 0x0800;
+    value.match_inner_lyr3.dst_ip = 0x0a000001;
+    value.match_inner_lyr3.flow_label = 0x54321;
+    value.match_inner_lyr4.type = match_params_lyr_4_type::TCP;
+    value.match_inner_lyr4.dst_port = 80;
+    value.match_tunnel.geneve_vni = 0xABCDEF;
+    value.match_tunnel.geneve_oam = 0x1;
+    value.match_tunnel.geneve_opt_len = 0x2;
+    value.match_tunnel.geneve_protocol_type = 0x6558;
+    value.match_tunnel.geneve_tlv_option_0_data = 0xDEADBEEF;
+
+    uint32_t prm[DEVX_ST_SZ_DW(fte_match_param)] = {0};
+    ASSERT_EQ(DPCP_OK, matcher.apply(prm, value));
+    void* outer = DEVX_ADDR_OF(fte_match_param, prm, outer_headers);
+    void* inner = DEVX_ADDR_OF(fte_match_param, prm, inner_headers);
+    void* misc = DEVX_ADDR_OF(fte_match_param, prm, misc_parameters);
+    void* misc3 = DEVX_ADDR_OF(fte_match_param, prm, misc_parameters_3);
+    ASSERT_EQ(6081U, DEVX_GET(fte_match_set_lyr_2_4, outer, udp_dport));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_lyr_2_4, outer, ethertype));
+    ASSERT_EQ(0x0800U, DEVX_GET(fte_match_set_lyr_2_4, inner, ethertype));
+    ASSERT_EQ(0x0a000001U,
+              DEVX_GET(fte_match_set_lyr_2_4, inner, dst_ipv4_dst_ipv6.ipv4_layout.ipv4));
+    ASSERT_EQ(80U, DEVX_GET(fte_match_set_lyr_2_4, inner, tcp_dport));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_lyr_2_4, inner, udp_dport));
+    ASSERT_EQ(0x54321U, DEVX_GET(fte_match_set_misc, misc, inner_ipv6_flow_label));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_misc, misc, outer_ipv6_flow_label));
+    ASSERT_EQ(0xABCDEFU, DEVX_GET(fte_match_set_misc, misc, geneve_vni));
+    ASSERT_EQ(1U, DEVX_GET(fte_match_set_misc, misc, geneve_oam));
+    ASSERT_EQ(2U, DEVX_GET(fte_match_set_misc, misc, geneve_opt_len));
+    ASSERT_EQ(0x6558U, DEVX_GET(fte_match_set_misc, misc, geneve_protocol_type));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_misc, misc, vxlan_vni));
+    ASSERT_EQ(0xDEADBEEFU, DEVX_GET(fte_match_set_misc3, misc3, geneve_tlv_option_0_data));
+
+    // Inner headers are not set without inner header criteria.
+    matcher_attr.match_criteria_enabled = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    flow_matcher outer_matcher(matcher_attr);
+    memset(prm, 0, sizeof(prm));
+    ASSERT_EQ(DPCP_OK, outer_matcher.apply(prm, value));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_lyr_2_4, inner, ethertype));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_misc, misc, geneve_vni));
+
+    // VXLAN and GENEVE VNI can not be matched together.
+    matcher_attr.match_criteria_enabled = flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS;
+    matcher_attr.match_criteria.match_tunnel.vxlan_vni = 0xFFFFFF;
+    flow_matcher bad_matcher(matcher_attr);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, bad_matcher.apply(prm, value));
+}
+
+/**
+ * @test dpcp_flow_group.ti_10_create_flow_group_vxlan
+ * @brief
+ *    Check flow group and rule with VXLAN VNI and inner 5-tuple
+ * @details
+ */
+TEST_F(dpcp_flow_group, ti_10_create_flow_group_vxlan)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    flow_table_attr ft_attr;
+    ft_attr.level = 1;
+    ft_attr.log_size = 4;
+    ft_attr.type = flow_table_type::FT_RX;
+    std::shared_ptr<flow_table> ft_obj;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(ft_attr, ft_obj));
+    ASSERT_EQ(DPCP_OK, ft_obj->create());
+    ft_attr.level = 2;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(ft_attr, ft_fwd_obj));
+    ASSERT_EQ(DPCP_OK, ft_fwd_obj->create());
+
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = 15;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR |
+        flow_group_match_criteria_enable::FG_MATCH_INNER_HDR |
+        flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS;
+    match_params_ex& mask = fg_attr.match_criteria;
+    mask.match_lyr3.ip_protocol = 0xFF;
+    mask.match_lyr4.type = match_params_lyr_4_type::UDP;
+    mask.match_lyr4.dst_port = 0xFFFF;
+    mask.match_tunnel.vxlan_vni = 0xFFFFFF;
+    mask.match_inner_lyr3.src_ip = 0xFFFFFFFF;
+    mask.match_inner_lyr3.dst_ip = 0xFFFFFFFF;
+    mask.match_inner_lyr3.ip_protocol = 0xFF;
+    mask.match_inner_lyr4.type = match_params_lyr_4_type::UDP;
+    mask.match_inner_lyr4.dst_port = 0xFFFF;
+    mask.match_inner_lyr4.src_port = 0xFFFF;
+    std::weak_ptr<flow_group> fg_obj;
+    ASSERT_EQ(DPCP_OK, ft_obj->add_flow_group(fg_attr, fg_obj));
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->create());
+
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd_obj.get());
+    flow_rule_attr_ex fr_attr;
+    fr_attr.actions.push_back(adapter_obj->get_flow_action_generator().create_fwd(dests));
+    match_params_ex& value = fr_attr.match_value;
+    value.match_lyr3.ip_protocol = 0x11;
+    value.match_lyr4.type = match_params_lyr_4_type::UDP;
+    value.match_lyr4.dst_port = 4789;
+    value.match_tunnel.vxlan_vni = 0x123456;
+    value.match_inner_lyr3.src_ip = 0x0a000001;
+    value.match_inner_lyr3.dst_ip = 0x0a000002;
+    value.match_inner_lyr3.ip_protocol = 0x11;
+    value.match_inner_lyr4.type = match_params_lyr_4_type::UDP;
+    value.match_inner_lyr4.dst_port = 0xc350;
+    value.match_inner_lyr4.src_port = 0x1234;
+    std::weak_ptr<flow_rule_ex> fr_obj;
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->add_flow_rule(fr_attr, fr_obj));
+    ASSERT_EQ(DPCP_OK, fr_obj.lock()->create());
+
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_group.ti_11_match_extended_fields
+ * @brief
+ *    Check TCP flags, TTL, fragment, second VLAN and ICMP fields of flow matcher
+ * @details
+ *    Fields are checked against PRM layout and against supported fields
+ *    reported by the device.
+ */
+TEST_F(dpcp_flow_group, ti_11_match_extended_fields)
+{
+    flow_matcher_attr matcher_attr;
+    matcher_attr.match_criteria_enabled = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR |
+        flow_group_match_criteria_enable::FG_MATCH_INNER_HDR |
+        flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS |
+        flow_group_match_criteria_enable::FG_MATCH_MISC_PARAMS_3;
+    match_params_ex& mask = matcher_attr.match_criteria;
+    mask.match_lyr2.second_vlan_id = 0xFFF;
+    mask.match_lyr3.ttl = 0xFF;
+    mask.match_lyr3.frag = 0x1;
+    mask.match_lyr4.type = match_params_lyr_4_type::ICMP;
+    mask.match_lyr4.icmp_type = 0xFF;
+    mask.match_lyr4.icmp_code = 0xFF;
+    mask.match_inner_lyr3.ttl = 0xFF;
+    mask.match_inner_lyr4.type = match_params_lyr_4_type::TCP;
+    mask.match_inner_lyr4.tcp_flags = 0x1FF;
+    flow_matcher matcher(matcher_attr);
+
+    match_params_ex value;
+    value.match_lyr2.second_vlan_id = 0x123;
+    value.match_lyr3.ttl = 0x40;
+    value.match_lyr3.frag = 0x1;
+    value.match_lyr4.type = match_params_lyr_4_type::ICMP;
+    value.match_lyr4.icmp_type = 8;
+    value.match_lyr4.icmp_code = 0;
+    value.match_inner_lyr3.ttl = 0x20;
+    value.match_inner_lyr4.type = match_params_lyr_4_type::TCP;
+    value.match_inner_lyr4.tcp_flags = 0x2; // SYN
+
+    uint32_t prm[DEVX_ST_SZ_DW(fte_match_param)] = {0};
+    ASSERT_EQ(DPCP_OK, matcher.apply(prm, value));
+    void* outer = DEVX_ADDR_OF(fte_match_param, prm, outer_headers);
+    void* inner = DEVX_ADDR_OF(fte_match_param, prm, inner_headers);
+    void* misc = DEVX_ADDR_OF(fte_match_param, prm, misc_parameters);
+    void* misc3 = DEVX_ADDR_OF(fte_match_param, prm, misc_parameters_3);
+    ASSERT_EQ(0x40U, DEVX_GET(fte_match_set_lyr_2_4, outer, ttl_hoplimit));
+    ASSERT_EQ(1U, DEVX_GET(fte_match_set_lyr_2_4, outer, frag));
+    ASSERT_EQ(0x20U, DEVX_GET(fte_match_set_lyr_2_4, inner, ttl_hoplimit));
+    ASSERT_EQ(0x2U, DEVX_GET(fte_match_set_lyr_2_4, inner, tcp_flags));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_lyr_2_4, outer, tcp_flags));
+    ASSERT_EQ(0x123U, DEVX_GET(fte_match_set_misc, misc, outer_second_vid));
+    ASSERT_EQ(1U, DEVX_GET(fte_match_set_misc, misc, outer_second_cvlan_tag));
+    ASSERT_EQ(8U, DEVX_GET(fte_match_set_misc3, misc3, icmp_type));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_misc3, misc3, icmpv6_type));
+
+    flow_table_fields_capabilities caps;
+    memset(&caps, 0, sizeof(caps));
+    ASSERT_EQ(DPCP_ERR_NO_SUPPORT, matcher.verify_caps(caps));
+    caps.outer_ipv4_ttl = true;
+    caps.outer_frag = true;
+    caps.outer_second_vid = true;
+    ASSERT_EQ(DPCP_ERR_NO_SUPPORT, matcher.verify_caps(caps));
+    caps.inner_tcp_flags = true;
+    ASSERT_EQ(DPCP_ERR_NO_SUPPORT, matcher.verify_caps(caps));
+    caps.inner_ipv4_ttl = true;
+    ASSERT_EQ(DPCP_OK, matcher.verify_caps(caps));
+
+    // ICMP is matched only on outer header.
+    matcher_attr.match_criteria.match_inner_lyr4.type = match_params_lyr_4_type::ICMP;
+    flow_matcher bad_matcher(matcher_attr);
+    ASSERT_EQ(DPCP_ERR_NO_SUPPORT, bad_matcher.apply(prm, value));
+}
+
+/**
+ * @test dpcp_flow_group.ti_12_match_metadata_registers
+ * @brief
+ *    Check metadata registers fields of flow matcher against PRM layout
+ * @details
+ */
+TEST_F(dpcp_flow_group, ti_12_match_metadata_registers)
+{
+    flow_matcher_attr matcher_attr;
+    matcher_attr.match_criteria_enabled =
+        flow_group_match_criteria_enable::FG_MATCH_METADATA_REGS;
+    match_params_ex& mask = matcher_attr.match_criteria;
+    mask.match_metadata_reg_c_1 = 0xFFFFFFFF;
+    mask.match_metadata_reg_c_5 = 0x0000FFFF;
+    mask.match_metadata_reg_c_7 = 0xFFFFFFFF;
+    mask.match_metadata_reg_a = 0xFFFFFFFF;
+    flow_matcher matcher(matcher_attr);
+
+    match_params_ex value;
+    value.match_metadata_reg_c_0 = 0x10;
+    value.match_metadata_reg_c_1 = 0x11;
+    value.match_metadata_reg_c_5 = 0x15;
+    value.match_metadata_reg_c_7 = 0x17;
+    value.match_metadata_reg_a = 0xA;
+
+    uint32_t prm[DEVX_ST_SZ_DW(fte_match_param)] = {0};
+    ASSERT_EQ(DPCP_OK, matcher.apply(prm, value));
+    void* regs = DEVX_ADDR_OF(fte_match_param, prm, misc_parameters_2);
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_misc2, regs, metadata_reg_c_0));
+    ASSERT_EQ(0x11U, DEVX_GET(fte_match_set_misc2, regs, metadata_reg_c_1));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_misc2, regs, metadata_reg_c_2));
+    ASSERT_EQ(0x15U, DEVX_GET(fte_match_set_misc2, regs, metadata_reg_c_5));
+    ASSERT_EQ(0x17U, DEVX_GET(fte_match_set_misc2, regs, metadata_reg_c_7));
+    ASSERT_EQ(0xAU, DEVX_GET(fte_match_set_misc2, regs, metadata_reg_a));
+    ASSERT_EQ(flow_group_match_criteria_enable::FG_MATCH_METADATA_REG_C_0,
+              matcher.get_prm_match_criteria_enable());
+
+    flow_table_fields_capabilities caps;
+    memset(&caps, 0, sizeof(caps));
+    caps.metadata_reg_c_1 = true;
+    caps.metadata_reg_c_5 = true;
+    ASSERT_EQ(DPCP_ERR_NO_SUPPORT, matcher.verify_caps(caps));
+    caps.metadata_reg_c_7 = true;
+    ASSERT_EQ(DPCP_ERR_NO_SUPPORT, matcher.verify_caps(caps));
+    caps.metadata_reg_a = true;
+    ASSERT_EQ(DPCP_OK, matcher.verify_caps(caps));
+
+    // reg_c_0 only flag must not enable the other registers.
+    matcher_attr.match_criteria_enabled =
+        flow_group_match_criteria_enable::FG_MATCH_METADATA_REG_C_0;
+    flow_matcher reg_c_0_matcher(matcher_attr);
+    memset(prm, 0, sizeof(prm));
+    ASSERT_EQ(DPCP_OK, reg_c_0_matcher.apply(prm, value));
+    ASSERT_EQ(0U, DEVX_GET(fte_match_set_misc2, regs, metadata_reg_c_1));
+}
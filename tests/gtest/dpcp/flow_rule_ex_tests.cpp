@@ -29,7 +29,9 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <chrono>
 #include <memory>
+#include <thread>
 
 #include "common/def.h"
 #include "common/log.h"
@@ -973,3 +975,672 @@ TEST_F(dpcp_flow_rule_ex, ti_06_add_flow_rule_modify_set_modify_copy_fwd_table_r
 
     delete adapter_obj;
 }
+
+/*
+ * Create flow table with 5-tuple flow group on all its entries and forward
+ * action to another flow table.
+ */
+static void create_5tuple_group(adapter* adapter_obj, uint8_t log_size,
+                                std::shared_ptr<flow_table>& ft_obj,
+                                std::shared_ptr<flow_table>& ft_fwd_obj,
+                                std::weak_ptr<flow_group>& fg_obj,
+                                std::shared_ptr<flow_action>& fa_fwd)
+{
+    flow_table_attr ft_attr;
+    ft_attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr.flags = 0;
+    ft_attr.level = 1;
+    ft_attr.log_size = log_size;
+    ft_attr.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr.type = flow_table_type::FT_RX;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(ft_attr, ft_obj));
+    ASSERT_EQ(DPCP_OK, ft_obj->create());
+
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = (1U << log_size) - 1;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+    fg_attr.match_criteria.match_lyr3.dst_ip = 0xFFFFFFFF;
+    fg_attr.match_criteria.match_lyr3.src_ip = 0xFFFFFFFF;
+    fg_attr.match_criteria.match_lyr3.ip_protocol = 0xFF;
+    fg_attr.match_criteria.match_lyr4.type = match_params_lyr_4_type::UDP;
+    fg_attr.match_criteria.match_lyr4.dst_port = 0xFFFF;
+    fg_attr.match_criteria.match_lyr4.src_port = 0xFFFF;
+    ASSERT_EQ(DPCP_OK, ft_obj->add_flow_group(fg_attr, fg_obj));
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->create());
+
+    ft_attr.level = 2;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(ft_attr, ft_fwd_obj));
+    ASSERT_EQ(DPCP_OK, ft_fwd_obj->create());
+
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd_obj.get());
+    fa_fwd = adapter_obj->get_flow_action_generator().create_fwd(dests);
+    ASSERT_NE(nullptr, fa_fwd.get());
+}
+
+/*
+ * Fill 5-tuple flow rule attributes, every index gets unique source port and address.
+ */
+static void set_5tuple_rules(std::vector<flow_rule_attr_ex>& fr_attrs,
+                             std::shared_ptr<flow_action>& fa_fwd)
+{
+    for (size_t i = 0; i < fr_attrs.size(); i++) {
+        flow_rule_attr_ex& fr_attr = fr_attrs[i];
+        fr_attr.flow_index = (uint32_t)i;
+        fr_attr.match_value.match_lyr2.ethertype = 0x800;
+        fr_attr.match_value.match_lyr3.dst_ip = 0x0ad1ff8a;
+        fr_attr.match_value.match_lyr3.src_ip = 0x0a000000 | (uint32_t)(i >> 16);
+        fr_attr.match_value.match_lyr3.ip_protocol = 0x11;
+        fr_attr.match_value.match_lyr4.type = match_params_lyr_4_type::UDP;
+        fr_attr.match_value.match_lyr4.dst_port = 0xc350;
+        fr_attr.match_value.match_lyr4.src_port = (uint16_t)i;
+        fr_attr.actions.push_back(fa_fwd);
+    }
+}
+
+/**
+ * @test dpcp_flow_rule_ex.ti_07_add_flow_rules
+ * @brief
+ *    Check add_flow_rules
+ * @details
+ *    Batch with duplicated flow index is rejected before HW is touched,
+ *    valid batch creates all rules.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_07_add_flow_rules)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    std::shared_ptr<flow_table> ft_obj;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    std::weak_ptr<flow_group> fg_obj;
+    std::shared_ptr<flow_action> fa_fwd;
+    ASSERT_NO_FATAL_FAILURE(
+        create_5tuple_group(adapter_obj, 10, ft_obj, ft_fwd_obj, fg_obj, fa_fwd));
+
+    std::vector<flow_rule_attr_ex> fr_attrs(1024);
+    set_5tuple_rules(fr_attrs, fa_fwd);
+    std::vector<std::weak_ptr<flow_rule_ex>> fr_objs;
+    std::vector<status> results;
+    cmd_batch* batch = nullptr;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_cmd_batch(8, batch));
+
+    // Duplicated and out of range flow index.
+    fr_attrs[7].flow_index = 3;
+    fr_attrs[9].flow_index = 1024;
+    status ret = fg_obj.lock()->add_flow_rules(*batch, fr_attrs.data(), fr_attrs.size(), fr_objs,
+                                               results);
+    ASSERT_NE(DPCP_OK, ret);
+    ASSERT_EQ(fr_attrs.size(), results.size());
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, results[7]);
+    ASSERT_EQ(DPCP_ERR_OUT_OF_RANGE, results[9]);
+    for (auto& fr_obj : fr_objs) {
+        ASSERT_EQ(nullptr, fr_obj.lock().get());
+    }
+
+    fr_attrs[7].flow_index = 7;
+    fr_attrs[9].flow_index = 9;
+    ret = fg_obj.lock()->add_flow_rules(*batch, fr_attrs.data(), fr_attrs.size(), fr_objs,
+                                               results);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(fr_attrs.size(), fr_objs.size());
+    for (size_t i = 0; i < fr_objs.size(); i++) {
+        ASSERT_EQ(DPCP_OK, results[i]);
+        ASSERT_NE(nullptr, fr_objs[i].lock().get());
+    }
+
+    delete batch;
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_rule_ex.DISABLED_perf_add_flow_rules
+ * @brief
+ *    Rules per second of add_flow_rule vs add_flow_rules
+ * @details
+ */
+TEST_F(dpcp_flow_rule_ex, DISABLED_perf_add_flow_rules)
+{
+    const uint8_t log_size = 16;
+
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    cmd_batch* cmds = nullptr;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_cmd_batch(8, cmds));
+
+    std::vector<flow_rule_attr_ex> fr_attrs(1U << log_size);
+    for (int batch = 0; batch < 2; batch++) {
+        std::shared_ptr<flow_table> ft_obj;
+        std::shared_ptr<flow_table> ft_fwd_obj;
+        std::weak_ptr<flow_group> fg_obj;
+        std::shared_ptr<flow_action> fa_fwd;
+        ASSERT_NO_FATAL_FAILURE(
+            create_5tuple_group(adapter_obj, log_size, ft_obj, ft_fwd_obj, fg_obj, fa_fwd));
+        for (auto& fr_attr : fr_attrs) {
+            fr_attr.actions.clear();
+        }
+        set_5tuple_rules(fr_attrs, fa_fwd);
+
+        std::vector<std::weak_ptr<flow_rule_ex>> fr_objs(fr_attrs.size());
+        auto start = std::chrono::steady_clock::now();
+        if (batch) {
+            ASSERT_EQ(DPCP_OK, fg_obj.lock()->add_flow_rules(*cmds, fr_attrs, fr_objs));
+        } else {
+            for (size_t i = 0; i < fr_attrs.size(); i++) {
+                ASSERT_EQ(DPCP_OK, fg_obj.lock()->add_flow_rule(fr_attrs[i], fr_objs[i]));
+                ASSERT_EQ(DPCP_OK, fr_objs[i].lock()->create());
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double sec = std::chrono::duration<double>(end - start).count();
+        log_trace("%s: %zd rules %.3f sec %.0f rules/sec\n",
+                  batch ? "add_flow_rules" : "add_flow_rule", fr_attrs.size(), sec,
+                  fr_attrs.size() / sec);
+    }
+
+    delete cmds;
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_rule_ex.ti_08_add_flow_rule_templates
+ * @brief
+ *    Check flow rules with different sets of actions in one group
+ * @details
+ *    Rules sharing set of actions are built from the same precompiled
+ *    command, which must be equal to the command built field by field.
+ *    Templates are evicted with their last rule and release the actions.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_08_add_flow_rule_templates)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    std::shared_ptr<flow_table> ft_obj;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    std::weak_ptr<flow_group> fg_obj;
+    std::shared_ptr<flow_action> fa_fwd;
+    ASSERT_NO_FATAL_FAILURE(
+        create_5tuple_group(adapter_obj, 6, ft_obj, ft_fwd_obj, fg_obj, fa_fwd));
+
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+    std::shared_ptr<flow_action> fa_tag1(action_gen.create_tag(1));
+    std::shared_ptr<flow_action> fa_tag2(action_gen.create_tag(2));
+
+    std::vector<flow_rule_attr_ex> fr_attrs(64);
+    set_5tuple_rules(fr_attrs, fa_fwd);
+    for (size_t i = 0; i < fr_attrs.size(); i++) {
+        if (i % 3) {
+            fr_attrs[i].actions.push_back(i % 3 == 1 ? fa_tag1 : fa_tag2);
+        }
+    }
+
+    std::vector<std::weak_ptr<flow_rule_ex>> fr_objs(fr_attrs.size());
+    for (size_t i = 0; i < fr_attrs.size(); i++) {
+        ASSERT_EQ(DPCP_OK, fg_obj.lock()->add_flow_rule(fr_attrs[i], fr_objs[i]));
+        ASSERT_EQ(DPCP_OK, fr_objs[i].lock()->create());
+
+        std::shared_ptr<flow_rule_ex_prm> prm_rule =
+            std::dynamic_pointer_cast<flow_rule_ex_prm>(fr_objs[i].lock());
+        ASSERT_NE(nullptr, prm_rule);
+        std::vector<uint8_t> in_tmpl;
+        std::vector<uint8_t> in_fields;
+        ASSERT_EQ(DPCP_OK, prm_rule->build_in_buff(in_tmpl, true));
+        ASSERT_EQ(DPCP_OK, prm_rule->build_in_buff(in_fields, false));
+        ASSERT_EQ(in_fields, in_tmpl);
+    }
+
+    for (auto& fr_attr : fr_attrs) {
+        fr_attr.actions.clear();
+    }
+    for (auto& fr_obj : fr_objs) {
+        ASSERT_EQ(DPCP_OK, fg_obj.lock()->remove_flow_rule(fr_obj));
+    }
+    ASSERT_EQ(1, fa_tag1.use_count());
+    ASSERT_EQ(1, fa_tag2.use_count());
+
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_rule_ex.ti_09_add_flow_rules_kernel_shared_matcher
+ * @brief
+ *    Check kernel flow rules sharing matcher of the group
+ * @details
+ *    Rules of two priorities are added, removed and added again, so
+ *    shared matchers are released and created once more.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_09_add_flow_rules_kernel_shared_matcher)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    std::shared_ptr<flow_table> root_table(adapter_obj->get_root_table(flow_table_type::FT_RX));
+    ASSERT_NE(root_table.get(), nullptr);
+
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = 1000;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+    fg_attr.match_criteria.match_lyr3.dst_ip = 0xFFFFFFFF;
+    fg_attr.match_criteria.match_lyr3.ip_protocol = 0xFF;
+    fg_attr.match_criteria.match_lyr4.type = match_params_lyr_4_type::UDP;
+    fg_attr.match_criteria.match_lyr4.dst_port = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_obj;
+    ASSERT_EQ(DPCP_OK, root_table->add_flow_group(fg_attr, fg_obj));
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->create());
+
+    flow_table_attr ft_attr_fwd;
+    ft_attr_fwd.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr_fwd.flags = 0;
+    ft_attr_fwd.level = 100;
+    ft_attr_fwd.log_size = 10;
+    ft_attr_fwd.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr_fwd.type = flow_table_type::FT_RX;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(ft_attr_fwd, ft_fwd_obj));
+    ASSERT_EQ(DPCP_OK, ft_fwd_obj->create());
+
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd_obj.get());
+    std::shared_ptr<flow_action> fa_fwd(adapter_obj->get_flow_action_generator().create_fwd(dests));
+
+    std::vector<flow_rule_attr_ex> fr_attrs(32);
+    for (size_t i = 0; i < fr_attrs.size(); i++) {
+        fr_attrs[i].priority = (uint16_t)(i % 2);
+        fr_attrs[i].match_value.match_lyr2.ethertype = 0x800;
+        fr_attrs[i].match_value.match_lyr3.dst_ip = 0x0ad1ff00 | (uint32_t)i;
+        fr_attrs[i].match_value.match_lyr3.ip_protocol = 0x11;
+        fr_attrs[i].match_value.match_lyr4.type = match_params_lyr_4_type::UDP;
+        fr_attrs[i].match_value.match_lyr4.dst_port = 0xc350;
+        fr_attrs[i].actions.push_back(fa_fwd);
+    }
+
+    cmd_batch* batch = nullptr;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_cmd_batch(4, batch));
+    for (int round = 0; round < 2; round++) {
+        std::vector<std::weak_ptr<flow_rule_ex>> fr_objs;
+        ASSERT_EQ(DPCP_OK, fg_obj.lock()->add_flow_rules(*batch, fr_attrs, fr_objs));
+        for (auto& fr_obj : fr_objs) {
+            ASSERT_EQ(DPCP_OK, fg_obj.lock()->remove_flow_rule(fr_obj));
+        }
+    }
+
+    delete batch;
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_rule_ex.ti_10_modify_flow_rule
+ * @brief
+ *    Check flow_rule_ex::modify
+ * @details
+ *    Forward destination and tag of created rule are replaced in place,
+ *    actions without forward are rejected.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_10_modify_flow_rule)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    std::shared_ptr<flow_table> ft_obj;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    std::weak_ptr<flow_group> fg_obj;
+    std::shared_ptr<flow_action> fa_fwd;
+    ASSERT_NO_FATAL_FAILURE(
+        create_5tuple_group(adapter_obj, 4, ft_obj, ft_fwd_obj, fg_obj, fa_fwd));
+
+    flow_table_attr ft_attr;
+    ft_attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr.flags = 0;
+    ft_attr.level = 3;
+    ft_attr.log_size = 4;
+    ft_attr.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr.type = flow_table_type::FT_RX;
+    std::shared_ptr<flow_table> ft_fwd2_obj;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(ft_attr, ft_fwd2_obj));
+    ASSERT_EQ(DPCP_OK, ft_fwd2_obj->create());
+
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd2_obj.get());
+    std::shared_ptr<flow_action> fa_fwd2(action_gen.create_fwd(dests));
+    std::shared_ptr<flow_action> fa_tag(action_gen.create_tag(7));
+
+    std::vector<flow_rule_attr_ex> fr_attrs(1);
+    set_5tuple_rules(fr_attrs, fa_fwd);
+    std::weak_ptr<flow_rule_ex> fr_obj;
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->add_flow_rule(fr_attrs[0], fr_obj));
+
+    std::vector<std::shared_ptr<flow_action>> actions;
+    actions.push_back(fa_fwd2);
+    ASSERT_EQ(DPCP_ERR_NOT_APPLIED, fr_obj.lock()->modify(actions));
+    ASSERT_EQ(DPCP_OK, fr_obj.lock()->create());
+
+    actions.push_back(fa_tag);
+    ASSERT_EQ(DPCP_OK, fr_obj.lock()->modify(actions));
+
+    actions.clear();
+    actions.push_back(fa_tag);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, fr_obj.lock()->modify(actions));
+
+    actions.clear();
+    actions.push_back(fa_fwd);
+    ASSERT_EQ(DPCP_OK, fr_obj.lock()->modify(actions));
+
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_rule_ex.ti_11_auto_flow_index
+ * @brief
+ *    Check flow index allocation by flow group
+ * @details
+ *    Group hands out every index of its range once, indexes of removed
+ *    rules are reused and occupancy is reported.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_11_auto_flow_index)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    std::shared_ptr<flow_table> ft_obj;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    std::weak_ptr<flow_group> fg_obj;
+    std::shared_ptr<flow_action> fa_fwd;
+    ASSERT_NO_FATAL_FAILURE(
+        create_5tuple_group(adapter_obj, 4, ft_obj, ft_fwd_obj, fg_obj, fa_fwd));
+    std::shared_ptr<flow_group> fg = fg_obj.lock();
+
+    std::vector<flow_rule_attr_ex> fr_attrs(16);
+    set_5tuple_rules(fr_attrs, fa_fwd);
+    std::vector<std::weak_ptr<flow_rule_ex>> fr_objs(fr_attrs.size());
+    std::vector<bool> seen(fr_attrs.size());
+    for (size_t i = 0; i < fr_attrs.size(); i++) {
+        fr_attrs[i].flow_index = flow_rule_attr_ex::FLOW_INDEX_AUTO;
+        ASSERT_EQ(DPCP_OK, fg->add_flow_rule(fr_attrs[i], fr_objs[i]));
+        uint32_t index = 0;
+        ASSERT_EQ(DPCP_OK, fr_objs[i].lock()->get_flow_index(index));
+        ASSERT_LT(index, seen.size());
+        ASSERT_FALSE(seen[index]);
+        seen[index] = true;
+    }
+    ASSERT_EQ(DPCP_OK, fr_objs[5].lock()->create());
+
+    flow_index_stats stats;
+    ASSERT_EQ(DPCP_OK, fg->get_flow_index_stats(stats));
+    ASSERT_EQ(16U, stats.capacity);
+    ASSERT_EQ(16U, stats.used);
+    ASSERT_EQ(16U, stats.auto_allocated);
+
+    std::weak_ptr<flow_rule_ex> fr_obj;
+    ASSERT_EQ(DPCP_ERR_OUT_OF_RANGE, fg->add_flow_rule(fr_attrs[0], fr_obj));
+
+    uint32_t index5 = 0;
+    ASSERT_EQ(DPCP_OK, fr_objs[5].lock()->get_flow_index(index5));
+    ASSERT_EQ(DPCP_OK, fg->remove_flow_rule(fr_objs[5]));
+    ASSERT_EQ(DPCP_OK, fg->get_flow_index_stats(stats));
+    ASSERT_EQ(15U, stats.used);
+
+    // Index of removed rule is taken by the next rule.
+    flow_rule_attr_ex fr_attr = fr_attrs[5];
+    fr_attr.flow_index = index5;
+    ASSERT_EQ(DPCP_OK, fg->add_flow_rule(fr_attr, fr_obj));
+    ASSERT_EQ(DPCP_OK, fr_obj.lock()->create());
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, fg->add_flow_rule(fr_attr, fr_obj));
+    ASSERT_EQ(DPCP_OK, fg->get_flow_index_stats(stats));
+    ASSERT_EQ(16U, stats.used);
+    ASSERT_EQ(15U, stats.auto_allocated);
+
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_rule_ex.ti_12_shared_flow_actions
+ * @brief
+ *    Check get_shared_modify and get_shared_reformat
+ * @details
+ *    Identical modify and reformat attributes share one flow action,
+ *    different ones do not, released actions leave the cache. Concurrent
+ *    requests of a new action get the same instance.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_12_shared_flow_actions)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+    flow_action_cache_stats stats0;
+    ASSERT_EQ(DPCP_OK, action_gen.get_cache_stats(stats0));
+
+    flow_action_modify_attr modify_attr;
+    modify_attr.table_type = flow_table_type::FT_RX;
+    flow_action_modify_type_attr set_attr {};
+    set_attr.set.type = flow_action_modify_type::SET;
+    set_attr.set.field = flow_action_modify_field::OUT_UDP_DPORT;
+    set_attr.set.length = 16;
+    set_attr.set.data = 9;
+    modify_attr.actions.push_back(set_attr);
+
+    std::shared_ptr<flow_action> fa_modify1(action_gen.get_shared_modify(modify_attr));
+    std::shared_ptr<flow_action> fa_modify2(action_gen.get_shared_modify(modify_attr));
+    ASSERT_NE(nullptr, fa_modify1.get());
+    ASSERT_EQ(fa_modify1.get(), fa_modify2.get());
+    modify_attr.actions[0].set.data = 10;
+    std::shared_ptr<flow_action> fa_modify3(action_gen.get_shared_modify(modify_attr));
+    ASSERT_NE(fa_modify1.get(), fa_modify3.get());
+
+    uint8_t hdr[28] = {0};
+    flow_action_reformat_attr insert_hdr_attr {};
+    insert_hdr_attr.insert.type = flow_action_reformat_type::INSERT_HDR;
+    insert_hdr_attr.insert.start_hdr = dpcp::flow_action_reformat_anchor::MAC_START;
+    insert_hdr_attr.insert.offset = 22;
+    insert_hdr_attr.insert.data_len = sizeof(hdr);
+    insert_hdr_attr.insert.data = hdr;
+    std::shared_ptr<flow_action> fa_insert1(action_gen.get_shared_reformat(insert_hdr_attr));
+    std::shared_ptr<flow_action> fa_insert2(action_gen.get_shared_reformat(insert_hdr_attr));
+    ASSERT_NE(nullptr, fa_insert1.get());
+    ASSERT_EQ(fa_insert1.get(), fa_insert2.get());
+
+    flow_action_cache_stats stats;
+    ASSERT_EQ(DPCP_OK, action_gen.get_cache_stats(stats));
+    ASSERT_EQ(stats0.hits + 2, stats.hits);
+    ASSERT_EQ(stats0.misses + 3, stats.misses);
+    ASSERT_EQ(2U, stats.modify_entries[FT_RX]);
+    ASSERT_EQ(0U, stats.modify_entries[FT_TX]);
+    ASSERT_EQ(1U, stats.reformat_entries);
+    ASSERT_LT(0U, stats.modify_capacity[FT_RX]);
+
+    fa_modify1.reset();
+    fa_modify2.reset();
+    ASSERT_EQ(DPCP_OK, action_gen.get_cache_stats(stats));
+    ASSERT_EQ(1U, stats.modify_entries[FT_RX]);
+
+    // Threads asking for the same new action get one instance
+    modify_attr.table_type = flow_table_type::FT_TX;
+    std::vector<std::shared_ptr<flow_action>> fa_shared(4);
+    std::vector<std::thread> threads;
+    for (auto& fa : fa_shared) {
+        threads.emplace_back([&action_gen, &modify_attr, &fa]() {
+            fa = action_gen.get_shared_modify(modify_attr);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (auto& fa : fa_shared) {
+        ASSERT_NE(nullptr, fa.get());
+        ASSERT_EQ(fa_shared[0].get(), fa.get());
+    }
+    ASSERT_EQ(DPCP_OK, action_gen.get_cache_stats(stats));
+    ASSERT_EQ(1U, stats.modify_entries[FT_TX]);
+    fa_shared.clear();
+
+    fa_modify3.reset();
+    fa_insert1.reset();
+    fa_insert2.reset();
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_rule_ex.ti_13_compact_flow_rules
+ * @brief
+ *    Check add_flow_rule_compact and remove_flow_rule_compact
+ * @details
+ *    Compact rules get packed match value and flow index back by handle,
+ *    handles of removed rules are rejected when their slot is reused.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_13_compact_flow_rules)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    std::shared_ptr<flow_table> ft_obj;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    std::weak_ptr<flow_group> fg_obj;
+    std::shared_ptr<flow_action> fa_fwd;
+    ASSERT_NO_FATAL_FAILURE(
+        create_5tuple_group(adapter_obj, 4, ft_obj, ft_fwd_obj, fg_obj, fa_fwd));
+    std::shared_ptr<flow_group> fg = fg_obj.lock();
+
+    std::vector<flow_rule_attr_ex> fr_attrs(16);
+    set_5tuple_rules(fr_attrs, fa_fwd);
+    std::vector<flow_rule_handle> handles(fr_attrs.size());
+    for (size_t i = 0; i < fr_attrs.size(); i++) {
+        fr_attrs[i].flow_index = flow_rule_attr_ex::FLOW_INDEX_AUTO;
+        ASSERT_EQ(DPCP_OK, fg->add_flow_rule_compact(fr_attrs[i], handles[i]));
+    }
+
+    flow_index_stats stats;
+    ASSERT_EQ(DPCP_OK, fg->get_flow_index_stats(stats));
+    ASSERT_EQ(16U, stats.used);
+
+    // Different rules keep different packed match values.
+    uint32_t index0 = 0;
+    uint32_t index1 = 0;
+    std::vector<uint8_t> match0;
+    std::vector<uint8_t> match1;
+    ASSERT_EQ(DPCP_OK, fg->get_flow_rule_compact(handles[0], index0, match0));
+    ASSERT_EQ(DPCP_OK, fg->get_flow_rule_compact(handles[1], index1, match1));
+    ASSERT_NE(index0, index1);
+    ASSERT_FALSE(match0.empty());
+    ASSERT_NE(match0, match1);
+
+    ASSERT_EQ(DPCP_OK, fg->remove_flow_rule_compact(handles[0]));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, fg->remove_flow_rule_compact(handles[0]));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, fg->get_flow_rule_compact(handles[0], index0, match0));
+
+    // Slot and index are reused, the stale handle stays invalid.
+    flow_rule_handle handle = 0;
+    ASSERT_EQ(DPCP_OK, fg->add_flow_rule_compact(fr_attrs[0], handle));
+    ASSERT_NE(handles[0], handle);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, fg->remove_flow_rule_compact(handles[0]));
+    ASSERT_EQ(DPCP_OK, fg->get_flow_rule_compact(handle, index1, match1));
+    ASSERT_EQ(index0, index1);
+    ASSERT_EQ(DPCP_OK, fg->get_flow_index_stats(stats));
+    ASSERT_EQ(16U, stats.used);
+
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_rule_ex.ti_14_add_flow_rules_threads
+ * @brief
+ *    Check flow rules insertion and removal from several threads
+ * @details
+ *    Threads add flow_rule_ex and compact rules with automatic flow index
+ *    to the same group and then remove them, every index is given once.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_14_add_flow_rules_threads)
+{
+    const size_t num_threads = 4;
+    const size_t num_rules = 64;
+
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    std::shared_ptr<flow_table> ft_obj;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    std::weak_ptr<flow_group> fg_obj;
+    std::shared_ptr<flow_action> fa_fwd;
+    ASSERT_NO_FATAL_FAILURE(
+        create_5tuple_group(adapter_obj, 10, ft_obj, ft_fwd_obj, fg_obj, fa_fwd));
+    std::shared_ptr<flow_group> fg = fg_obj.lock();
+
+    std::vector<flow_rule_attr_ex> fr_attrs(num_threads * num_rules);
+    set_5tuple_rules(fr_attrs, fa_fwd);
+    for (auto& fr_attr : fr_attrs) {
+        fr_attr.flow_index = flow_rule_attr_ex::FLOW_INDEX_AUTO;
+    }
+    std::vector<std::weak_ptr<flow_rule_ex>> fr_objs(fr_attrs.size());
+    std::vector<flow_rule_handle> handles(fr_attrs.size());
+    std::vector<uint32_t> indexes(fr_attrs.size());
+    std::vector<status> results(fr_attrs.size(), DPCP_ERR_NOT_APPLIED);
+
+    // Even rules are flow_rule_ex objects, odd rules are compact.
+    auto add = [&](size_t t) {
+        for (size_t i = t * num_rules; i < (t + 1) * num_rules; i++) {
+            std::vector<uint8_t> match;
+            if (i % 2) {
+                results[i] = fg->add_flow_rule_compact(fr_attrs[i], handles[i]);
+                if (results[i] == DPCP_OK) {
+                    results[i] = fg->get_flow_rule_compact(handles[i], indexes[i], match);
+                }
+            } else {
+                results[i] = fg->add_flow_rule(fr_attrs[i], fr_objs[i]);
+                if (results[i] == DPCP_OK) {
+                    results[i] = fr_objs[i].lock()->create();
+                }
+                if (results[i] == DPCP_OK) {
+                    results[i] = fr_objs[i].lock()->get_flow_index(indexes[i]);
+                }
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back(add, t);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<bool> seen(1U << 10);
+    for (size_t i = 0; i < fr_attrs.size(); i++) {
+        ASSERT_EQ(DPCP_OK, results[i]);
+        ASSERT_LT(indexes[i], seen.size());
+        ASSERT_FALSE(seen[indexes[i]]);
+        seen[indexes[i]] = true;
+    }
+    flow_index_stats stats;
+    ASSERT_EQ(DPCP_OK, fg->get_flow_index_stats(stats));
+    ASSERT_EQ(fr_attrs.size(), stats.used);
+
+    auto remove = [&](size_t t) {
+        for (size_t i = t * num_rules; i < (t + 1) * num_rules; i++) {
+            results[i] = (i % 2) ? fg->remove_flow_rule_compact(handles[i])
+                                 : fg->remove_flow_rule(fr_objs[i]);
+        }
+    };
+    threads.clear();
+    for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back(remove, t);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < fr_attrs.size(); i++) {
+        ASSERT_EQ(DPCP_OK, results[i]);
+    }
+    ASSERT_EQ(DPCP_OK, fg->get_flow_index_stats(stats));
+    ASSERT_EQ(0U, stats.used);
+    ASSERT_EQ(0U, stats.auto_allocated);
+
+    delete adapter_obj;
+}
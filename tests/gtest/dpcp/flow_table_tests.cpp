@@ -360,3 +360,285 @@ TEST_F(dpcp_flow_table, ti_08_miss_action_fwd02)
     delete adapter_obj;
 }
 
+
+/*
+ * Rules on 3 masks and 2 priorities: 4 UDP 5-tuple rules, 2 destination ip rules
+ * and 1 destination ip rule of lower priority.
+ */
+static void set_compiler_rules(std::vector<flow_rule_spec>& rules,
+                               std::shared_ptr<flow_action>& fa_fwd)
+{
+    rules.resize(7);
+    for (size_t i = 0; i < rules.size(); i++) {
+        flow_rule_spec& rule = rules[i];
+        rule.match_criteria.match_lyr2.ethertype = 0xFFFF;
+        rule.match_criteria.match_lyr3.dst_ip = 0xFFFFFFFF;
+        rule.match_value.match_lyr2.ethertype = 0x800;
+        rule.match_value.match_lyr3.dst_ip = 0x0ad1ff00 | (uint32_t)i;
+        if (i < 4) {
+            rule.match_criteria.match_lyr3.src_ip = 0xFFFFFFFF;
+            rule.match_criteria.match_lyr3.ip_protocol = 0xFF;
+            rule.match_criteria.match_lyr4.type = match_params_lyr_4_type::UDP;
+            rule.match_criteria.match_lyr4.dst_port = 0xFFFF;
+            rule.match_criteria.match_lyr4.src_port = 0xFFFF;
+            rule.match_value.match_lyr3.src_ip = 0x0a000001;
+            rule.match_value.match_lyr3.ip_protocol = 0x11;
+            rule.match_value.match_lyr4.type = match_params_lyr_4_type::UDP;
+            rule.match_value.match_lyr4.dst_port = 0xc350;
+            rule.match_value.match_lyr4.src_port = (uint16_t)i;
+        }
+        rule.priority = (i == 6) ? 1 : 0;
+        rule.actions.push_back(fa_fwd);
+    }
+    // Same fields as the 5-tuple rules, different mask.
+    rules[2].match_criteria.match_lyr3.src_ip = 0xFFFFFF00;
+}
+
+/**
+ * @test dpcp_flow_table.ti_09_compile_flow_rules
+ * @brief
+ *    Check flow_rule_compiler::compile
+ * @details
+ *    Rules are placed to one group per mask and one chained table per priority.
+ */
+TEST_F(dpcp_flow_table, ti_09_compile_flow_rules)
+{
+    std::shared_ptr<flow_action> fa_fwd;
+    std::vector<flow_rule_spec> rules;
+    set_compiler_rules(rules, fa_fwd);
+
+    flow_table_attr attr;
+    attr.level = 1;
+    attr.type = flow_table_type::FT_RX;
+    flow_plan plan;
+    ASSERT_EQ(DPCP_OK, flow_rule_compiler::compile(rules, attr, plan));
+
+    ASSERT_EQ(2U, plan.tables.size());
+    ASSERT_EQ(1, plan.tables[0].attr.level);
+    ASSERT_EQ(3, plan.tables[0].attr.log_size);
+    ASSERT_EQ(flow_table_miss_action::FT_MISS_ACTION_FWD, plan.tables[0].attr.def_miss_action);
+    ASSERT_EQ(2, plan.tables[1].attr.level);
+    ASSERT_EQ(0, plan.tables[1].attr.log_size);
+    ASSERT_EQ(flow_table_miss_action::FT_MISS_ACTION_DEF, plan.tables[1].attr.def_miss_action);
+
+    ASSERT_EQ(4U, plan.groups.size());
+    std::vector<size_t> expected[] = {{0, 1, 3}, {2}, {4, 5}, {6}};
+    uint32_t start = 0;
+    for (size_t g = 0; g < plan.groups.size(); g++) {
+        ASSERT_EQ(expected[g], plan.groups[g].rules);
+        ASSERT_EQ(g < 3 ? 0U : 1U, plan.groups[g].table);
+        start = (g == 3) ? 0 : start;
+        ASSERT_EQ(start, plan.groups[g].attr.start_flow_index);
+        start += (uint32_t)expected[g].size();
+        ASSERT_EQ(start - 1, plan.groups[g].attr.end_flow_index);
+    }
+
+    attr.level = 0;
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, flow_rule_compiler::compile(rules, attr, plan));
+    rules.clear();
+    attr.level = 1;
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, flow_rule_compiler::compile(rules, attr, plan));
+}
+
+/**
+ * @test dpcp_flow_table.ti_10_apply_flow_plan
+ * @brief
+ *    Check flow_rule_compiler::apply
+ * @details
+ *    Compiled plan is created in HW, every rule gets its planned flow index.
+ */
+TEST_F(dpcp_flow_table, ti_10_apply_flow_plan)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    // Destination table is below the planned levels.
+    flow_table_attr attr;
+    attr.level = 3;
+    attr.type = flow_table_type::FT_RX;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(attr, ft_fwd_obj));
+    ASSERT_EQ(DPCP_OK, ft_fwd_obj->create());
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd_obj.get());
+    std::shared_ptr<flow_action> fa_fwd =
+        adapter_obj->get_flow_action_generator().create_fwd(dests);
+    ASSERT_NE(nullptr, fa_fwd.get());
+
+    std::vector<flow_rule_spec> rules;
+    set_compiler_rules(rules, fa_fwd);
+    attr.level = 1;
+    flow_plan plan;
+    ASSERT_EQ(DPCP_OK, flow_rule_compiler::compile(rules, attr, plan));
+
+    flow_plan_objs objs;
+    ASSERT_EQ(DPCP_OK, flow_rule_compiler::apply(adapter_obj, plan, rules, objs));
+    ASSERT_EQ(plan.tables.size(), objs.tables.size());
+    ASSERT_EQ(plan.groups.size(), objs.groups.size());
+    ASSERT_EQ(rules.size(), objs.rules.size());
+    for (const auto& group : plan.groups) {
+        for (size_t k = 0; k < group.rules.size(); k++) {
+            uint32_t index = 0;
+            ASSERT_EQ(DPCP_OK, objs.rules[group.rules[k]].lock()->get_flow_index(index));
+            ASSERT_EQ(group.attr.start_flow_index + k, index);
+        }
+    }
+
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_table.ti_11_allow_apply
+ * @brief
+ *    Check flow_action_allow::apply method
+ * @details
+ *    Allow action is set in the FTE without destinations.
+ */
+TEST_F(dpcp_flow_table, ti_11_allow_apply)
+{
+    std::vector<uint8_t> in(DEVX_ST_SZ_BYTES(set_fte_in), 0);
+    void* flow_context = DEVX_ADDR_OF(set_fte_in, in.data(), flow_context);
+
+    flow_action_allow action(nullptr);
+    ASSERT_EQ(DPCP_OK, action.apply(in.data()));
+    ASSERT_TRUE(DEVX_GET(flow_context, flow_context, action) & MLX5_FLOW_CONTEXT_ACTION_ALLOW);
+    ASSERT_EQ(0U, DEVX_GET(flow_context, flow_context, destination_list_size));
+}
+
+/**
+ * @test dpcp_flow_table.ti_12_tx_flow_rule
+ * @brief
+ *    Check flow rule on NIC transmit flow table
+ * @details
+ *    Transmit rule rewrites the ethertype and allows the packet to the vport.
+ */
+TEST_F(dpcp_flow_table, ti_12_tx_flow_rule)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    adapter_hca_capabilities caps;
+    ASSERT_EQ(DPCP_OK, adapter_obj->get_hca_capabilities(caps));
+    if (!caps.flow_table_caps.transmit.is_flow_table_supported) {
+        log_trace("Transmit flow tables are not supported\n");
+        delete adapter_obj;
+        return;
+    }
+
+    flow_table_attr ft_attr;
+    ft_attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr.flags = 0;
+    ft_attr.level = 1;
+    ft_attr.log_size = 2;
+    ft_attr.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr.type = flow_table_type::FT_TX;
+
+    std::shared_ptr<flow_table> ft_obj;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(ft_attr, ft_obj));
+    ASSERT_EQ(DPCP_OK, ft_obj->create());
+    flow_table_type ft_type = flow_table_type::FT_END;
+    ASSERT_EQ(DPCP_OK, ft_obj->get_table_type(ft_type));
+    ASSERT_EQ(flow_table_type::FT_TX, ft_type);
+
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = 1;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_obj;
+    ASSERT_EQ(DPCP_OK, ft_obj->add_flow_group(fg_attr, fg_obj));
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->create());
+
+    flow_action_modify_type_attr set_attr;
+    set_attr.set.type = flow_action_modify_type::SET;
+    set_attr.set.data = 0x800;
+    set_attr.set.field = flow_action_modify_field::OUT_ETHERTYPE;
+    set_attr.set.length = 0x10;
+    set_attr.set.offset = 0;
+    flow_action_modify_attr modify_attr;
+    modify_attr.table_type = flow_table_type::FT_TX;
+    modify_attr.actions.push_back(set_attr);
+
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+    flow_rule_attr_ex fr_attr;
+    fr_attr.priority = 0;
+    fr_attr.flow_index = 0;
+    fr_attr.match_value.match_lyr2.ethertype = 0x86DD;
+    fr_attr.actions.push_back(action_gen.create_modify(modify_attr));
+    fr_attr.actions.push_back(action_gen.create_allow());
+
+    std::weak_ptr<flow_rule_ex> fr_obj;
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->add_flow_rule(fr_attr, fr_obj));
+    ASSERT_EQ(DPCP_OK, fr_obj.lock()->create());
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->remove_flow_rule(fr_obj));
+
+    delete adapter_obj;
+}
+
+#if defined(__linux__)
+/**
+ * @test dpcp_flow_table.ti_13_tx_root_flow_rule
+ * @brief
+ *    Check flow rule on the transmit root table
+ * @details
+ *    Root table rule forwards to a transmit flow table, the driver matcher
+ *    is created with the transmit table type.
+ */
+TEST_F(dpcp_flow_table, ti_13_tx_root_flow_rule)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    adapter_hca_capabilities caps;
+    ASSERT_EQ(DPCP_OK, adapter_obj->get_hca_capabilities(caps));
+    if (!caps.flow_table_caps.transmit.is_flow_table_supported) {
+        log_trace("Transmit flow tables are not supported\n");
+        delete adapter_obj;
+        return;
+    }
+
+    flow_table_attr ft_attr;
+    ft_attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr.flags = 0;
+    ft_attr.level = 1;
+    ft_attr.log_size = 2;
+    ft_attr.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr.type = flow_table_type::FT_TX;
+
+    std::shared_ptr<flow_table> ft_obj;
+    ASSERT_EQ(DPCP_OK, adapter_obj->create_flow_table(ft_attr, ft_obj));
+    ASSERT_EQ(DPCP_OK, ft_obj->create());
+
+    std::shared_ptr<flow_table> root_table =
+        adapter_obj->get_root_table(flow_table_type::FT_TX);
+    ASSERT_NE(nullptr, root_table);
+
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = 1;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_obj;
+    ASSERT_EQ(DPCP_OK, root_table->add_flow_group(fg_attr, fg_obj));
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->create());
+
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_obj.get());
+    flow_rule_attr_ex fr_attr;
+    fr_attr.priority = 0;
+    fr_attr.flow_index = 0;
+    fr_attr.match_value.match_lyr2.ethertype = 0x800;
+    fr_attr.actions.push_back(action_gen.create_fwd(dests));
+
+    std::weak_ptr<flow_rule_ex> fr_obj;
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->add_flow_rule(fr_attr, fr_obj));
+    ASSERT_EQ(DPCP_OK, fr_obj.lock()->create());
+    ASSERT_EQ(DPCP_OK, fg_obj.lock()->remove_flow_rule(fr_obj));
+    ASSERT_EQ(DPCP_OK, root_table->remove_flow_group(fg_obj));
+
+    delete adapter_obj;
+}
+#endif
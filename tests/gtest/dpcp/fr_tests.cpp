@@ -422,6 +422,42 @@ TEST_F(dpcp_fr, ti_10_5_tuple)
     ASSERT_EQ(DPCP_OK, ret);
 }
 
+/**
+* @test dpcp_fr.ti_10_5_tuple_ipv6_flow_label
+* @brief
+*    Check flow_rule::apply_settings for ipv6 rule with traffic class and flow label
+* @details
+*/
+TEST_F(dpcp_fr, ti_10_5_tuple_ipv6_flow_label)
+{
+#ifdef __linux__
+    SKIP_TRUE(sys_rootuser(), "This test requires root permissions (RAW_NET)\n");
+
+    match_params mask = m_mask5;
+    mask.flow_label = 0xFFFFF;
+    mask.traffic_class = 0xFC;
+    flow_rule fr(s_ad->get_ctx(), 10, mask);
+
+    match_params mv1;
+    memset(&mv1, 0, sizeof(mv1));
+    mv1.ethertype = 0x86DD;
+    mv1.vlan_id = 0x0004;
+    mv1.dst_port = 0x4321;
+    mv1.src_port = 0x4322;
+    mv1.protocol = 0x11;
+    mv1.ip_version = 6;
+    memset(&mv1.dst.ipv6, 0x22, sizeof(mv1.dst.ipv6));
+    memset(&mv1.src.ipv6, 0x11, sizeof(mv1.src.ipv6));
+    mv1.flow_label = 0x12345;
+    mv1.traffic_class = 0xB8;
+    ASSERT_EQ(DPCP_OK, fr.set_match_value(mv1));
+    ASSERT_EQ(DPCP_OK, fr.add_dest_tir(s_tir2));
+
+    ASSERT_EQ(DPCP_OK, fr.apply_settings());
+    ASSERT_EQ(DPCP_OK, fr.revoke_settings());
+#endif
+}
+
 /**
 * @test dpcp_fr.ti_11_5t_ipv6
 * @brief
@@ -33,6 +33,7 @@
 #include "common/log.h"
 #include "common/sys.h"
 #include "common/base.h"
+#include <chrono>
 
 #include "dpcp_base.h"
 
@@ -293,6 +294,238 @@ TEST_F(dpcp_mkey, ti_dm06_reg_GPU_mem)
 }
 #endif // GPU_DIRECT
 
+/**
+ * @test dpcp_mkey.ti_dm07_relaxed_ordering
+ * @brief
+ *    Check direct_mkey creation with relaxed ordering flags
+ * @details
+ *    Relaxed ordering flags are kept only when HCA supports them.
+ */
+TEST_F(dpcp_mkey, ti_dm07_relaxed_ordering)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    adapter_hca_capabilities caps;
+    ret = ad->get_hca_capabilities(caps);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    uint32_t expected = MKEY_NONE;
+    if (caps.relaxed_ordering_write) {
+        expected |= MKEY_RELAXED_ORDERING_WRITE;
+    }
+    if (caps.relaxed_ordering_read) {
+        expected |= MKEY_RELAXED_ORDERING_READ;
+    }
+    ASSERT_EQ(expected, (uint32_t)ad->get_supported_mkey_flags(MKEY_RELAXED_ORDERING));
+    ASSERT_EQ(MKEY_ZERO_BASED, ad->get_supported_mkey_flags(MKEY_ZERO_BASED));
+
+    size_t length = 4096;
+    uint8_t* buf = new (std::nothrow) uint8_t[length];
+    ASSERT_NE(nullptr, buf);
+
+    direct_mkey* mk = nullptr;
+    ret = ad->create_direct_mkey(buf, length, MKEY_RELAXED_ORDERING, mk);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    mkey_flags flags = MKEY_NONE;
+    ret = mk->get_flags(flags);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(expected, (uint32_t)flags);
+
+    uint32_t id = 0;
+    ret = mk->get_id(id);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE((uint32_t)0, id);
+
+    ret = ad->set_queue_relaxed_ordering(true);
+    ASSERT_EQ((expected ? DPCP_OK : DPCP_ERR_NO_SUPPORT), ret);
+    ret = ad->set_queue_relaxed_ordering(false);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    delete mk;
+    delete[] buf;
+    delete ad;
+}
+
+#if defined(__linux__)
+static int connect_loopback_qp(ibv_qp* qp)
+{
+    ibv_port_attr port_attr = {};
+    if (ibv_query_port(qp->context, 1, &port_attr)) {
+        return -1;
+    }
+
+    ibv_qp_attr attr = {};
+    attr.qp_state = IBV_QPS_INIT;
+    attr.port_num = 1;
+    attr.qp_access_flags = IBV_ACCESS_LOCAL_WRITE;
+    if (ibv_modify_qp(qp, &attr,
+                      IBV_QP_STATE | IBV_QP_PKEY_INDEX | IBV_QP_PORT | IBV_QP_ACCESS_FLAGS)) {
+        return -1;
+    }
+
+    // Connect QP to itself
+    memset(&attr, 0, sizeof(attr));
+    attr.qp_state = IBV_QPS_RTR;
+    attr.path_mtu = port_attr.active_mtu;
+    attr.dest_qp_num = qp->qp_num;
+    attr.max_dest_rd_atomic = 1;
+    attr.min_rnr_timer = 12;
+    attr.ah_attr.port_num = 1;
+    attr.ah_attr.dlid = port_attr.lid;
+    if (IBV_LINK_LAYER_ETHERNET == port_attr.link_layer) {
+        attr.ah_attr.is_global = 1;
+        attr.ah_attr.grh.hop_limit = 1;
+        if (ibv_query_gid(qp->context, 1, 0, &attr.ah_attr.grh.dgid)) {
+            return -1;
+        }
+    }
+    if (ibv_modify_qp(qp, &attr,
+                      IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU | IBV_QP_DEST_QPN |
+                          IBV_QP_RQ_PSN | IBV_QP_MAX_DEST_RD_ATOMIC | IBV_QP_MIN_RNR_TIMER)) {
+        return -1;
+    }
+
+    memset(&attr, 0, sizeof(attr));
+    attr.qp_state = IBV_QPS_RTS;
+    attr.timeout = 14;
+    attr.retry_cnt = 7;
+    attr.rnr_retry = 7;
+    attr.max_rd_atomic = 1;
+    return ibv_modify_qp(qp, &attr,
+                         IBV_QP_STATE | IBV_QP_TIMEOUT | IBV_QP_RETRY_CNT | IBV_QP_RNR_RETRY |
+                             IBV_QP_SQ_PSN | IBV_QP_MAX_QP_RD_ATOMIC);
+}
+
+/**
+ * @test dpcp_mkey.DISABLED_perf_relaxed_ordering
+ * @brief
+ *    Compare registration time and loopback DMA throughput with and without
+ *    relaxed ordering
+ * @details
+ *    Buffers registered by create_direct_mkey() are copied by SEND/RECV on
+ *    a RC QP connected to itself, so the HCA reads the source buffer and
+ *    writes the destination buffer over PCIe.
+ */
+TEST_F(dpcp_mkey, DISABLED_perf_relaxed_ordering)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    if (MKEY_NONE == ad->get_supported_mkey_flags(MKEY_RELAXED_ORDERING)) {
+        log_trace("Relaxed ordering is not supported\n");
+        delete ad;
+        return;
+    }
+
+    void* p_ibv_pd = nullptr;
+    ASSERT_EQ(DPCP_OK, ad->get_ibv_pd(p_ibv_pd));
+    ibv_context* ctx = (ibv_context*)ad->get_ibv_context();
+    ibv_cq* cq = ibv_create_cq(ctx, 256, nullptr, nullptr, 0);
+    ASSERT_NE(nullptr, cq);
+    ibv_qp_init_attr qp_init_attr = {};
+    qp_init_attr.send_cq = cq;
+    qp_init_attr.recv_cq = cq;
+    qp_init_attr.qp_type = IBV_QPT_RC;
+    qp_init_attr.cap.max_send_wr = 64;
+    qp_init_attr.cap.max_recv_wr = 64;
+    qp_init_attr.cap.max_send_sge = 1;
+    qp_init_attr.cap.max_recv_sge = 1;
+    ibv_qp* qp = ibv_create_qp((ibv_pd*)p_ibv_pd, &qp_init_attr);
+    ASSERT_NE(nullptr, qp);
+    ASSERT_EQ(0, connect_loopback_qp(qp));
+
+    const size_t LOOP_COUNT = 100U;
+    const size_t DMA_WINDOW = 32U;
+    const size_t length = 64 * 1024 * 1024;
+    const size_t msg_sz = 1024 * 1024;
+    uint8_t* src = new (std::nothrow) uint8_t[length];
+    ASSERT_NE(nullptr, src);
+    uint8_t* dst = new (std::nothrow) uint8_t[length];
+    ASSERT_NE(nullptr, dst);
+    memset(src, 0xA5, length);
+    memset(dst, 0, length);
+
+    const mkey_flags variants[] = {MKEY_NONE, MKEY_RELAXED_ORDERING};
+    for (mkey_flags flags : variants) {
+        auto start_ts = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < LOOP_COUNT; i++) {
+            direct_mkey* mk = nullptr;
+            ret = ad->create_direct_mkey(src, length, flags, mk);
+            ASSERT_EQ(DPCP_OK, ret);
+            delete mk;
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_ts)
+                         .count();
+        log_trace("flags 0x%x: %zu registrations of %zu bytes, Latency(usec): %.1f\n", flags,
+                  LOOP_COUNT, length, sec * 1e6 / LOOP_COUNT);
+
+        direct_mkey* src_mk = nullptr;
+        direct_mkey* dst_mk = nullptr;
+        ASSERT_EQ(DPCP_OK, ad->create_direct_mkey(src, length, flags, src_mk));
+        ASSERT_EQ(DPCP_OK, ad->create_direct_mkey(dst, length, flags, dst_mk));
+        uint32_t src_key = 0;
+        uint32_t dst_key = 0;
+        ASSERT_EQ(DPCP_OK, src_mk->get_id(src_key));
+        ASSERT_EQ(DPCP_OK, dst_mk->get_id(dst_key));
+
+        // Keep up to DMA_WINDOW messages in flight, each message is one SEND and one RECV
+        const size_t msg_num = LOOP_COUNT * (length / msg_sz);
+        size_t posted = 0;
+        size_t completed = 0;
+        start_ts = std::chrono::steady_clock::now();
+        while (completed < 2 * msg_num) {
+            while (posted < msg_num && posted - completed / 2 < DMA_WINDOW) {
+                size_t offset = (posted * msg_sz) % length;
+                ibv_sge rsge = {(uint64_t)(dst + offset), (uint32_t)msg_sz, dst_key};
+                ibv_recv_wr rwr = {};
+                ibv_recv_wr* bad_rwr = nullptr;
+                rwr.sg_list = &rsge;
+                rwr.num_sge = 1;
+                ASSERT_EQ(0, ibv_post_recv(qp, &rwr, &bad_rwr));
+                ibv_sge ssge = {(uint64_t)(src + offset), (uint32_t)msg_sz, src_key};
+                ibv_send_wr swr = {};
+                ibv_send_wr* bad_swr = nullptr;
+                swr.sg_list = &ssge;
+                swr.num_sge = 1;
+                swr.opcode = IBV_WR_SEND;
+                swr.send_flags = IBV_SEND_SIGNALED;
+                ASSERT_EQ(0, ibv_post_send(qp, &swr, &bad_swr));
+                posted++;
+            }
+            ibv_wc wc[16];
+            int n = ibv_poll_cq(cq, 16, wc);
+            ASSERT_LE(0, n);
+            for (int i = 0; i < n; i++) {
+                ASSERT_EQ(IBV_WC_SUCCESS, wc[i].status);
+            }
+            completed += n;
+        }
+        sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_ts).count();
+        log_trace("flags 0x%x: %zu loopback messages of %zu bytes, Throughput(MB/s): %.0f\n",
+                  flags, msg_num, msg_sz, msg_num * msg_sz / sec / (1024 * 1024));
+        ASSERT_EQ(0, memcmp(src, dst, length));
+        memset(dst, 0, length);
+
+        delete src_mk;
+        delete dst_mk;
+    }
+
+    ASSERT_EQ(0, ibv_destroy_qp(qp));
+    ASSERT_EQ(0, ibv_destroy_cq(cq));
+    delete[] dst;
+    delete[] src;
+    delete ad;
+}
+#endif
+
 void prepare_bbs1(adapter* ad, pattern_mkey_bb mem_bb[1], uint8_t*& dat_buf,
                   const int32_t strides_num)
 {
@@ -577,6 +810,133 @@ TEST_F(dpcp_mkey, ti_pm04_create_pad)
     release_bbs3(mem_bb, dat_buf, hdr_buf, pad_buf);
     delete ad;
 }
+
+/**
+ * @test dpcp_mkey.ti_pm05_variant_reuse
+ * @brief
+ *    Check mkey variant allocation on create/destroy cycles
+ * @details
+ *    Recreated mkey never repeats the key just deregistered and
+ *    the whole 8 bit variant space is used.
+ */
+TEST_F(dpcp_mkey, ti_pm05_variant_reuse)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    const int32_t strides_num = 16;
+    pattern_mkey_bb mem_bb[1];
+    uint8_t* dat_buf = nullptr;
+    prepare_bbs1(ad, mem_bb, dat_buf, strides_num);
+
+    bool variants[256] = {};
+    uint32_t prev_id = 0;
+    for (int i = 0; i < 300; i++) {
+        pattern_mkey* mk = nullptr;
+        ret = ad->create_pattern_mkey(dat_buf, MKEY_NONE, strides_num, 1, mem_bb, mk);
+        ASSERT_EQ(DPCP_OK, ret);
+
+        uint32_t id = 0;
+        ret = mk->get_id(id);
+        ASSERT_EQ(DPCP_OK, ret);
+        ASSERT_NE(prev_id, id);
+        variants[id & 0xFF] = true;
+        prev_id = id;
+
+        delete mk;
+    }
+    ASSERT_TRUE(variants[0xFF]);
+
+    release_bbs1(mem_bb, dat_buf);
+    delete ad;
+}
+
+/**
+ * @test dpcp_mkey.ti_pm06_release_tracker
+ * @brief
+ *    Check tracking of deregistered keys
+ * @details
+ *    Keys are tracked per mkey index, so indexes that differ only in high
+ *    bits do not overwrite each other.
+ */
+TEST_F(dpcp_mkey, ti_pm06_release_tracker)
+{
+    mkey_release_tracker tracker;
+    const uint32_t key1 = (0x1 << 8) | 0x10;
+    const uint32_t key2 = ((0x1 + 4096) << 8) | 0x20;
+
+    ASSERT_TRUE(tracker.acquire(key1));
+    ASSERT_TRUE(tracker.acquire(key2));
+    tracker.release(key1);
+    tracker.release(key2);
+    ASSERT_EQ(2U, tracker.size());
+
+    // The same key of either index is refused, another variant is accepted
+    ASSERT_FALSE(tracker.acquire(key1));
+    ASSERT_FALSE(tracker.acquire(key2));
+    ASSERT_TRUE(tracker.acquire(key1 + 1));
+    ASSERT_EQ(1U, tracker.size());
+    ASSERT_FALSE(tracker.acquire(key2));
+
+    // Live index accepts any variant until it is deregistered again
+    ASSERT_TRUE(tracker.acquire(key1));
+    ASSERT_TRUE(tracker.acquire(key2 + 1));
+    ASSERT_EQ(0U, tracker.size());
+}
+
+/**
+ * @test dpcp_mkey.ti_km01_create_chunked
+ * @brief
+ *    Check chunked_mkey registration by several workers
+ * @details
+ *
+ */
+TEST_F(dpcp_mkey, ti_km01_create_chunked)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    const size_t page_sz = 4096;
+    const size_t chunk_sz = 16 * page_sz;
+    // Unaligned start and 5 full chunks give 6 chunks.
+    size_t length = 5 * chunk_sz;
+    uint8_t* buf = new (std::nothrow) uint8_t[length + 2 * chunk_sz];
+    ASSERT_NE(nullptr, buf);
+    uint8_t* addr = (uint8_t*)(((uintptr_t)buf + chunk_sz - 1) & ~(chunk_sz - 1)) + 64;
+
+    chunked_mkey_attr attr = {chunk_sz, 4, CHUNKED_MKEY_PREFAULT};
+    chunked_mkey* mk = nullptr;
+    ret = ad->create_chunked_mkey(addr, length, MKEY_NONE, attr, mk);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, mk);
+
+    size_t mkeys_num = 0;
+    ret = mk->get_mkeys_num(mkeys_num);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ((size_t)6, mkeys_num);
+
+    size_t len = 0;
+    ret = mk->get_length(len);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(length, len);
+
+    uint32_t new_id = 0;
+    ret = mk->get_id(new_id);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE((uint32_t)0, new_id);
+
+    log_trace("chunked mkey id: 0x%x\n", new_id);
+
+    delete mk;
+    delete[] buf;
+    delete ad;
+}
 /**
  * @test dpcp_mkey.ti_rm01_create
  * @brief
@@ -1008,3 +1368,48 @@ TEST_F(dpcp_mkey, ti_cm06_max_sge_bad_attr)
 
     delete ad;
 }
+
+/**
+ * @test dpcp_mkey.ti_cm07_relaxed_ordering
+ * @brief
+ *    Check crypto_mkey relaxed ordering flags
+ * @details
+ *    Relaxed ordering is off by default and kept only when HCA supports it.
+ */
+TEST_F(dpcp_mkey, ti_cm07_relaxed_ordering)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+    ad->open();
+
+    adapter_hca_capabilities caps;
+    status ret = ad->get_hca_capabilities(caps);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    bool is_dek_supported = caps.general_object_types_encryption_key && caps.log_max_dek;
+    if (!is_dek_supported) {
+        log_trace("crypto_mkey is not supported \n");
+        delete ad;
+        return;
+    }
+
+    crypto_mkey* cm = nullptr;
+    ret = ad->create_crypto_mkey(cm, 4, MKEY_RELAXED_ORDERING);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    mkey_flags flags = MKEY_NONE;
+    ret = cm->get_flags(flags);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ((uint32_t)(MKEY_ZERO_BASED | ad->get_supported_mkey_flags(MKEY_RELAXED_ORDERING)),
+              (uint32_t)flags);
+    delete cm;
+
+    ret = ad->create_crypto_mkey(cm, 4);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = cm->get_flags(flags);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(MKEY_ZERO_BASED, flags);
+    delete cm;
+
+    delete ad;
+}
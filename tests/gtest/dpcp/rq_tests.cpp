@@ -326,3 +326,72 @@ TEST_F(dpcp_rq, ti_17_create_striding_rq_attr_api)
     delete s_ad;
 }
 
+
+/**
+ * @test dpcp_rq.ti_18_create_hairpin_pair
+ * @brief
+ *    Check adapter::create_hairpin_pair method
+ * @details
+ *    Hairpin SQ requires a TIS, queue size is checked against HW limits.
+ */
+TEST_F(dpcp_rq, ti_18_create_hairpin_pair)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    adapter_hca_capabilities caps;
+    ASSERT_EQ(DPCP_OK, ad->get_hca_capabilities(caps));
+    if (!caps.hairpin) {
+        log_trace("Hairpin is not supported\n");
+        delete ad;
+        return;
+    }
+
+    hairpin_attr attr = {};
+    hairpin_rq* hp_rq = nullptr;
+    hairpin_sq* hp_sq = nullptr;
+    status ret = ad->create_hairpin_pair(attr, hp_rq, hp_sq);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    tis* tis_obj = nullptr;
+    struct tis::attr tis_attr;
+    memset(&tis_attr, 0, sizeof(tis_attr));
+    tis_attr.flags = TIS_ATTR_TRANSPORT_DOMAIN;
+    tis_attr.transport_domain = ad->get_td();
+    ret = ad->create_tis(tis_attr, tis_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(DPCP_OK, tis_obj->get_tisn(attr.tis_num));
+
+    attr.log_data_sz = caps.log_max_hairpin_wq_data_sz + 1;
+    ret = ad->create_hairpin_pair(attr, hp_rq, hp_sq);
+    ASSERT_EQ(DPCP_ERR_OUT_OF_RANGE, ret);
+
+    attr.log_data_sz = 0;
+    ret = ad->create_hairpin_pair(attr, hp_rq, hp_sq);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, hp_rq);
+    ASSERT_NE(nullptr, hp_sq);
+
+    uint32_t rqn = 0;
+    uint32_t sqn = 0;
+    ASSERT_EQ(DPCP_OK, hp_rq->get_id(rqn));
+    ASSERT_EQ(DPCP_OK, hp_sq->get_id(sqn));
+    ASSERT_NE(0U, rqn);
+    ASSERT_NE(0U, sqn);
+
+    // Hairpin RQ is destination of TIR
+    tir::attr tir_attr;
+    memset(&tir_attr, 0, sizeof(tir_attr));
+    tir_attr.flags = TIR_ATTR_INLINE_RQN | TIR_ATTR_TRANSPORT_DOMAIN;
+    tir_attr.inline_rqn = rqn;
+    tir_attr.transport_domain = ad->get_td();
+    tir* tir_obj = nullptr;
+    ret = ad->create_tir(tir_attr, tir_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    delete tir_obj;
+    delete hp_sq;
+    delete hp_rq;
+    delete tis_obj;
+    delete ad;
+}
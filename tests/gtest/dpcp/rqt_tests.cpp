@@ -0,0 +1,280 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+
+#include "dpcp_base.h"
+
+using namespace dpcp;
+
+class dpcp_rqt : public dpcp_base {};
+
+/**
+ * @test dpcp_rqt.ti_01_create
+ * @brief
+ *    Check adapter::create_rqt method
+ * @details
+ *
+ */
+TEST_F(dpcp_rqt, ti_01_create)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    status ret = adapter_obj->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    striding_rq* srq_obj = open_str_rq(adapter_obj, m_rqp);
+    ASSERT_NE(nullptr, srq_obj);
+
+    uint32_t rqn = 0;
+    ret = srq_obj->get_id(rqn);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    rqt* rqt_obj = nullptr;
+    rqt::attr rqt_attr;
+    rqt_attr.max_size = 0;
+    ret = adapter_obj->create_rqt(rqt_attr, rqt_obj);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+    ASSERT_EQ(nullptr, rqt_obj);
+
+    rqt_attr.rqns.assign(3, rqn);
+    ret = adapter_obj->create_rqt(rqt_attr, rqt_obj);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+    ASSERT_EQ(nullptr, rqt_obj);
+
+    adapter_hca_capabilities caps;
+    if (DPCP_OK == adapter_obj->get_hca_capabilities(caps) && caps.log_max_rqt_size < 31) {
+        rqt_attr.max_size = (1U << caps.log_max_rqt_size) + 1;
+        rqt_attr.rqns.assign(4, rqn);
+        ret = adapter_obj->create_rqt(rqt_attr, rqt_obj);
+        ASSERT_EQ(DPCP_ERR_OUT_OF_RANGE, ret);
+        ASSERT_EQ(nullptr, rqt_obj);
+    }
+
+    rqt_attr.max_size = 0;
+    rqt_attr.rqns.assign(4, rqn);
+    ret = adapter_obj->create_rqt(rqt_attr, rqt_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, rqt_obj);
+    ASSERT_NE(0U, rqt_obj->get_rqtn());
+    ASSERT_EQ(4U, rqt_obj->get_max_size());
+
+    ret = rqt_obj->create(rqt_attr);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    delete rqt_obj;
+    delete srq_obj;
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_rqt.ti_02_modify
+ * @brief
+ *    Check rqt::modify and rqt::query methods
+ * @details
+ *    Table entries are replaced, table can not grow above max size and
+ *    its size must be a power of two.
+ */
+TEST_F(dpcp_rqt, ti_02_modify)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    status ret = adapter_obj->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    striding_rq* srq_obj1 = open_str_rq(adapter_obj, m_rqp);
+    ASSERT_NE(nullptr, srq_obj1);
+    striding_rq* srq_obj2 = open_str_rq(adapter_obj, m_rqp);
+    ASSERT_NE(nullptr, srq_obj2);
+
+    uint32_t rqn1 = 0;
+    uint32_t rqn2 = 0;
+    ASSERT_EQ(DPCP_OK, srq_obj1->get_id(rqn1));
+    ASSERT_EQ(DPCP_OK, srq_obj2->get_id(rqn2));
+
+    rqt* rqt_obj = nullptr;
+    rqt::attr rqt_attr;
+    rqt_attr.max_size = 8;
+    rqt_attr.rqns = {rqn1, rqn1, rqn1, rqn1};
+    ret = adapter_obj->create_rqt(rqt_attr, rqt_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    std::vector<uint32_t> rqns;
+    ret = rqt_obj->query(rqns);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(rqt_attr.rqns, rqns);
+
+    rqt_attr.rqns = {rqn1, rqn2, rqn1, rqn2, rqn1, rqn2, rqn1, rqn2};
+    ret = rqt_obj->modify(rqt_attr.rqns);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = rqt_obj->query(rqns);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(rqt_attr.rqns, rqns);
+
+    rqt_attr.rqns.push_back(rqn1);
+    ret = rqt_obj->modify(rqt_attr.rqns);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    rqt_attr.rqns.assign(6, rqn2);
+    ret = rqt_obj->modify(rqt_attr.rqns);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    delete rqt_obj;
+    delete srq_obj2;
+    delete srq_obj1;
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_rqt.ti_03_rebalance_plan
+ * @brief
+ *    Check rqt_rebalancer::plan method
+ * @details
+ *    Hot buckets move to cold RQs, small imbalance and max_moves limit the moves.
+ */
+TEST_F(dpcp_rqt, ti_03_rebalance_plan)
+{
+    rqt_rebalancer_attr attr;
+    attr.imbalance_pct = 25;
+    attr.target_pct = 10;
+    attr.max_moves = 0;
+    attr.min_interval_ms = 0;
+
+    std::vector<uint32_t> rqns = {10, 20};
+    std::vector<uint32_t> entries = {10, 20, 10, 20, 10, 20, 10, 20};
+    std::vector<uint64_t> no_buckets;
+
+    // Within imbalance_pct, nothing is moved
+    std::vector<uint64_t> rq_loads = {110, 90};
+    ASSERT_EQ(0U, rqt_rebalancer::plan(entries, rqns, rq_loads, no_buckets, attr));
+
+    // Load of an RQ is spread over its 4 entries, second move would overshoot
+    rq_loads = {300, 100};
+    ASSERT_EQ(1U, rqt_rebalancer::plan(entries, rqns, rq_loads, no_buckets, attr));
+    ASSERT_EQ(5, std::count(entries.begin(), entries.end(), 20U));
+
+    // Hot bucket goes to an idle RQ, a single bucket can not be split
+    entries = {10, 10, 10, 10};
+    rqns = {10, 20, 30};
+    rq_loads = {1000, 0, 0};
+    std::vector<uint64_t> bucket_loads = {900, 40, 30, 30};
+    ASSERT_EQ(1U, rqt_rebalancer::plan(entries, rqns, rq_loads, bucket_loads, attr));
+    ASSERT_EQ(20U, entries[0]);
+    ASSERT_EQ(3, std::count(entries.begin(), entries.end(), 10U));
+
+    // max_moves limits a single rebalance
+    entries = {10, 10, 10, 10, 10, 10, 10, 10};
+    rqns = {10, 20};
+    rq_loads = {800, 0};
+    attr.max_moves = 1;
+    ASSERT_EQ(1U, rqt_rebalancer::plan(entries, rqns, rq_loads, no_buckets, attr));
+    entries.assign(8, 10);
+    attr.max_moves = 0;
+    ASSERT_EQ(4U, rqt_rebalancer::plan(entries, rqns, rq_loads, no_buckets, attr));
+    ASSERT_EQ(4, std::count(entries.begin(), entries.end(), 10U));
+
+    // Unknown RQ in the table
+    entries = {10, 40};
+    ASSERT_EQ(0U, rqt_rebalancer::plan(entries, rqns, rq_loads, no_buckets, attr));
+}
+
+/**
+ * @test dpcp_rqt.ti_04_rebalance
+ * @brief
+ *    Check rqt_rebalancer::rebalance method
+ * @details
+ *    Moves are written to HW, next rebalance is held off by min_interval_ms.
+ */
+TEST_F(dpcp_rqt, ti_04_rebalance)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    status ret = adapter_obj->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    striding_rq* srq_obj1 = open_str_rq(adapter_obj, m_rqp);
+    ASSERT_NE(nullptr, srq_obj1);
+    striding_rq* srq_obj2 = open_str_rq(adapter_obj, m_rqp);
+    ASSERT_NE(nullptr, srq_obj2);
+
+    uint32_t rqn1 = 0;
+    uint32_t rqn2 = 0;
+    ASSERT_EQ(DPCP_OK, srq_obj1->get_id(rqn1));
+    ASSERT_EQ(DPCP_OK, srq_obj2->get_id(rqn2));
+
+    rqt* rqt_obj = nullptr;
+    rqt::attr rqt_attr;
+    rqt_attr.max_size = 0;
+    rqt_attr.rqns.assign(8, rqn1);
+    ret = adapter_obj->create_rqt(rqt_attr, rqt_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    rqt_rebalancer_attr attr;
+    attr.imbalance_pct = 25;
+    attr.target_pct = 10;
+    attr.max_moves = 0;
+    attr.min_interval_ms = 60000;
+    rqt_rebalancer rebalancer(rqt_obj, {rqn1, rqn2}, attr);
+
+    uint32_t moved = 0;
+    ret = rebalancer.rebalance({800, 0}, {}, moved);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    ret = rebalancer.init();
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(rqt_attr.rqns, rebalancer.get_entries());
+
+    ret = rebalancer.rebalance({800, 0}, {}, moved);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(4U, moved);
+
+    std::vector<uint32_t> rqns;
+    ret = rqt_obj->query(rqns);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(rebalancer.get_entries(), rqns);
+
+    ret = rebalancer.rebalance({0, 800}, {}, moved);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(0U, moved);
+
+    delete rqt_obj;
+    delete srq_obj2;
+    delete srq_obj1;
+    delete adapter_obj;
+}
@@ -0,0 +1,218 @@
+/*
+ * SPDX-FileCopyrightText: NVIDIA CORPORATION & AFFILIATES
+ * Copyright (c) 2025 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+
+#include "dpcp_base.h"
+
+using namespace dpcp;
+
+class dpcp_rx_hash : public dpcp_base {};
+
+/*
+ * Key and vectors of Microsoft RSS verification suite.
+ */
+static const uint8_t s_key[TIR_RX_HASH_TOEPLITZ_KEY_SIZE] = {
+    0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3,
+    0x8f, 0xb0, 0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3,
+    0x80, 0x30, 0xf2, 0x0c, 0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa};
+
+struct rx_hash_vector {
+    uint8_t src_ip[16];
+    uint8_t dst_ip[16];
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint32_t ip_hash;
+    uint32_t ip_l4_hash;
+};
+
+static const rx_hash_vector s_ipv4_vectors[] = {
+    {{66, 9, 149, 187}, {161, 142, 100, 80}, 2794, 1766, 0x323e8fc2, 0x51ccc178},
+    {{199, 92, 111, 2}, {65, 69, 140, 83}, 14230, 4739, 0xd718262a, 0xc626b0ea},
+    {{24, 19, 198, 95}, {12, 22, 207, 184}, 12898, 38024, 0xd2d0a5de, 0x5c2b394a},
+    {{38, 27, 205, 30}, {209, 142, 163, 6}, 48228, 2217, 0x82989176, 0xafc7327f},
+    {{153, 39, 163, 191}, {202, 188, 127, 2}, 44251, 1303, 0x5d1809c5, 0x10e828a2},
+};
+
+static const rx_hash_vector s_ipv6_vectors[] = {
+    {{0x3f, 0xfe, 0x25, 0x01, 0x02, 0x00, 0x1f, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x07},
+     {0x3f, 0xfe, 0x25, 0x01, 0x02, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x01},
+     2794,
+     1766,
+     0x2cc18cd5,
+     0x40207d3d},
+    {{0x3f, 0xfe, 0x05, 0x01, 0x00, 0x08, 0x00, 0x00, 0x02, 0x60, 0x97, 0xff, 0xfe, 0x40, 0xef,
+      0xab},
+     {0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x01},
+     14230,
+     4739,
+     0x0f0c461c,
+     0xdde51bbf},
+    {{0x3f, 0xfe, 0x19, 0x00, 0x45, 0x45, 0x00, 0x03, 0x02, 0x00, 0xf8, 0xff, 0xfe, 0x21, 0x67,
+      0xcf},
+     {0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0xf8, 0xff, 0xfe, 0x21, 0x67,
+      0xcf},
+     44251,
+     38024,
+     0x4b61e985,
+     0x02d1feef},
+};
+
+static uint16_t to_be16(uint16_t val)
+{
+    uint8_t bytes[2] = {(uint8_t)(val >> 8), (uint8_t)val};
+    uint16_t be_val;
+    memcpy(&be_val, bytes, sizeof(be_val));
+    return be_val;
+}
+
+static rx_hash_tuple get_tuple(const rx_hash_vector& vec)
+{
+    rx_hash_tuple tuple;
+    memset(&tuple, 0, sizeof(tuple));
+    memcpy(tuple.src_ip, vec.src_ip, sizeof(tuple.src_ip));
+    memcpy(tuple.dst_ip, vec.dst_ip, sizeof(tuple.dst_ip));
+    tuple.src_port = to_be16(vec.src_port);
+    tuple.dst_port = to_be16(vec.dst_port);
+    return tuple;
+}
+
+static void check_vectors(const rx_hash_vector* vecs, size_t num, uint32_t l3_prot_type)
+{
+    tir_rx_hash_field_select fields;
+    fields.l3_prot_type = l3_prot_type;
+    fields.l4_prot_type = 0;
+    fields.selected_fields = TIR_RX_HASH_SRC_IP | TIR_RX_HASH_DST_IP;
+    rx_hash ip_hash;
+    ASSERT_EQ(DPCP_OK, ip_hash.init(TIR_RX_HASH_FN_TOEPLITZ, s_key, false, fields));
+
+    fields.selected_fields |= TIR_RX_HASH_L4_SPORT | TIR_RX_HASH_L4_DPORT;
+    rx_hash ip_l4_hash;
+    ASSERT_EQ(DPCP_OK, ip_l4_hash.init(TIR_RX_HASH_FN_TOEPLITZ, s_key, false, fields));
+
+    for (size_t i = 0; i < num; i++) {
+        rx_hash_tuple tuple = get_tuple(vecs[i]);
+        ASSERT_EQ(vecs[i].ip_hash, ip_hash.hash(tuple));
+        ASSERT_EQ(vecs[i].ip_l4_hash, ip_l4_hash.hash(tuple));
+    }
+}
+
+/**
+ * @test dpcp_rx_hash.ti_01_toeplitz_ipv4
+ * @brief
+ *    Check rx_hash::hash method with IPv4 tuples
+ * @details
+ *    Results match Microsoft RSS verification suite.
+ */
+TEST_F(dpcp_rx_hash, ti_01_toeplitz_ipv4)
+{
+    check_vectors(s_ipv4_vectors, ARRAY_SIZE(s_ipv4_vectors), 0);
+}
+
+/**
+ * @test dpcp_rx_hash.ti_02_toeplitz_ipv6
+ * @brief
+ *    Check rx_hash::hash method with IPv6 tuples
+ * @details
+ *    Results match Microsoft RSS verification suite.
+ */
+TEST_F(dpcp_rx_hash, ti_02_toeplitz_ipv6)
+{
+    check_vectors(s_ipv6_vectors, ARRAY_SIZE(s_ipv6_vectors), 1);
+}
+
+/**
+ * @test dpcp_rx_hash.ti_03_hash_burst
+ * @brief
+ *    Check rx_hash::hash_burst method
+ * @details
+ *    Batch results are the same as of single tuples, including the burst remainder.
+ */
+TEST_F(dpcp_rx_hash, ti_03_hash_burst)
+{
+    tir::attr tir_attr;
+    memset(&tir_attr, 0, sizeof(tir_attr));
+    tir_attr.flags = TIR_ATTR_INDIRECT;
+    tir_attr.rss.hash_fn = TIR_RX_HASH_FN_TOEPLITZ;
+    memcpy(tir_attr.rss.toeplitz_key, s_key, sizeof(s_key));
+    tir_attr.rss.outer.selected_fields =
+        TIR_RX_HASH_SRC_IP | TIR_RX_HASH_DST_IP | TIR_RX_HASH_L4_SPORT | TIR_RX_HASH_L4_DPORT;
+
+    rx_hash hash;
+    ASSERT_EQ(DPCP_OK, hash.init(tir_attr));
+    ASSERT_EQ(12U, hash.get_input_len());
+
+    const size_t num = ARRAY_SIZE(s_ipv4_vectors);
+    rx_hash_tuple tuples[num];
+    uint32_t hashes[num] = {0};
+    for (size_t i = 0; i < num; i++) {
+        tuples[i] = get_tuple(s_ipv4_vectors[i]);
+    }
+    hash.hash_burst(tuples, hashes, num);
+    for (size_t i = 0; i < num; i++) {
+        ASSERT_EQ(s_ipv4_vectors[i].ip_l4_hash, hashes[i]);
+    }
+}
+
+/**
+ * @test dpcp_rx_hash.ti_04_init_errors
+ * @brief
+ *    Check rx_hash init errors
+ * @details
+ *    XOR8 and symmetric hashing are not supported.
+ */
+TEST_F(dpcp_rx_hash, ti_04_init_errors)
+{
+    tir_rx_hash_field_select fields;
+    fields.l3_prot_type = 1;
+    fields.l4_prot_type = 1;
+    fields.selected_fields =
+        TIR_RX_HASH_SRC_IP | TIR_RX_HASH_DST_IP | TIR_RX_HASH_L4_SPORT | TIR_RX_HASH_L4_DPORT;
+
+    rx_hash hash;
+    ASSERT_EQ(DPCP_ERR_NO_SUPPORT, hash.init(TIR_RX_HASH_FN_TOEPLITZ, s_key, true, fields));
+
+    ASSERT_EQ(DPCP_ERR_NO_SUPPORT,
+              hash.init(TIR_RX_HASH_FN_INVERTED_XOR8, s_key, false, fields));
+
+    fields.selected_fields |= TIR_RX_HASH_IPSEC_SPI;
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, hash.init(TIR_RX_HASH_FN_TOEPLITZ, s_key, false, fields));
+
+    tir::attr tir_attr;
+    memset(&tir_attr, 0, sizeof(tir_attr));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, hash.init(tir_attr));
+}
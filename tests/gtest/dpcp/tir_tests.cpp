@@ -492,3 +492,80 @@ TEST_F(dpcp_tir, ti_09_create_nvmeotcp)
     ASSERT_EQ(tir_attr.nvmeotcp.crc_en, crc_en ? 1U : 0U);
     ASSERT_EQ(tir_attr.nvmeotcp.zerocopy_en, zerocopy_en ? 1U : 0U);
 }
+
+/**
+ * @test dpcp_tir.ti_10_create_rss
+ * @brief
+ *    Check indirect tir creation with Toeplitz hash over RQT
+ * @details
+ *
+ */
+TEST_F(dpcp_tir, ti_10_create_rss)
+{
+    static const uint8_t key[TIR_RX_HASH_TOEPLITZ_KEY_SIZE] = {
+        0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3,
+        0x8f, 0xb0, 0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3,
+        0x80, 0x30, 0xf2, 0x0c, 0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa};
+
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    status ret = adapter_obj->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    uint32_t tdn = adapter_obj->get_td();
+    ASSERT_NE(0U, tdn);
+
+    striding_rq* srq_obj = open_str_rq(adapter_obj, m_rqp);
+    ASSERT_NE(nullptr, srq_obj);
+
+    uint32_t rqn = 0;
+    ret = srq_obj->get_id(rqn);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    rqt* rqt_obj = nullptr;
+    rqt::attr rqt_attr;
+    rqt_attr.max_size = 0;
+    rqt_attr.rqns.assign(4, rqn);
+    ret = adapter_obj->create_rqt(rqt_attr, rqt_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // TIR references the RQT, so it is destroyed first.
+    {
+        tir tir_obj(adapter_obj->get_ctx());
+        struct tir::attr tir_attr;
+        memset(&tir_attr, 0, sizeof(tir_attr));
+        tir_attr.flags = TIR_ATTR_INLINE_RQN | TIR_ATTR_INDIRECT | TIR_ATTR_TRANSPORT_DOMAIN;
+        tir_attr.inline_rqn = rqn;
+        tir_attr.transport_domain = tdn;
+        tir_attr.rss.indirect_table = rqt_obj->get_rqtn();
+        tir_attr.rss.hash_fn = TIR_RX_HASH_FN_TOEPLITZ;
+        tir_attr.rss.symmetric = 1;
+        memcpy(tir_attr.rss.toeplitz_key, key, sizeof(key));
+        tir_attr.rss.outer.l3_prot_type = 0;
+        tir_attr.rss.outer.l4_prot_type = 1;
+        tir_attr.rss.outer.selected_fields =
+            TIR_RX_HASH_SRC_IP | TIR_RX_HASH_DST_IP | TIR_RX_HASH_L4_SPORT | TIR_RX_HASH_L4_DPORT;
+        ret = tir_obj.create(tir_attr);
+        ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+        tir_attr.flags &= ~TIR_ATTR_INLINE_RQN;
+        ret = tir_obj.create(tir_attr);
+        ASSERT_EQ(DPCP_OK, ret);
+
+        struct tir::attr query_attr;
+        memset(&query_attr, 0, sizeof(query_attr));
+        ret = tir_obj.query(query_attr);
+        ASSERT_EQ(DPCP_OK, ret);
+        ASSERT_TRUE(query_attr.flags & TIR_ATTR_INDIRECT);
+        ASSERT_FALSE(query_attr.flags & TIR_ATTR_INLINE_RQN);
+        ASSERT_EQ(rqt_obj->get_rqtn(), query_attr.rss.indirect_table);
+        ASSERT_EQ(TIR_RX_HASH_FN_TOEPLITZ, query_attr.rss.hash_fn);
+        ASSERT_EQ(0, memcmp(key, query_attr.rss.toeplitz_key, sizeof(key)));
+        ASSERT_EQ(tir_attr.rss.outer.selected_fields, query_attr.rss.outer.selected_fields);
+    }
+
+    delete rqt_obj;
+    delete srq_obj;
+    delete adapter_obj;
+}